@@ -25,8 +25,8 @@ info: logo
 	$(info ------------)
 	$(info LIST OF OBJECTS:)
 	$(info - SRC = $(SRC))
-	$(info - OBJ A2A = $(OBJ_A2A))
-	$(info - OBJ NB = $(OBJ_NB))
+	$(info - OBJ = $(OBJ))
+	$(info - OBJ F = $(OBJ_F))
 	$(info - DEP = $(DEP))
 	$(info - LGF_DATA = $(LGF_DATA))
 	$(info ------------)
@@ -0,0 +1,55 @@
+import csv
+
+#read and compare the 'file' located in 'curdir'/data and 'refdir'/data.
+#every column is compared (2 per component), the difference is relative to the ref
+#value, or absolute if the ref value is below 1 (the errors of an exact solve are ~0)
+#return the number of mistakes
+#i is just an index for display
+def check_res_comm(i, file, refdir, curdir, tol):
+
+    #Checking for exactness of results
+    n_mistake = 0
+
+    #creating a dictionnary with reference data
+    try:
+        fref = open(refdir+'/data/'+file,'r')
+
+        dicref = {}
+        for line in csv.reader(fref,delimiter=' '):
+            buff = [v for v in line if v != '']
+            dicref.update({buff[0] : [float(v) for v in buff[1:]] })
+
+        fref.close()
+    except FileNotFoundError:
+        dicref = {}
+
+    try:
+        fcurr = open(curdir+'/data/'+file,'r')
+    except FileNotFoundError:
+        print("test %i: no data in "%i + curdir)
+        return 1
+
+    #comparing current results with reference
+    for line in csv.reader(fcurr,delimiter=' '):
+        buff = [v for v in line if v != '']
+        vals = dicref.get(buff[0])
+        if vals is None:
+            print("test %i: skipped res= "%i +buff[0]+", no ref data in " + refdir)
+            n_mistake +=1
+            continue
+
+        curr = [float(v) for v in buff[1:]]
+        if len(curr) != len(vals):
+            print("test %i: WRONG number of values for res= "%i +buff[0]+": %i instead of %i"%(len(curr),len(vals)))
+            n_mistake +=1
+            continue
+
+        for ic in range(len(vals)):
+            err = abs(vals[ic]-curr[ic])/max(abs(vals[ic]),1.0)
+            if err >= tol:
+                print("test %i: WRONG value %i for res= "%(i,ic) +buff[0]+":\n     curr: %10.12e\n     ref : %10.12e"%(curr[ic],vals[ic]))
+                n_mistake +=1
+
+    fcurr.close()
+
+    return n_mistake
@@ -0,0 +1,152 @@
+import subprocess
+import shutil
+import sys
+import os
+from check_res_comm import check_res_comm
+
+## Check which type of center you try to test
+try:
+    arg = sys.argv[1]
+except IndexError:
+    print("/!\ /!\ /!\ WARNING /!\ /!\ /!\ ")
+    print("You didn't choose any center type. ")
+    print("By default, we will test Cell centered data")
+    arg = 1
+
+
+if(int(arg) == 0):
+    print("We will test Node centered data")
+    centerType = int(arg)
+    centername = 'NodeCenter'
+elif(int(arg) == 1):
+    print("We will test Cell centered data")
+    centerType = int(arg)
+    centername = 'CellCenter'
+else:
+    print("/!\ /!\ /!\ WARNING /!\ /!\ /!\ ")
+    print("You choose a center type which is not supported. ")
+    print("By default, we will test Cell centered data")
+    centerType = 1
+    centername = 'CellCenter'
+
+# The backends and the runtime modes are compared to the default run of ./flups_validation (4 ranks, no FLUPS_* variable).
+# ./flups_validation and ./flups_validation_f are built with `make comm`.
+#
+# Some cases need a library compiled with other flags: ./flups_validation_<variant> is linked with the libflups installed
+# in ../../variant_<variant>/lib, e.g. for the mpi40 variant (from the root of the repo):
+#   make clean && make install_dynamic OPTS="<OPTS of the arch file> -DMPI_40" PREFIX=./variant_mpi40
+#   cd samples/validation && make clean && make flups_validation_mpi40
+# The variants are
+#   - mpi40: -DMPI_40 (partitioned sends)
+#   - mt: -DMPI_MULTITHREAD -DMPI_PROGRESS_THREAD
+#   - small: -DMPI_MAX_COUNT=64 -DMPI_A2A_ROUND_SIZE=1024 (split messages and several rounds of the all to all already at 16^3)
+# The cases of a variant are skipped if its exe does not exist.
+
+#List of combinations of some boundary conditions in 3 direction:
+BCs = [ ["4","4","4","4","4","4"],
+        ["3","3","3","3","3","3"],
+        ["4","0","1","4","4","1"]]
+
+Ldas = ['1','3']
+
+# the thread level of MPI asked by the exe: 0=single, 1=funneled, 2=serialized, 3=multiple
+mt = {"VALIDATION_THREAD_LEVEL" : "3", "OMP_NUM_THREADS" : "2"}
+
+# name, environment variables, number of ranks, proc repartition, exe, tolerance
+Cases = [ ["rma"                  , {"FLUPS_COMM" : "rma"}                 , "4", "1,2,2", "./flups_validation"      , 1e-10],
+          ["partitioned"          , dict(mt, FLUPS_COMM = "nb")            , "4", "1,2,2", "./flups_validation_mpi40", 1e-10],
+          ["multithread_nb"       , dict(mt, FLUPS_COMM = "nb")            , "4", "1,2,2", "./flups_validation_mt"   , 1e-10],
+          ["multithread_isr"      , dict(mt, FLUPS_COMM = "isr")           , "4", "1,2,2", "./flups_validation_mt"   , 1e-10],
+          ["progress_a2a"         , dict(mt, FLUPS_COMM = "a2a")           , "4", "1,2,2", "./flups_validation_mt"   , 1e-10],
+          ["nb"                   , {"FLUPS_COMM" : "nb"}                  , "4", "1,2,2", "./flups_validation"      , 1e-10],
+          ["isr"                  , {"FLUPS_COMM" : "isr"}                 , "4", "1,2,2", "./flups_validation"      , 1e-10],
+          ["auto"                 , {"FLUPS_COMM" : "auto"}                , "4", "1,2,2", "./flups_validation"      , 1e-10],
+          ["single_rank"          , {}                                     , "1", "1,1,1", "./flups_validation"      , 1e-10],
+          ["max_count_nb"         , {"FLUPS_COMM" : "nb"}                  , "4", "1,2,2", "./flups_validation_small", 1e-10],
+          ["max_count_rma"        , {"FLUPS_COMM" : "rma"}                 , "4", "1,2,2", "./flups_validation_small", 1e-10],
+          ["rounds"               , {"FLUPS_COMM" : "a2a"}                 , "4", "1,2,2", "./flups_validation_small", 1e-10],
+          ["a2aw"                 , {"FLUPS_COMM" : "a2aw"}                , "4", "1,2,2", "./flups_validation"      , 1e-10],
+          ["reorder"              , {"FLUPS_REORDER" : "1"}                , "4", "1,2,2", "./flups_validation"      , 1e-10],
+          ["node_aware"           , {"FLUPS_NODE_AWARE" : "1"}             , "4", "1,2,2", "./flups_validation"      , 1e-10],
+          ["hint_nproc"           , {}                                     , "4", "0,0,0", "./flups_validation"      , 1e-10],
+          ["slab"                 , {"FLUPS_SLAB" : "1"}                   , "4", "1,2,2", "./flups_validation"      , 1e-10],
+          ["order_model"          , {"FLUPS_ORDER" : "model"}              , "4", "1,2,2", "./flups_validation"      , 1e-10],
+          ["order_timed"          , {"FLUPS_ORDER" : "timed"}              , "4", "1,2,2", "./flups_validation"      , 1e-10],
+          ["subset"               , {"FLUPS_SUBSET" : "2"}                 , "4", "1,2,2", "./flups_validation"      , 1e-10],
+          ["float_transport_a2a"  , {"FLUPS_FLOAT_TRANSPORT" : "1", "FLUPS_COMM" : "a2a"}, "4", "1,2,2", "./flups_validation", 1e-6],
+          ["float_transport_rma"  , {"FLUPS_FLOAT_TRANSPORT" : "1", "FLUPS_COMM" : "rma"}, "4", "1,2,2", "./flups_validation", 1e-6],
+          ["single_prec"          , {}                                     , "4", "1,2,2", "./flups_validation_f"    , 1e-4]]
+
+# the default run does not see any FLUPS_* variable from the shell
+env_default = {k : v for k, v in os.environ.items() if not k.startswith("FLUPS_")}
+
+def run(exe, nproc, np, env, kern, lda, str_bcs, outdir):
+    # the error files are appended, start from a clean directory
+    shutil.rmtree(outdir, ignore_errors=True)
+    os.makedirs(outdir)
+    return subprocess.run(["mpirun"] + ["-np"] + [nproc] + [exe] + ["--np="+np] + ["--kernel="+kern] + ["--center=" + str(centerType)] + ["--res=16,16,16"] + ["--nres=1"] + ["--lda="+lda] + ["--bc="+str_bcs] + ["--outdir="+outdir], env=env, capture_output=True)
+
+def print_failure(i, msg, r):
+    print("test %i ( "%i + msg + ") failed with error code ",r.returncode)
+    print("=================================== STDOUT =============================================" )
+    print(r.stdout.decode())
+    print("=================================== STDERR =============================================" )
+    print(r.stderr.decode())
+    print("=================================== ====== =============================================\n" )
+
+#Running all combinations of bcs, lda and cases
+n_success = 0
+n_failure = 0
+n_skipped = 0
+
+print("Starting the tests...")
+
+i = 0
+for bcs in BCs :
+    for lda in Ldas :
+        code    = ''.join(bcs)
+        str_bcs = ','.join(bcs)
+        file    = 'validation_3d_' + centername + '_' + code + '_typeGreen=0.txt'
+        refdir  = './comm/default_' + code + '_lda' + lda
+
+        # Launching the reference
+        r = run("./flups_validation", "4", "1,2,2", env_default, "0", lda, str_bcs, refdir)
+        if r.returncode != 0 :
+            i+=1
+            print_failure(i, centername + " - BCs : " + code + " - lda=" + lda + " - default", r)
+            n_failure += 1
+            continue
+
+        for case in Cases :
+            i+=1
+            name  = case[0]
+            msg   = centername + " - BCs : " + code + " - lda=" + lda + " - " + name
+            env   = env_default.copy()
+            env.update(case[1])
+
+            print("----- %i -----"%i, flush=True)
+
+            if not os.path.exists(case[4]) :
+                print("test %i ( "%i + msg + ") skipped, " + case[4] + " does not exist")
+                n_skipped += 1
+                continue
+
+            curdir = './comm/' + name + '_' + code + '_lda' + lda
+            r = run(case[4], case[2], case[3], env, "0", lda, str_bcs, curdir)
+            if r.returncode != 0 :
+                print_failure(i, msg, r)
+                n_failure += 1
+                continue
+
+            #Checking the results against the default run
+            n_mistake = check_res_comm(i, file, refdir, curdir, case[5])
+            if n_mistake==0:
+                print("test %i ( "%i + msg + ") succeeded")
+                n_success += 1
+            else:
+                print("test %i ( "%i + msg + ") failed with wrong values.")
+                print("/!\ -- /!\ -- /!\ -- /!\ -- /!\ -- /!\ -- /!\ -- /!\ -- /!\ -- /!\ -- /!\ -- /!\ -- /!\ \n")
+                n_failure += 1
+
+print("%i test succeeded out of %i (%i skipped)" % (n_success,n_success+n_failure,n_skipped))
+exit(n_failure)
@@ -4,7 +4,9 @@
  *      See LICENSE file in top-level directory
  */
 
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
 #include <iostream>
 
 #include "mpi.h"
@@ -34,6 +36,12 @@ int main(int argc, char *argv[]) {
     // set MPI_THREAD_FUNNELED or MPI_THREAD_SERIALIZED
     // int requested = MPI_THREAD_FUNNELED;
     int requested = MPI_THREAD_SINGLE;
+    // the level can be raised with VALIDATION_THREAD_LEVEL (0=single, 1=funneled, 2=serialized, 3=multiple), see scripts/test_3D_comm.py
+    const char *env_thread = std::getenv("VALIDATION_THREAD_LEVEL");
+    if (env_thread != NULL) {
+        const int levels[4] = {MPI_THREAD_SINGLE, MPI_THREAD_FUNNELED, MPI_THREAD_SERIALIZED, MPI_THREAD_MULTIPLE};
+        requested           = levels[std::max(0, std::min(3, std::atoi(env_thread)))];
+    }
     MPI_Init_thread(&argc, &argv, requested, &provided);
     if(provided < requested){
         printf("The MPI-provided thread behavior does not match\n");
@@ -55,7 +63,7 @@ int main(int argc, char *argv[]) {
     auto arg_outputdir = parser.GetValue<std::string>("--outdir", "the output directory for the error","./");
 
     // Retreive the vector value
-    auto arg_nprocs = parser.GetValues<int, 3>("--np", "the number of processes in each direction", {1, 1, 1});
+    auto arg_nprocs = parser.GetValues<int, 3>("--np", "the number of processes in each direction (0,0,0 to use the one proposed by FLUPS)", {1, 1, 1});
     auto arg_nres   = parser.GetValues<int, 3>("--res", "the number of unknowns each direction", {16, 16, 16});
     auto arg_L = parser.GetValues<double, 3>("--dom", "the size of the domain each direction", {1., 1., 1.});
     auto arg_bc = parser.GetValues<int, 6>("--bc",
@@ -31,7 +31,7 @@ void validation_3d(const DomainDescr myCase, const FLUPS_GreenType typeGreen, co
     MPI_Comm_rank(comm, &rank);
     MPI_Comm_size(comm, &comm_size);
 
-    const int *   nproc  = myCase.nproc;
+    int           nproc[3] = {myCase.nproc[0], myCase.nproc[1], myCase.nproc[2]};
     const double *L      = myCase.L;
 
     const bool is_cell = myCase.center_type[0] == CELL_CENTER; 
@@ -72,6 +72,12 @@ void validation_3d(const DomainDescr myCase, const FLUPS_GreenType typeGreen, co
         }
     }
 
+    // a proc repartition of 0 asks FLUPS to choose it
+    if (nproc[0] * nproc[1] * nproc[2] == 0) {
+        flups_hint_proc_repartition(lda, nglob, h, L, mybc, center_type, comm, nproc);
+        if (rank == 0) printf("proc repartition proposed by FLUPS: %d,%d,%d\n", nproc[0], nproc[1], nproc[2]);
+    }
+
     // create a real topology
     FLUPS_Topology *topo = flups_topo_new(0, lda, nglob, nproc, false, NULL, FLUPS_ALIGNMENT, comm);
     // const Topology *topo    = new Topology(0, 1, nglob, nproc, false, NULL,FLUPS_ALIGNMENT,comm);
@@ -100,12 +106,12 @@ void validation_3d(const DomainDescr myCase, const FLUPS_GreenType typeGreen, co
     /** - allocate rhs and solution */
     //-------------------------------------------------------------------------
     m_profStart(prof, "Validation--Init-RHS");
-    double *rhs   = (double *)flups_malloc(sizeof(double) * flups_topo_get_memsize(topo));
-    double *sol   = (double *)flups_malloc(sizeof(double) * flups_topo_get_memsize(topo));
-    double *field = (double *)flups_malloc(sizeof(double) * flups_topo_get_memsize(topo));
-    std::memset(rhs, 0, sizeof(double) * flups_topo_get_memsize(topo));
-    std::memset(sol, 0, sizeof(double) * flups_topo_get_memsize(topo));
-    std::memset(field, 0, sizeof(double) * flups_topo_get_memsize(topo));
+    flups_real *rhs   = (flups_real *)flups_malloc(sizeof(flups_real) * flups_topo_get_memsize(topo));
+    flups_real *sol   = (flups_real *)flups_malloc(sizeof(flups_real) * flups_topo_get_memsize(topo));
+    flups_real *field = (flups_real *)flups_malloc(sizeof(flups_real) * flups_topo_get_memsize(topo));
+    std::memset(rhs, 0, sizeof(flups_real) * flups_topo_get_memsize(topo));
+    std::memset(sol, 0, sizeof(flups_real) * flups_topo_get_memsize(topo));
+    std::memset(field, 0, sizeof(flups_real) * flups_topo_get_memsize(topo));
 
 #ifndef MANUFACTURED_SOLUTION
     //-------------------------------------------------------------------------
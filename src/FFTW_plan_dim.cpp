@@ -50,6 +50,24 @@ void sort_plans(FFTW_plan_dim* plan[3]) {
     END_FUNC;
 }
 
+/**
+ * @brief puts the plans in the given order of the directions, which must keep the types sorted (see sort_plans)
+ *
+ * @param plan the list of plan, which will be reordered
+ * @param order the direction of each plan, in the order of execution
+ */
+void order_plans(FFTW_plan_dim* plan[3], const int order[3]) {
+    BEGIN_FUNC;
+    FFTW_plan_dim* old_plan[3] = {plan[0], plan[1], plan[2]};
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            if (old_plan[j]->dimID() == order[i]) plan[i] = old_plan[j];
+        }
+    }
+    FLUPS_CHECK((plan[0]->type() <= plan[1]->type()) && (plan[1]->type() <= plan[2]->type()), "Wrong order in the plans: %d %d %d", plan[0]->type(), plan[1]->type(), plan[2]->type());
+    END_FUNC;
+}
+
 /**
  * @brief returns the type of the plan for a given set of BC
  * 
@@ -171,11 +189,11 @@ FFTW_plan_dim::~FFTW_plan_dim() {
     if (type_ == SYMSYM || type_ == MIXUNB) {
         // if the solver is SYMSYM or MIXUNB, each dimension has its own plan
         for (int lia = 0; lia < lda_; lia++) {
-            if (plan_ != NULL) fftw_destroy_plan(plan_[lia]);
+            if (plan_ != NULL) FLUPS_FFTW(destroy_plan)(plan_[lia]);
         }
     } else {
         // else, the first plan is the same as all the other ones
-        if (plan_ != NULL) fftw_destroy_plan(plan_[0]);
+        if (plan_ != NULL) FLUPS_FFTW(destroy_plan)(plan_[0]);
     }
     
     // free the allocated arrays
@@ -251,7 +269,7 @@ void FFTW_plan_dim::init(const int size[3], const bool isComplex) {
  * @param isComplex if the transpoed data is complex or real
  * @param data the pointer to the transposed data (has to be allocated)
  */
-void FFTW_plan_dim::allocate_plan(const Topology *topo, double* data) {
+void FFTW_plan_dim::allocate_plan(const Topology *topo, flups_real* data) {
     BEGIN_FUNC;
     //-------------------------------------------------------------------------
     // allocate the plan
@@ -280,7 +298,7 @@ void FFTW_plan_dim::allocate_plan(const Topology *topo, double* data) {
  * @param data the pointer to the transposed data (has to be allocated)
  * 
  */
-void FFTW_plan_dim::allocate_plan_real_(const Topology *topo, double* data) {
+void FFTW_plan_dim::allocate_plan_real_(const Topology *topo, flups_real* data) {
     BEGIN_FUNC;
     //-------------------------------------------------------------------------
     /** - Sanity checks */
@@ -311,19 +329,19 @@ void FFTW_plan_dim::allocate_plan_real_(const Topology *topo, double* data) {
     /** - Create the plan  */
     //-------------------------------------------------------------------------
     // we make sure to use only 1 thread, the multi-threading is used in the solver, not inside a plan
-    fftw_plan_with_nthreads(1);
+    FLUPS_FFTW(plan_with_nthreads)(1);
 
     // allocate the plan
-    plan_ =(fftw_plan*) m_calloc(sizeof(fftw_plan) * lda_);
+    plan_ =(FLUPS_FFTW(plan)*) m_calloc(sizeof(FLUPS_FFTW(plan)) * lda_);
 
     // we initiate the plan with the size #n_in_, because this is the real number of data needed
     for (int lia = 0; lia < lda_; lia++) {
         if (topo->nf() == 1) {
             fftw_stride_ = memsize[dimID_];            
-            plan_[lia]   = fftw_plan_r2r_1d(n_in_[lia],  data + fftwstart_in_[lia],  data + fftwstart_out_[lia], kind_[lia], FLUPS_FFTW_FLAG);
+            plan_[lia]   = FLUPS_FFTW(plan_r2r_1d)(n_in_[lia],  data + fftwstart_in_[lia],  data + fftwstart_out_[lia], kind_[lia], FLUPS_FFTW_FLAG);
         } else if (topo->nf() == 2) {
             fftw_stride_ = memsize[dimID_] * topo->nf();
-            plan_[lia]   = fftw_plan_many_r2r(1, (int*)(&n_in_[lia]), 1,
+            plan_[lia]   = FLUPS_FFTW(plan_many_r2r)(1, (int*)(&n_in_[lia]), 1,
                                             data + fftwstart_in_[lia],  NULL, topo->nf(), memsize[dimID_] * topo->nf(),
                                             data + fftwstart_out_[lia], NULL, topo->nf(), memsize[dimID_] * topo->nf(), kind_ + lia, FLUPS_FFTW_FLAG);
         }
@@ -360,7 +378,7 @@ void FFTW_plan_dim::allocate_plan_real_(const Topology *topo, double* data) {
  * @param memsize the size of the data BEFORE THE PLAN is executed
  * @param data memory
  */
-void FFTW_plan_dim::allocate_plan_complex_(const Topology *topo, double* data) {
+void FFTW_plan_dim::allocate_plan_complex_(const Topology *topo, flups_real* data) {
     BEGIN_FUNC;
 
     assert(data != NULL);
@@ -388,7 +406,7 @@ void FFTW_plan_dim::allocate_plan_complex_(const Topology *topo, double* data) {
     fftw_stride_ = memsize[dimID_];
 
     // allocate the plan
-    plan_ =(fftw_plan*) m_calloc(sizeof(fftw_plan) * lda_);
+    plan_ =(FLUPS_FFTW(plan)*) m_calloc(sizeof(FLUPS_FFTW(plan)) * lda_);
        
     if (isr2c_) {
         FLUPS_CHECK(topo->nf() == 1, "the nf of the input topology has to be 1 = real topo");
@@ -413,9 +431,9 @@ void FFTW_plan_dim::allocate_plan_complex_(const Topology *topo, double* data) {
         FLUPS_INFO("------------------------------------------");
 
         if (sign_ == FLUPS_FORWARD) {
-            plan_[0] = fftw_plan_dft_r2c_1d(n_in_[0], data + fftwstart_in_[0], (fftw_complex*)data + fftwstart_out_[0], FLUPS_FFTW_FLAG);
+            plan_[0] = FLUPS_FFTW(plan_dft_r2c_1d)(n_in_[0], data + fftwstart_in_[0], (FLUPS_FFTW(complex)*)data + fftwstart_out_[0], FLUPS_FFTW_FLAG);
         } else {
-            plan_[0] = fftw_plan_dft_c2r_1d(n_in_[0], (fftw_complex*)data + fftwstart_in_[0], data+ fftwstart_out_[0], FLUPS_FFTW_FLAG);
+            plan_[0] = FLUPS_FFTW(plan_dft_c2r_1d)(n_in_[0], (FLUPS_FFTW(complex)*)data + fftwstart_in_[0], data+ fftwstart_out_[0], FLUPS_FFTW_FLAG);
         }
 
     } else {
@@ -437,7 +455,7 @@ void FFTW_plan_dim::allocate_plan_complex_(const Topology *topo, double* data) {
         FLUPS_INFO("fftw stride   = %d", fftw_stride_);
         FLUPS_INFO("size n    = %d", n_in_[0]);
         FLUPS_INFO("------------------------------------------");
-        plan_[0] = (fftw_plan_dft_1d(n_in_[0], (fftw_complex*) data + fftwstart_in_[0], (fftw_complex*)data + fftwstart_out_[0], sign_, FLUPS_FFTW_FLAG));
+        plan_[0] = (FLUPS_FFTW(plan_dft_1d)(n_in_[0], (FLUPS_FFTW(complex)*) data + fftwstart_in_[0], (FLUPS_FFTW(complex)*)data + fftwstart_out_[0], sign_, FLUPS_FFTW_FLAG));
     }
 
     // the plan is the same in every other direction
@@ -457,7 +475,7 @@ void FFTW_plan_dim::allocate_plan_complex_(const Topology *topo, double* data) {
  * @param topo
  * @param data
  */
-void FFTW_plan_dim::check_dataAlign_(const Topology* topo, double* data) const {
+void FFTW_plan_dim::check_dataAlign_(const Topology* topo, flups_real* data) const {
 #ifndef NDEBUG
     const size_t howmany = howmany_;
     const size_t onmax   = howmany_ * lda_;
@@ -468,7 +486,7 @@ void FFTW_plan_dim::check_dataAlign_(const Topology* topo, double* data) const {
         size_t io  = id % howmany;
         size_t lia = id / howmany;
         // get the memory
-        double* mydata = nullptr;
+        flups_real* mydata = nullptr;
         if (type_ == SYMSYM || type_ == MIXUNB) {
             mydata = data + lia * memdim + io * fftw_stride_;
         } else if (type_ == PERPER || type_ == UNBUNB) {
@@ -479,7 +497,7 @@ void FFTW_plan_dim::check_dataAlign_(const Topology* topo, double* data) const {
             }
         }
         // check the alignment
-        FLUPS_CHECK(fftw_alignment_of(mydata) == 0, "data for FFTW have to be aligned on the FFTW alignement! Alignment is %d with id = %zu and fftw_stride = %d", fftw_alignment_of(mydata), id, fftw_stride_);
+        FLUPS_CHECK(FLUPS_FFTW(alignment_of)(mydata) == 0, "data for FFTW have to be aligned on the FFTW alignement! Alignment is %d with id = %zu and fftw_stride = %d", FLUPS_FFTW(alignment_of)(mydata), id, fftw_stride_);
     }
 #endif
 }
@@ -492,7 +510,7 @@ void FFTW_plan_dim::check_dataAlign_(const Topology* topo, double* data) const {
  *
  * @param data
  */
-void FFTW_plan_dim::postprocess_plan(const Topology* topo, double* data) {
+void FFTW_plan_dim::postprocess_plan(const Topology* topo, flups_real* data) {
     BEGIN_FUNC;
     // check the data alignment
     check_dataAlign_(topo, data);
@@ -528,7 +546,7 @@ void FFTW_plan_dim::postprocess_plan(const Topology* topo, double* data) {
         const bool do_nothing       = (!do_first) && (!do_last) && (!enforce_period);
         //----------------------------------------------------------------------
         // get the starting point of the data
-        opt_double_ptr mydata = data + lia * memdim;
+        opt_real_ptr mydata = data + lia * memdim;
 
         //----------------------------------------------------------------------
         if (reset_first) {
@@ -536,7 +554,7 @@ void FFTW_plan_dim::postprocess_plan(const Topology* topo, double* data) {
 #pragma omp parallel for proc_bind(close) schedule(static) default(none) firstprivate(mydata, fftw_stride, howmany, nloc)
             for (size_t io = 0; io < howmany; io++) {
                 // get the memory
-                opt_double_ptr dataloc = mydata + io * fftw_stride;
+                opt_real_ptr dataloc = mydata + io * fftw_stride;
                 // reset the first point of each 1-D transform
                 dataloc[0] = 0.0;
             }
@@ -548,7 +566,7 @@ void FFTW_plan_dim::postprocess_plan(const Topology* topo, double* data) {
 #pragma omp parallel for proc_bind(close) schedule(static) default(none) firstprivate(mydata, fftw_stride, howmany, nloc)
             for (size_t io = 0; io < howmany; io++) {
                 // get the memory
-                opt_double_ptr dataloc = mydata + io * fftw_stride;
+                opt_real_ptr dataloc = mydata + io * fftw_stride;
                 // reset the last point of each 1-D transform
                 dataloc[nloc - 1] = 0.0;
             }
@@ -560,7 +578,7 @@ void FFTW_plan_dim::postprocess_plan(const Topology* topo, double* data) {
 #pragma omp parallel for proc_bind(close) schedule(static) default(none) firstprivate(mydata, fftw_stride, howmany, nloc)
             for (size_t io = 0; io < howmany; io++) {
                 // get the memory
-                opt_double_ptr dataloc = mydata + io * fftw_stride;
+                opt_real_ptr dataloc = mydata + io * fftw_stride;
                 // reset the first point
                 dataloc[0] = 0.0;
                 // reset the last point
@@ -592,14 +610,14 @@ void FFTW_plan_dim::postprocess_plan(const Topology* topo, double* data) {
             if(real_dmn){
 #pragma omp parallel for proc_bind(close) schedule(static) default(none) firstprivate(mydata, fftw_stride, howmany, nfftw)
                 for (size_t io = 0; io < howmany; io++) {
-                    opt_double_ptr dataloc = mydata + io * fftw_stride;
+                    opt_real_ptr dataloc = mydata + io * fftw_stride;
                     dataloc[nfftw] = dataloc[0];
                 }
             } else {
 #pragma omp parallel for proc_bind(close) schedule(static) default(none) firstprivate(mydata, fftw_stride, howmany, nfftw)
                 for (size_t io = 0; io < howmany; io++) {
                     // get the memory
-                    opt_double_ptr dataloc = mydata + io * fftw_stride;
+                    opt_real_ptr dataloc = mydata + io * fftw_stride;
                     dataloc[2*nfftw] = dataloc[0];
                     dataloc[2*nfftw + 1] = dataloc[1];
                 }
@@ -630,7 +648,7 @@ void FFTW_plan_dim::postprocess_plan(const Topology* topo, double* data) {
  * Then, we have to use the memdim() function of the Topology
  * 
  */
-void FFTW_plan_dim::execute_plan(const Topology* topo, double* data) const {
+void FFTW_plan_dim::execute_plan(const Topology* topo, flups_real* data) const {
     BEGIN_FUNC;
     FLUPS_CHECK(!isSpectral_, "Trying to execute a plan for data which has already been setup spectraly");
     FLUPS_CHECK(topo->lda() == lda_, "The given topology's lda does not match with the initialisation one");
@@ -654,7 +672,7 @@ void FFTW_plan_dim::execute_plan(const Topology* topo, double* data) const {
     const size_t fftw_stride = (size_t)fftw_stride_;
     const size_t memdim      = topo->memdim();
     // get the plan pointer
-    const fftw_plan* plan = plan_;
+    const FLUPS_FFTW(plan)* plan = plan_;
 
     //-------------------------------------------------------------------------
     /** - check the alignment if needed. Cannot be done inside the loop when compiling with GCC and default(none) */
@@ -671,9 +689,9 @@ void FFTW_plan_dim::execute_plan(const Topology* topo, double* data) const {
             size_t lia = id / howmany;
             size_t io  = id % howmany;
             // get the memory
-            double* mydata = (double*)data + lia * memdim + io * fftw_stride;
+            flups_real* mydata = (flups_real*)data + lia * memdim + io * fftw_stride;
             // execute the plan on it
-            fftw_execute_r2r(plan[lia], (double*)mydata + fftwstart_in_[lia], (double*)mydata + fftwstart_out_[lia]);
+            FLUPS_FFTW(execute_r2r)(plan[lia], (flups_real*)mydata + fftwstart_in_[lia], (flups_real*)mydata + fftwstart_out_[lia]);
         }
     } else if (type_ == PERPER || type_ == UNBUNB) {
         if (isr2c_) {
@@ -684,9 +702,9 @@ void FFTW_plan_dim::execute_plan(const Topology* topo, double* data) const {
                     size_t lia = id / howmany;
                     size_t io  = id % howmany;
                     // get the memory
-                    double* mydata = (double*)data + lia * memdim + io * fftw_stride;
+                    flups_real* mydata = (flups_real*)data + lia * memdim + io * fftw_stride;
                     // execute the plan on it
-                    fftw_execute_dft_r2c(plan[lia], (double*)mydata + fftwstart_in_[lia], (fftw_complex*)mydata  + fftwstart_out_[lia]);
+                    FLUPS_FFTW(execute_dft_r2c)(plan[lia], (flups_real*)mydata + fftwstart_in_[lia], (FLUPS_FFTW(complex)*)mydata  + fftwstart_out_[lia]);
                 }
             } else {  // DFT - C2R
                 FLUPS_CHECK(topo->nf() == 2, "nf should be 2 at this stage");
@@ -695,9 +713,9 @@ void FFTW_plan_dim::execute_plan(const Topology* topo, double* data) const {
                     size_t lia = id / howmany;
                     size_t io  = id % howmany;
                     // WARNING the stride is given in the input size =  REAL => id * fftw_stride_/2 * nf = id * fftw_stride_
-                    double* mydata = (double*)data + lia * memdim + io * fftw_stride;
+                    flups_real* mydata = (flups_real*)data + lia * memdim + io * fftw_stride;
                     // execute the plan on it
-                    fftw_execute_dft_c2r(plan[lia], (fftw_complex*)mydata + fftwstart_in_[lia], (double*)mydata + fftwstart_out_[lia]);
+                    FLUPS_FFTW(execute_dft_c2r)(plan[lia], (FLUPS_FFTW(complex)*)mydata + fftwstart_in_[lia], (flups_real*)mydata + fftwstart_out_[lia]);
                 }
             }
 
@@ -708,9 +726,9 @@ void FFTW_plan_dim::execute_plan(const Topology* topo, double* data) const {
                 size_t lia = id / howmany;
                 size_t io  = id % howmany;
                 // we access complex info with a fftw_stride real
-                double* mydata = (double*)data + lia * memdim + io * fftw_stride * 2;
+                flups_real* mydata = (flups_real*)data + lia * memdim + io * fftw_stride * 2;
                 // execute the plan on it
-                fftw_execute_dft(plan[lia], (fftw_complex*)mydata + fftwstart_in_[lia], (fftw_complex*) mydata + fftwstart_out_[lia]);
+                FLUPS_FFTW(execute_dft)(plan[lia], (FLUPS_FFTW(complex)*)mydata + fftwstart_in_[lia], (FLUPS_FFTW(complex)*) mydata + fftwstart_out_[lia]);
             }
         }
     }
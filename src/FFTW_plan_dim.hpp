@@ -88,8 +88,8 @@ class FFTW_plan_dim {
     BoundaryType*  bc_[2]        = {NULL, NULL}; /**< @brief boundary condition for the ith component [0][i]=LEFT/MIN - [1][i]=RIGHT/MAX*/
     int*           postpro_type_ = NULL;         /**< @brief correction type of this plan, see #PlanPostproType*/
     bool*          imult_        = NULL;         /**< @brief boolean indicating that we have to multiply by (-i) in forward and (i) in backward*/
-    fftw_r2r_kind* kind_         = NULL;         /**< @brief kind of transfrom to perform (used by r2r and mix plan only)*/
-    fftw_plan*     plan_         = NULL;         /**< @brief the array of FFTW plan*/
+    FLUPS_FFTW(r2r_kind)* kind_         = NULL;         /**< @brief kind of transfrom to perform (used by r2r and mix plan only)*/
+    FLUPS_FFTW(plan)*     plan_         = NULL;         /**< @brief the array of FFTW plan*/
 
    public:
     FFTW_plan_dim(const int lda, const int dimID, const double h[3], const double L[3], BoundaryType* mybc[2], const int sign, const bool isGreen);
@@ -97,9 +97,9 @@ class FFTW_plan_dim {
 
     void init(const int size[3], const bool isComplex);
 
-    void allocate_plan(const Topology* topo, double* data);
-    void execute_plan(const Topology* topo, double* data) const;
-    void postprocess_plan(const Topology*, double* data);
+    void allocate_plan(const Topology* topo, flups_real* data);
+    void execute_plan(const Topology* topo, flups_real* data) const;
+    void postprocess_plan(const Topology*, flups_real* data);
 
     /**
      * @name Getters - return the value
@@ -137,14 +137,14 @@ class FFTW_plan_dim {
     void disp();
 
    protected:
-    void check_dataAlign_(const Topology* topo, double* data) const;
+    void check_dataAlign_(const Topology* topo, flups_real* data) const;
 
     /**
      * @name Plan allocation
      */
     /**@{ */
-    void allocate_plan_real_(const Topology* topo, double* data);
-    void allocate_plan_complex_(const Topology* topo, double* data);
+    void allocate_plan_real_(const Topology* topo, flups_real* data);
+    void allocate_plan_complex_(const Topology* topo, flups_real* data);
     /**@} */
 
     /**
@@ -162,6 +162,7 @@ class FFTW_plan_dim {
 
 void sort_priority(std::array<std::tuple<int, int>, 3>* priority);
 void sort_plans(FFTW_plan_dim* plan[3]);
+void order_plans(FFTW_plan_dim* plan[3], const int order[3]);
 int  bc_to_types(const BoundaryType* bc[2]);
 
 #endif
\ No newline at end of file
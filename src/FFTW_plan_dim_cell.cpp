@@ -51,7 +51,7 @@ void FFTW_plan_dim_cell::init_real2real_(const int size[3], const bool isComplex
     //-------------------------------------------------------------------------
     /** - Get the #kind_ of Fourier transforms, the #koffset_ for each dimension */
     //-------------------------------------------------------------------------
-    kind_     = (fftw_r2r_kind*)m_calloc(sizeof(fftw_r2r_kind) * lda_);
+    kind_     = (FLUPS_FFTW(r2r_kind)*)m_calloc(sizeof(FLUPS_FFTW(r2r_kind)) * lda_);
 
     // because of the constrain on the BC, we only the kind argument is linked to the lia
     // while the other values (n_in, n_out and koffset) will remain unchanged accross the lda
@@ -223,7 +223,7 @@ void FFTW_plan_dim_cell::init_mixunbounded_(const int size[3], const bool isComp
     //-------------------------------------------------------------------------
     /** - Get the #kind_ of Fourier transforms */
     //-------------------------------------------------------------------------
-    kind_ = (fftw_r2r_kind*)m_calloc(sizeof(fftw_r2r_kind) * lda_);
+    kind_ = (FLUPS_FFTW(r2r_kind)*)m_calloc(sizeof(FLUPS_FFTW(r2r_kind)) * lda_);
 
     for (int lia = 0; lia < lda_; lia++) {
         if (isGreen_) {
@@ -0,0 +1,145 @@
+/**
+ * @file ProgressThread.cpp
+ * @copyright Copyright (c) Université catholique de Louvain (UCLouvain), Belgique
+ *      See LICENSE file in top-level directory
+*/
+#include "ProgressThread.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "omp.h"
+
+/**
+ * @brief Construct a new Progress Thread object and start the (inactive) thread
+ *
+ * The core of the thread is chosen here, as it needs MPI: see @ref pick_core_.
+ *
+ * @param comm the communicator to duplicate for the probing
+ */
+ProgressThread::ProgressThread(MPI_Comm comm) : is_active_(false), is_running_(true) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    MPI_Comm_dup(comm, &comm_);
+    pick_core_();
+    thread_ = std::thread(&ProgressThread::loop_, this);
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+ProgressThread::~ProgressThread() {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_running_ = false;
+        is_active_  = false;
+    }
+    cv_.notify_one();
+    thread_.join();
+    MPI_Comm_free(&comm_);
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief wake up the thread, which starts to drive the progress
+ *
+ */
+void ProgressThread::activate() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_active_ = true;
+    }
+    cv_.notify_one();
+}
+
+/**
+ * @brief put the thread back to sleep
+ *
+ */
+void ProgressThread::deactivate() {
+    is_active_ = false;
+}
+
+/**
+ * @brief choose a spare core for the progress thread, not used by the OpenMP threads nor by the other ranks of the node
+ *
+ * The ranks of the node that share the same affinity mask (e.g. ranks that are not bound) take the last cores of the mask,
+ * one each, according to their rank among them. If there are not enough cores for the OpenMP threads and the progress threads
+ * of these ranks, the placement is left to the OS and the thread yields between two probes.
+ *
+ */
+void ProgressThread::pick_core_() {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    const bool has_mask = (sched_getaffinity(0, sizeof(cpu_set_t), &cpuset) == 0);
+
+    // the ranks of the node with the same mask are identified by the first core of their mask
+    int first_cpu = -1;
+    for (int ic = 0; ic < CPU_SETSIZE && has_mask && first_cpu < 0; ++ic) {
+        if (CPU_ISSET(ic, &cpuset)) first_cpu = ic;
+    }
+    MPI_Comm node_comm, mask_comm;
+    MPI_Comm_split_type(comm_, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+    MPI_Comm_split(node_comm, (first_cpu < 0) ? MPI_UNDEFINED : first_cpu, 0, &mask_comm);
+    int nshare = 1, share_rank = 0;
+    if (mask_comm != MPI_COMM_NULL) {
+        MPI_Comm_size(mask_comm, &nshare);
+        MPI_Comm_rank(mask_comm, &share_rank);
+        MPI_Comm_free(&mask_comm);
+    }
+    MPI_Comm_free(&node_comm);
+
+    // we need a spare core for every rank sharing the mask, otherwise we leave the placement to the OS
+    const int ncpu = has_mask ? CPU_COUNT(&cpuset) : 0;
+    if (has_mask && ncpu >= nshare * (omp_get_max_threads() + 1)) {
+        // take the (share_rank)-th core starting from the end of the mask
+        int count = 0;
+        for (int ic = CPU_SETSIZE - 1; ic >= 0 && core_ < 0; --ic) {
+            if (CPU_ISSET(ic, &cpuset) && (count++) == share_rank) core_ = ic;
+        }
+    } else {
+        FLUPS_INFO("no spare core for the progress thread: %d cores for %d ranks with %d threads", ncpu, nshare, omp_get_max_threads());
+    }
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief pin the thread on the core chosen by @ref pick_core_, if any
+ *
+ */
+void ProgressThread::pin_() {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    if (core_ >= 0) {
+        cpu_set_t progress_set;
+        CPU_ZERO(&progress_set);
+        CPU_SET(core_, &progress_set);
+        is_pinned_ = (0 == pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &progress_set));
+        FLUPS_INFO("progress thread pinned on core %d", core_);
+    }
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+void ProgressThread::loop_() {
+    pin_();
+    while (is_running_) {
+        // sleep until we are activated or terminated
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return is_active_ || !is_running_; });
+        }
+        // drive the progress as long as we are active
+        while (is_active_) {
+            int flag;
+            MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, comm_, &flag, MPI_STATUS_IGNORE);
+            // do not steal the core of the computational threads
+            if (!is_pinned_) std::this_thread::yield();
+        }
+    }
+}
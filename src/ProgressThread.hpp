@@ -0,0 +1,49 @@
+/**
+ * @file ProgressThread.hpp
+ * @copyright Copyright (c) Université catholique de Louvain (UCLouvain), Belgique
+ *      See LICENSE file in top-level directory
+*/
+#ifndef SRC_PROGRESSTHREAD_HPP_
+#define SRC_PROGRESSTHREAD_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "defines.hpp"
+
+/**
+ * @brief Thread driving the MPI progress engine while the switchtopos are executed
+ *
+ * While active, the thread continuously probes a private communicator on which no message is ever sent.
+ * This forces the MPI library to progress the outstanding requests (e.g. the MPI_Ialltoallv of the a2a)
+ * while the master thread is busy with the memset, the shuffles or the copies.
+ * While inactive, the thread sleeps and does not consume any CPU time.
+ *
+ * @warning requires MPI_THREAD_MULTIPLE
+ */
+class ProgressThread {
+    MPI_Comm                comm_ = MPI_COMM_NULL;  //!< private communicator used to probe
+    std::thread             thread_;                //!< the progress thread
+    std::mutex              mutex_;                 //!< mutex protecting the condition variable
+    std::condition_variable cv_;                    //!< condition variable used to wake up the thread
+    std::atomic<bool>       is_active_;             //!< true if the thread has to drive the progress
+    std::atomic<bool>       is_running_;            //!< false if the thread has to terminate
+    int                     core_      = -1;        //!< spare core on which the thread is pinned, -1 if none
+    bool                    is_pinned_ = false;     //!< true if the thread owns a spare core, otherwise it yields between two probes
+
+   public:
+    explicit ProgressThread(MPI_Comm comm);
+    ~ProgressThread();
+
+    void activate();
+    void deactivate();
+
+   protected:
+    void loop_();
+    void pick_core_();
+    void pin_();
+};
+
+#endif
@@ -0,0 +1,127 @@
+/**
+ * @file SendSchedule.cpp
+ * @copyright Copyright (c) Université catholique de Louvain (UCLouvain), Belgique
+ *      See LICENSE file in top-level directory
+*/
+#include "SendSchedule.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+/**
+ * @brief throttlings tried during the adaptation: {number of sends started at once, max number of sends in flight}
+ *
+ * The first one is the compile-time one, which is also used for the warm-up execution.
+ */
+static const int n_throttle              = 4;
+static const int throttle[n_throttle][2] = {{FLUPS_MPI_BATCH_SEND, FLUPS_MPI_MAX_NBSEND}, {INT_MAX, INT_MAX}, {1, 4}, {4, 16}};
+
+/**
+ * @brief Construct a new Send Schedule object
+ *
+ * @param n_send the number of sends (including the self communication if any)
+ * @param comm the communicator on which the executions are done
+ */
+SendSchedule::SendSchedule(const int n_send, MPI_Comm comm) : n_send_(n_send), comm_(comm) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    batch_        = throttle[0][0];
+    max_inflight_ = throttle[0][1];
+#if (FLUPS_MPI_ADAPT_SEND)
+    t_start_    = reinterpret_cast<double *>(m_calloc(m_max(n_send_, 1) * sizeof(double)));
+    latency_    = reinterpret_cast<double *>(m_calloc(m_max(n_send_, 1) * sizeof(double)));
+    t_throttle_ = reinterpret_cast<double *>(m_calloc(n_throttle * sizeof(double)));
+    std::memset(latency_, 0, m_max(n_send_, 1) * sizeof(double));
+#else
+    // the schedule is already adapted
+    n_exec_ = n_throttle + 1;
+#endif
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+SendSchedule::~SendSchedule() {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    if (t_start_ != nullptr) m_free(t_start_);
+    if (latency_ != nullptr) m_free(latency_);
+    if (t_throttle_ != nullptr) m_free(t_throttle_);
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief starts an execution: sets the throttling to try and the recording of the latencies
+ *
+ * The first execution is a warm-up (connections setup, first touch, etc.) and is not recorded.
+ */
+void SendSchedule::start_exec() {
+    //--------------------------------------------------------------------------
+    is_recording_ = (n_exec_ >= 1) && (n_exec_ <= n_throttle);
+    if (is_recording_) {
+        batch_        = throttle[n_exec_ - 1][0];
+        max_inflight_ = throttle[n_exec_ - 1][1];
+        t_exec_       = MPI_Wtime();
+    }
+    //--------------------------------------------------------------------------
+}
+
+/**
+ * @brief ends an execution and adapts the schedule once every throttling has been tried
+ *
+ * This function is collective on the communicator as long as the schedule is not adapted.
+ *
+ * @param self_idx the index of the self communication chunk (-1 if none)
+ * @param send_order the send order, reordered if the schedule is adapted
+ * @param new_ridx if the schedule is adapted, the new position in the send order of every position in the former order (size n_send)
+ * @return true if the send order has been changed (the backend must then update the data indexed by the send order)
+ */
+bool SendSchedule::end_exec(const int self_idx, int *send_order, int *new_ridx) {
+    //--------------------------------------------------------------------------
+    const bool was_recording = is_recording_;
+    is_recording_            = false;
+    ++n_exec_;
+    if (!was_recording) {
+        return false;
+    }
+
+    // the execution time is the one of the slowest rank
+    double t_exec = MPI_Wtime() - t_exec_;
+    MPI_Allreduce(MPI_IN_PLACE, &t_exec, 1, MPI_DOUBLE, MPI_MAX, comm_);
+    t_throttle_[n_exec_ - 2] = t_exec;
+    if (n_exec_ <= n_throttle) {
+        return false;
+    }
+
+    //..........................................................................
+    // keep the fastest throttling, the times are the same on every rank
+    int best = 0;
+    for (int it = 1; it < n_throttle; ++it) {
+        best = (t_throttle_[it] < t_throttle_[best]) ? it : best;
+    }
+    batch_        = throttle[best][0];
+    max_inflight_ = throttle[best][1];
+
+    // the slowest peers are served first and the self communication, which does not depend on the network, last
+    int *old_order = reinterpret_cast<int *>(m_calloc(m_max(2 * n_send_, 1) * sizeof(int)));
+    std::memcpy(old_order, send_order, n_send_ * sizeof(int));
+    std::stable_sort(send_order, send_order + n_send_, [=](const int a, const int b) {
+        if (a == self_idx || b == self_idx) return (b == self_idx) && (a != self_idx);
+        return latency_[a] > latency_[b];
+    });
+    // the send order is a permutation of the chunk indexes: get the new position of every chunk
+    int *chunk_ridx = old_order + n_send_;
+    for (int ir = 0; ir < n_send_; ++ir) {
+        chunk_ridx[send_order[ir]] = ir;
+    }
+    bool is_changed = false;
+    for (int ir = 0; ir < n_send_; ++ir) {
+        new_ridx[ir] = chunk_ridx[old_order[ir]];
+        is_changed   = is_changed || (new_ridx[ir] != ir);
+    }
+    m_free(old_order);
+    FLUPS_INFO("send schedule adapted: batch = %d, max in flight = %d (%.3e s), order changed? %d", batch_, max_inflight_, t_throttle_[best], is_changed);
+    //--------------------------------------------------------------------------
+    return is_changed;
+}
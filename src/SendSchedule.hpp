@@ -0,0 +1,58 @@
+/**
+ * @file SendSchedule.hpp
+ * @copyright Copyright (c) Université catholique de Louvain (UCLouvain), Belgique
+ *      See LICENSE file in top-level directory
+*/
+#ifndef SRC_SENDSCHEDULE_HPP_
+#define SRC_SENDSCHEDULE_HPP_
+
+#include "defines.hpp"
+
+/**
+ * @brief Feedback-driven schedule of the sends of a non-blocking switchtopo (one per direction)
+ *
+ * After a warm-up execution, every execution tries a different throttling of the sends (number of sends started at once,
+ * max number of sends in flight) and records the time between the start of every send and the detection of its completion.
+ * Once all the throttlings have been tried, the schedule is adapted for the lifetime of the switchtopo:
+ * - the throttling leading to the fastest execution (max over the subcomm) is kept;
+ * - the sends are reordered by decreasing latency, the slowest peers being served first, and the self communication goes last.
+ *
+ * The send requests are identified by their position in the send order (= the id of the send request).
+ */
+class SendSchedule {
+    const int n_send_;                  //!< number of sends
+    MPI_Comm  comm_;                    //!< communicator used to compare the throttlings (not owned)
+    int       n_exec_       = 0;        //!< number of executions done so far
+    bool      is_recording_ = false;    //!< true if the latencies of the current execution are recorded
+    int       batch_        = 1;        //!< number of sends started at once
+    int       max_inflight_ = 1;        //!< max number of sends in flight
+    double    t_exec_       = 0.0;      //!< start time of the current execution
+    double*   t_start_      = nullptr;  //!< start time of each send (send order position)
+    double*   latency_      = nullptr;  //!< accumulated latency of each send chunk
+    double*   t_throttle_   = nullptr;  //!< execution time of each throttling
+
+   public:
+    explicit SendSchedule(const int n_send, MPI_Comm comm);
+    ~SendSchedule();
+
+    int batch() const { return batch_; }
+    int max_inflight() const { return max_inflight_; }
+
+    /**
+     * @brief registers the start of the send at position ridx of the send order
+     */
+    inline void start_send(const int ridx) {
+        if (is_recording_) t_start_[ridx] = MPI_Wtime();
+    }
+    /**
+     * @brief registers the completion of the send at position ridx of the send order, which sends the chunk ichunk
+     */
+    inline void end_send(const int ridx, const int ichunk) {
+        if (is_recording_) latency_[ichunk] += MPI_Wtime() - t_start_[ridx];
+    }
+
+    void start_exec();
+    bool end_exec(const int self_idx, int* send_order, int* new_ridx);
+};
+
+#endif
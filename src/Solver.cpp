@@ -10,6 +10,31 @@
 #include "FFTW_plan_dim_cell.hpp"
 #include "FFTW_plan_dim_node.hpp"
 
+/**
+ * @brief latency of a message and bandwidth of a rank (inside and between the nodes) used to model the cost of the switchtopos
+ */
+static const double cost_latency      = 2.0e-6;
+static const double cost_bw_intranode = 2.0e+10;
+static const double cost_bw_internode = 5.0e+9;
+
+/**
+ * @brief floating point rate of a rank used to model the cost of the FFTs
+ */
+static const double cost_flop_rate = 2.0e+9;
+
+/**
+ * @brief creates the plan of a direction for the given data location
+ */
+static FFTW_plan_dim *new_plan(const CenterType center, const int lda, const int dimID, const double h[3], const double L[3], BoundaryType *bc[2], const int sign, const bool isGreen) {
+    if (CELL_CENTER == center) {
+        return new FFTW_plan_dim_cell(lda, dimID, h, L, bc, sign, isGreen);
+    } else if (NODE_CENTER == center) {
+        return new FFTW_plan_dim_node(lda, dimID, h, L, bc, sign, isGreen);
+    }
+    FLUPS_CHECK(false, "The type of data you asked is not supported");
+    return NULL;
+}
+
 /**
  * @brief Constructs a fftw Poisson solver, initilizes the plans and determines their order of execution
  *
@@ -26,23 +51,23 @@ Solver::Solver(Topology *topo, BoundaryType *rhsbc[3][2], const double h[3], con
     // //-------------------------------------------------------------------------
     // /** - Initialize the OpenMP threads for FFTW */
     // //-------------------------------------------------------------------------
-    fftw_init_threads();
+    FLUPS_FFTW(init_threads)();
 #ifdef FLUPS_WISDOM_PATH
     FLUPS_WARNING("Importing wisdom from %s", FLUPS_WISDOM_PATH);
-    fftw_import_wisdom_from_filename(FLUPS_WISDOM_PATH);
+    FLUPS_FFTW(import_wisdom_from_filename)(FLUPS_WISDOM_PATH);
 #endif
 
     //-------------------------------------------------------------------------
     /** - Check the alignement in memory between FFTW and the one defines in @ref flups.h */
     //-------------------------------------------------------------------------
     // align a random array
-    int     alignSize = FLUPS_ALIGNMENT / sizeof(double);
-    double *data      = (double *)m_calloc(10 * alignSize * sizeof(double));
+    int         alignSize = FLUPS_ALIGNMENT / sizeof(flups_real);
+    flups_real *data      = (flups_real *)m_calloc(10 * alignSize * sizeof(flups_real));
     // initialize the fftw alignement
-    fftwalignment_ = (fftw_alignment_of(&(data[0])) == 0) ? sizeof(double) : 0;
+    fftwalignment_ = (FLUPS_FFTW(alignment_of)(&(data[0])) == 0) ? sizeof(flups_real) : 0;
     // get the fftw alignement and stop if it is lower than the one we assumed
     for (int i = 1; i < 10 * alignSize; i++) {
-        if (fftw_alignment_of(&(data[i])) == 0) {
+        if (FLUPS_FFTW(alignment_of)(&(data[i])) == 0) {
             // if we are above the minimum requirement, generate an error
             if (i > alignSize) {
                 FLUPS_CHECK(false, "The FLUPS alignement has to be a multiple integer of the FFTW alignement, please change the constant variable FLUPS_ALIGNMENT into file flups.h accordingly: FFTW=%d vs FLUPS=%d", fftwalignment_, FLUPS_ALIGNMENT);
@@ -50,7 +75,7 @@ Solver::Solver(Topology *topo, BoundaryType *rhsbc[3][2], const double h[3], con
             // else, just stop and advise the user to change
             break;
         }
-        fftwalignment_ += sizeof(double);
+        fftwalignment_ += sizeof(flups_real);
     }
     if (fftwalignment_ != FLUPS_ALIGNMENT) {
         FLUPS_WARNING("FFTW alignement is OK, yet not optimal: FFTW = %d vs FLUPS = %d", fftwalignment_, FLUPS_ALIGNMENT);
@@ -105,17 +130,9 @@ Solver::Solver(Topology *topo, BoundaryType *rhsbc[3][2], const double h[3], con
     // it might be empty ones but we keep them since we need some information inside...
     FLUPS_CHECK(centertype[0] == centertype[1] && centertype[0] == centertype[2], "We handle only data located at the same place in all the direction");
     for (int id = 0; id < 3; id++) {
-        if (CELL_CENTER == centertype[id]) {
-            plan_forward_[id]  = new FFTW_plan_dim_cell(lda_, id, h, L, rhsbc[id], FLUPS_FORWARD, false);
-            plan_backward_[id] = new FFTW_plan_dim_cell(lda_, id, h, L, rhsbc[id], FLUPS_BACKWARD, false);
-            plan_green_[id]    = new FFTW_plan_dim_cell(1, id, h, L, rhsbc[id], FLUPS_FORWARD, true);
-        } else if (NODE_CENTER == centertype[id]) {
-            plan_forward_[id]  = new FFTW_plan_dim_node(lda_, id, h, L, rhsbc[id], FLUPS_FORWARD, false);
-            plan_backward_[id] = new FFTW_plan_dim_node(lda_, id, h, L, rhsbc[id], FLUPS_BACKWARD, false);
-            plan_green_[id]    = new FFTW_plan_dim_node(1, id, h, L, rhsbc[id], FLUPS_FORWARD, true);
-        } else {
-            FLUPS_CHECK(false, "The type of data you asked is not supported");
-        }
+        plan_forward_[id]  = new_plan(centertype[id], lda_, id, h, L, rhsbc[id], FLUPS_FORWARD, false);
+        plan_backward_[id] = new_plan(centertype[id], lda_, id, h, L, rhsbc[id], FLUPS_BACKWARD, false);
+        plan_green_[id]    = new_plan(centertype[id], 1, id, h, L, rhsbc[id], FLUPS_FORWARD, true);
     }
 
     sort_plans(plan_forward_);
@@ -162,6 +179,27 @@ Solver::Solver(Topology *topo, BoundaryType *rhsbc[3][2], const double h[3], con
     /** - Initialise the topos, the plans and the SwitchTopos */
     //-------------------------------------------------------------------------
     topo_phys_ = topo;  // store pointer to the topo of the user
+    // if asked, the order of the directions having the same type is tuned, see @ref tune_order_
+    const char *env_order = std::getenv("FLUPS_ORDER");
+    if (env_order != NULL && (strcmp(env_order, "model") == 0 || strcmp(env_order, "timed") == 0)) {
+        int order[2][3];
+        tune_order_(topo, rhsbc, h, L, centertype, strcmp(env_order, "timed") == 0, order);
+        order_plans(plan_forward_, order[0]);
+        order_plans(plan_backward_, order[0]);
+        order_plans(plan_green_, order[1]);
+        if (odiff_ != NOD) {
+            order_plans(plan_backward_diff_, order[0]);
+        }
+    }
+    select_decomposition_(topo);
+    {
+        int comm_size, rank;
+        MPI_Comm_size(topo->get_comm(), &comm_size);
+        MPI_Comm_rank(topo->get_comm(), &rank);
+        if (rank == 0 && n_active_ < comm_size) {
+            FLUPS_INFO_1("the transforms are done by %d ranks out of %d", n_active_, comm_size);
+        }
+    }
     init_plansAndTopos_(topo, topo_hat_, switchtopo_, plan_forward_, false);
     init_plansAndTopos_(topo, NULL, NULL, plan_backward_, false);
     init_plansAndTopos_(topo, topo_green_, switchtopo_green_, plan_green_, true);
@@ -199,29 +237,100 @@ Solver::Solver(Topology *topo, BoundaryType *rhsbc[3][2], const double h[3], con
 }
 
 /**
- * @brief Sets up the Solver
+ * @brief gathers the node of every rank of comm, the node being identified by the lowest rank it hosts
  *
- * @param changeTopoComm determine if the user allows the solver to rewrite the communicator associated with the provided topo at the init (if compiled with REODRED_RANKS)
- *
- * @warning
- * To be able to change the communicator, the user MUST ensure that NOTHING has been done with the topology yet, except creating it.
- * Otherwise he will get unpredictable datas
+ * @param comm the communicator
+ * @param node the node of every rank (size of comm)
+ */
+static void gather_node_id(MPI_Comm comm, int *node) {
+    BEGIN_FUNC;
+    //-------------------------------------------------------------------------
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm node_comm;
+    int      node_id = rank;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+    MPI_Bcast(&node_id, 1, MPI_INT, 0, node_comm);
+    MPI_Comm_free(&node_comm);
+    MPI_Allgather(&node_id, 1, MPI_INT, node, 1, MPI_INT, comm);
+    //-------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief returns the volume of the communication graph exchanged between different nodes, summed over the ranks of comm
  *
- * @warning
- * After this function the parameter of the solver (size etc) cannot be changed anymore
+ * The nodes are identified with MPI_Comm_split_type. After a reordering, the role of the rank i in the graph is taken by the rank
+ * whose new rank is i: the volume is computed with the placement of the roles on the nodes.
  *
- * -------------------------------------------
- * We do the following operations
+ * @param comm the communicator in which the graph is given
+ * @param destsW the weights of the edges from me to the other ranks of comm
+ * @param new_rank the rank whose role I take (my rank in comm without reordering)
  */
-void Solver::setup(const bool changeTopoComm) {
+static long long internode_volume(MPI_Comm comm, const int *destsW, const int new_rank) {
     BEGIN_FUNC;
-    m_profStarti(prof_, "setup");
+    //-------------------------------------------------------------------------
+    int comm_size, rank;
+    MPI_Comm_size(comm, &comm_size);
+    MPI_Comm_rank(comm, &rank);
+
+    // get the node of every role
+    int *node      = (int *)m_calloc(3 * comm_size * sizeof(int));
+    int *role      = node + comm_size;
+    int *role_node = node + 2 * comm_size;
+    gather_node_id(comm, node);
+    MPI_Allgather(&new_rank, 1, MPI_INT, role, 1, MPI_INT, comm);
+    for (int ir = 0; ir < comm_size; ++ir) {
+        role_node[role[ir]] = node[ir];
+    }
+
+    // my edges are the ones of the role = my rank in the graph
+    long long volume = 0;
+    for (int ir = 0; ir < comm_size; ++ir) {
+        volume += (role_node[ir] != role_node[rank]) ? destsW[ir] : 0;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &volume, 1, MPI_LONG_LONG, MPI_SUM, comm);
+    m_free(node);
+    //-------------------------------------------------------------------------
+    END_FUNC;
+    return volume;
+}
 
+/**
+ * @brief adds the communication graph of the field switchtopos, see @ref reorder_ranks_
+ *
+ * If we are not allowed to change the physical topology, do it only for the 2nd and 3rd switchtopo.
+ * These are the switches that we hope to optimize with the rank reordering. We do not account the 1st switchtopo because that
+ * one will be used to reach the optimized layout associated with the graph_comm, and it is thus very likely that the communication
+ * involved in the first switchtopo is a real all 2 all (with some ranks not having a self block) !
+ * If we can change the topology, do it for every swithTopo.
+ *
+ * @param changeTopoComm if the communicator of the physical topology can be changed
+ * @param sourcesW the weights associated to the edge between other processors communicating to me
+ * @param destsW the weights associated to the edge betwenn me communicating to other processors
+ */
+void Solver::add_toGraph_(const bool changeTopoComm, int *sourcesW, int *destsW) {
+    BEGIN_FUNC;
     //-------------------------------------------------------------------------
-    /** [IF REORDER_RANKS IS DEFINED] */
+    for (int i = (changeTopoComm ? 0 : 1); i < ndim_; i++) {
+        if (switchtopo_[i] != NULL) {
+            switchtopo_[i]->add_toGraph(sourcesW, destsW);
+        }
+    }
     //-------------------------------------------------------------------------
+    END_FUNC;
+}
 
-#ifdef REORDER_RANKS
+/**
+ * @brief reorders the ranks based on the communication graph of the switchtopos, using METIS if available, MPI_Dist_graph otherwise
+ *
+ * The topologies are given the new communicator, the switchtopos take it into account when they are setup.
+ * The inter-node volume of the graph is stored before and after the reordering (predicted), see @ref internode_vol_.
+ *
+ * @param changeTopoComm if the communicator of the physical topology can be changed
+ */
+void Solver::reorder_ranks_(const bool changeTopoComm) {
+    BEGIN_FUNC;
     //-------------------------------------------------------------------------
     /** - Precompute the communication graph */
     //-------------------------------------------------------------------------
@@ -247,24 +356,7 @@ void Solver::setup(const bool changeTopoComm) {
     }
 
     // Count the total number of edges for the switchtopos
-    //  if we are not allowed to change the physical topology,
-    //  do it only for the 2nd and 3rd switchtopo.
-    //  These are the switches that we hope to optimize with the rank
-    //  reordering. We do not account the 1st switchtopo because that
-    //  one will be used to reach the optimized layout associated with
-    //  the graph_comm, and it is thus very likely that the communication
-    //  involved in the first switchtopo is a real all 2 all (with some
-    //  ranks not having a self block) !
-    //  if we can change the topology, do it for every swithTopo
-    if (changeTopoComm) {
-        for (int i = 0; i < ndim_; i++) {
-            switchtopo_[i]->add_toGraph(sourcesW, destsW);
-        }
-    } else {
-        for (int i = 1; i < ndim_; i++) {
-            switchtopo_[i]->add_toGraph(sourcesW, destsW);
-        }
-    }
+    add_toGraph_(changeTopoComm, sourcesW, destsW);
 
     //-------------------------------------------------------------------------
     /** - Build the new comm based on that graph using metis if available, graph_topo if not */
@@ -356,6 +448,14 @@ void Solver::setup(const bool changeTopoComm) {
     m_free(order);
 #endif  // METIS
 
+    //-------------------------------------------------------------------------
+    /** - Predict the volume exchanged between the nodes with the new ranks */
+    //-------------------------------------------------------------------------
+    int newrank_graph;
+    MPI_Comm_rank(graph_comm, &newrank_graph);
+    internode_vol_[0] = internode_volume(topo_phys_->get_comm(), destsW, rank);
+    internode_vol_[1] = internode_volume(topo_phys_->get_comm(), destsW, newrank_graph);
+
     m_free(sources);
     m_free(sourcesW);
     m_free(dests);
@@ -369,6 +469,7 @@ void Solver::setup(const bool changeTopoComm) {
     // The first switch topo will serve to redistribute
     // data following the optimized topology on the cluster, with reordered
     // ranks
+    graph_comm_ = graph_comm;
     for (int i = 0; i < ndim_; i++) {
         topo_hat_[i]->change_comm(graph_comm);
         topo_green_[i]->change_comm(graph_comm);
@@ -381,7 +482,63 @@ void Solver::setup(const bool changeTopoComm) {
     topo_hat_[0]->disp_rank();
 #endif
 
-#endif  // REORDER_RANKS
+    END_FUNC;
+}
+
+/**
+ * @brief Sets up the Solver
+ *
+ * @param changeTopoComm determine if the user allows the solver to rewrite the communicator associated with the provided topo at the init (if the ranks are reordered, see @ref set_ReorderRanks)
+ *
+ * @warning
+ * To be able to change the communicator, the user MUST ensure that NOTHING has been done with the topology yet, except creating it.
+ * Otherwise he will get unpredictable datas
+ *
+ * @warning
+ * After this function the parameter of the solver (size etc) cannot be changed anymore
+ *
+ * -------------------------------------------
+ * We do the following operations
+ */
+void Solver::setup(const bool changeTopoComm) {
+    BEGIN_FUNC;
+    m_profStarti(prof_, "setup");
+
+    //-------------------------------------------------------------------------
+    /** - [IF ASKED] reorder the ranks based on the communication graph, see @ref reorder_ranks_ */
+    //-------------------------------------------------------------------------
+    // the environment variable is used if the reordering has not been set through the API
+    const char *env_reorder = std::getenv("FLUPS_REORDER");
+    if (!is_reorder_set_ && env_reorder != NULL) {
+        do_reorder_ = (std::atoi(env_reorder) != 0);
+    }
+    if (do_reorder_) {
+        reorder_ranks_(changeTopoComm);
+#if (FLUPS_MPI_AGGRESSIVE)
+        // if the physical topology keeps its ranks, the 1st switchtopo might not be local anymore
+        if (switchtopo_[0]->switch_type() == SWITCH_SELF && !SwitchTopoX_isLocal(topo_phys_, topo_hat_[0], switchtopo_[0]->shift())) {
+            SwitchTopoX *new_switchtopo = new_switchtopo_(0, SWITCH_DEFAULT, prof_);
+            delete switchtopo_[0];
+            switchtopo_[0] = new_switchtopo;
+        }
+#endif
+    }
+#if (FLUPS_MPI_AGGRESSIVE)
+    // report the global transposes that have been replaced by local ones
+    {
+        int comm_size, rank;
+        MPI_Comm_size(topo_phys_->get_comm(), &comm_size);
+        MPI_Comm_rank(topo_phys_->get_comm(), &rank);
+        int n_local[2] = {0, 0};
+        for (int ip = 0; ip < ndim_; ++ip) {
+            n_local[0] += (switchtopo_[ip]->switch_type() == SWITCH_SELF);
+            n_local[1] += (switchtopo_green_[ip] != NULL && switchtopo_green_[ip]->switch_type() == SWITCH_SELF);
+        }
+        if (comm_size > 1 && rank == 0 && (n_local[0] + n_local[1]) > 0) {
+            FLUPS_INFO_1("%d/%d field and %d/%d Green switchtopos do not communicate and are done as local transposes", n_local[0], ndim_, n_local[1], ndim_ - 1);
+        }
+    }
+#endif
 
     //-------------------------------------------------------------------------
     /** In every cases, we do */
@@ -395,6 +552,21 @@ void Solver::setup(const bool changeTopoComm) {
     allocate_data_(topo_green_, NULL, &green_);
     m_profStopi(prof_, "alloc_data");
 
+    //-------------------------------------------------------------------------
+    /** - start the progress thread if asked and supported */
+    //-------------------------------------------------------------------------
+#if (FLUPS_MPI_PROGRESS)
+    {
+        int provided;
+        MPI_Query_thread(&provided);
+        if (provided == MPI_THREAD_MULTIPLE) {
+            progress_ = new ProgressThread(topo_phys_->get_comm());
+        } else {
+            FLUPS_WARNING("the progress thread requires MPI_THREAD_MULTIPLE, it is disabled");
+        }
+    }
+#endif
+
     //-------------------------------------------------------------------------
     /** - allocate the plan and comnpute the Green's function */
     //-------------------------------------------------------------------------
@@ -422,8 +594,9 @@ void Solver::setup(const bool changeTopoComm) {
     //-------------------------------------------------------------------------
     // delete the switchTopos and the plans if we allocated them
     m_profStarti(prof_, "green deallocation");
-    deallocate_switchTopo_(switchtopo_green_, &sendBuf_, &recvBuf_);
+    // the switchtopos must be deleted before the buffers they might expose (e.g. MPI windows)
     delete_switchtopos_(switchtopo_green_);
+    deallocate_switchTopo_(switchtopo_green_, &sendBuf_, &recvBuf_);
     delete_topologies_(topo_green_);
     delete_plans_(plan_green_);
     m_profStopi(prof_, "green deallocation");
@@ -453,9 +626,40 @@ void Solver::setup(const bool changeTopoComm) {
     /** - Setup the SwitchTopo, this will take the latest comm into account */
     //-------------------------------------------------------------------------
     m_profStarti(prof_, "alloc_SwitchTopos field");
+#if (FLUPS_MPI_AGGRESSIVE)
+    select_SwitchType_();
+    // the environment variable has the priority on the compilation flag for the float transport of the field
+    const char *env_float       = std::getenv("FLUPS_FLOAT_TRANSPORT");
+    const bool  float_transport = (env_float != NULL) ? (std::atoi(env_float) != 0) : FLUPS_FLOAT_TRANSPORT;
+    for (int ip = 0; ip < ndim_; ++ip) {
+        if (switchtopo_[ip] != NULL) switchtopo_[ip]->set_floatTransport(float_transport);
+    }
+#endif
     allocate_switchTopo_(ndim_, switchtopo_, &sendBuf_, &recvBuf_);
     m_profStopi(prof_, "alloc_SwitchTopos field");
 
+#if (FLUPS_MPI_AGGRESSIVE) && (VERBOSE >= 1)
+    //-------------------------------------------------------------------------
+    /** - [IF REORDERED and VERBOSE] report the inter-node volume achieved by the switchtopos with the new ranks */
+    //-------------------------------------------------------------------------
+    if (graph_comm_ != MPI_COMM_NULL) {
+        int worldsize, rank;
+        MPI_Comm_size(graph_comm_, &worldsize);
+        MPI_Comm_rank(graph_comm_, &rank);
+        int *sourcesW = (int *)m_calloc(worldsize * sizeof(int));
+        int *destsW   = (int *)m_calloc(worldsize * sizeof(int));
+        memset(sourcesW, 0, sizeof(int) * worldsize);
+        memset(destsW, 0, sizeof(int) * worldsize);
+        add_toGraph_(changeTopoComm, sourcesW, destsW);
+        const long long achieved_vol = internode_volume(graph_comm_, destsW, rank);
+        if (rank == 0) {
+            FLUPS_INFO_1("rank reordering: inter-node volume = %lld before, %lld predicted, %lld achieved", internode_vol_[0], internode_vol_[1], achieved_vol);
+        }
+        m_free(sourcesW);
+        m_free(destsW);
+    }
+#endif
+
     m_profStopi(prof_, "Field ");
 
     m_profStopi(prof_, "setup");
@@ -482,16 +686,21 @@ Solver::~Solver() {
         delete_plans_(plan_backward_diff_);
     }
 
+    // the Green's function accessories are already deleted, unless the solver has never been setup
+    delete_switchtopos_(switchtopo_green_);
+    delete_topologies_(topo_green_);
+    delete_plans_(plan_green_);
+
+    // deallocate the swithTopo, before the buffers they might expose (e.g. MPI windows)
+    delete_switchtopos_(switchtopo_);
     // free the sendBuf,recvBuf
     deallocate_switchTopo_(switchtopo_, &sendBuf_, &recvBuf_);
-    // deallocate the swithTopo
-    delete_switchtopos_(switchtopo_);
+
+    // stop the progress thread
+    if (progress_ != NULL) delete progress_;
 
     // cleanup the communicator if any
-#ifdef REORDER_RANKS
-    MPI_Comm mycomm = topo_hat_[ndim_ - 1]->get_comm();
-    MPI_Comm_free(&mycomm);
-#endif
+    if (graph_comm_ != MPI_COMM_NULL) MPI_Comm_free(&graph_comm_);
     delete_topologies_(topo_hat_);
 
     if (data_ != NULL) m_free(data_);
@@ -499,10 +708,10 @@ Solver::~Solver() {
     // cleanup
     //#ifdef FLUPS_WISDOM_PATH
     //    FLUPS_WARNING("exporting wisdom to %s",FLUPS_WISDOM_PATH);
-    //    fftw_export_wisdom_to_filename(FLUPS_WISDOM_PATH);
+    //    FLUPS_FFTW(export_wisdom_to_filename)(FLUPS_WISDOM_PATH);
     //#endif
-    fftw_cleanup_threads();
-    fftw_cleanup();
+    FLUPS_FFTW(cleanup_threads)();
+    FLUPS_FFTW(cleanup)();
     // m_profStopi(prof_, "Clean up");
     //-------------------------------------------------------------------------
     END_FUNC;
@@ -573,6 +782,360 @@ void Solver::delete_topologies_(Topology *topo[3]) {
     END_FUNC;
 }
 
+/**
+ * @brief returns the number of ranks doing the 2nd switchtopo together so that this switchtopo stays on the node
+ *
+ * The pencils are distributed following the dimension order of the plans: in the topologies before and after the 2nd switchtopo,
+ * the ranks sharing the same rank in the 3rd direction are consecutive and exchange their data only among themselves.
+ * We look for the largest group of consecutive ranks which divides the communicator and fits in a node, the 2nd switchtopo can
+ * then use the shared-memory transport while the 3rd one is done among the groups.
+ *
+ * @param topo the physical topology
+ * @return int the number of ranks in a group, 0 if the decomposition cannot be node-aware
+ */
+int Solver::node_pencil_group_(const Topology *topo) const {
+    BEGIN_FUNC;
+    //-------------------------------------------------------------------------
+    MPI_Comm comm = topo->get_comm();
+    int      comm_size, mpi_topo_type;
+    MPI_Comm_size(comm, &comm_size);
+    MPI_Topo_test(comm, &mpi_topo_type);
+    if (mpi_topo_type == MPI_CART) {
+        FLUPS_WARNING("the node-aware decomposition is not available with a MPI_CART communicator");
+        return 0;
+    }
+    const int dimOrder[3] = {plan_forward_[0]->dimID(), plan_forward_[1]->dimID(), plan_forward_[2]->dimID()};
+
+    int *node = (int *)m_calloc(comm_size * sizeof(int));
+    gather_node_id(comm, node);
+    bool is_single_node = true;
+    for (int ir = 0; ir < comm_size; ++ir) {
+        is_single_node = is_single_node && (node[ir] == node[0]);
+    }
+
+    // the group is split along the 1st and 2nd directions and the groups along the 3rd one: no pencil can be empty
+    auto is_valid = [=](const int ig) {
+        if (ig < 2 || comm_size % ig != 0) return false;
+        if (ig > topo->nglob(dimOrder[0]) || ig > topo->nglob(dimOrder[1]) || comm_size / ig > topo->nglob(dimOrder[2])) return false;
+        bool is_on_node = true;
+        for (int ir = 0; ir < comm_size && is_on_node; ++ir) {
+            is_on_node = (node[ir] == node[(ir / ig) * ig]);
+        }
+        return is_on_node;
+    };
+    // the default group is kept if it fits, which leaves the 1st switchtopo unchanged
+    const int default_group = comm_size / topo->nproc(dimOrder[2]);
+    int       group         = (!is_single_node && is_valid(default_group)) ? default_group : 0;
+    for (int ig = comm_size / 2; ig > 1 && !is_single_node && group == 0; --ig) {
+        group = (is_valid(ig)) ? ig : 0;
+    }
+    m_free(node);
+
+    if (is_single_node) {
+        FLUPS_INFO("node-aware decomposition: every rank is on the same node, the default decomposition is used");
+    } else if (group == 0) {
+        FLUPS_WARNING("node-aware decomposition: no group of consecutive ranks fits in a node, the default decomposition is used");
+    } else {
+        FLUPS_INFO("node-aware decomposition: the 2nd switchtopo is done among %d ranks on the same node", group);
+    }
+    //-------------------------------------------------------------------------
+    END_FUNC;
+    return group;
+}
+
+/**
+ * @brief chooses the subset of ranks, the node-aware and the slab decompositions for the current order of the plans, see @ref subset_size_,
+ * @ref node_pencil_group_ and @ref use_slab_
+ *
+ * @param topo the physical topology
+ */
+void Solver::select_decomposition_(const Topology *topo) {
+    BEGIN_FUNC;
+    //-------------------------------------------------------------------------
+    int comm_size;
+    MPI_Comm_size(topo->get_comm(), &comm_size);
+    node_group_   = 0;
+    is_slab_      = false;
+    n_active_     = comm_size;
+    active_group_ = 0;
+#if (FLUPS_MPI_AGGRESSIVE)
+    // the transforms are done on a subset of the ranks if forced by the environment variable (auto or number of ranks) or if chosen by the cost model
+    const char *env_subset  = std::getenv("FLUPS_SUBSET");
+    const bool  subset_auto = (env_subset != NULL) ? (strcmp(env_subset, "auto") == 0) : FLUPS_SUBSET_AUTO;
+    const int   subset_mode = subset_auto ? -1 : ((env_subset != NULL) ? std::atoi(env_subset) : 0);
+    if (subset_mode != 0) {
+        n_active_ = subset_size_(topo, subset_mode, &active_group_);
+    }
+#endif
+    // the environment variable has the priority on the compilation flag for the node-aware decomposition
+    // the node-aware groups are made of all the ranks of the nodes, the decomposition is not used with a subset of the ranks
+    const char *env_node   = std::getenv("FLUPS_NODE_AWARE");
+    const bool  node_aware = (env_node != NULL) ? (std::atoi(env_node) != 0) : FLUPS_NODE_AWARE;
+    if (node_aware && ndim_ == 3 && n_active_ == comm_size) {
+        node_group_ = node_pencil_group_(topo);
+    }
+    // the slab decomposition is forced or forbidden by the environment variable, otherwise it is chosen by the cost model
+    const char *env_slab  = std::getenv("FLUPS_SLAB");
+    const int   slab_mode = (env_slab != NULL) ? (std::atoi(env_slab) != 0) : (FLUPS_SLAB_AUTO ? -1 : 0);
+    if (slab_mode != 0 && ndim_ == 3) {
+        is_slab_ = use_slab_(topo, slab_mode == 1);
+    }
+    //-------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief returns the order of the directions of the transforms leading to the fastest communications, for the field and for Green
+ *
+ * Only the directions having the same type can be swapped, the types must remain sorted (see sort_plans). For every order,
+ * the plans, the topologies and the switchtopos are created (without setup) and the switchtopos are modeled with @ref get_commCost.
+ * If asked, the field switchtopos are also set up and timed over FLUPS_MPI_AUTOTUNE_NITER forward and backward executions.
+ * The Green's function ends in the last topology of the field: its order is the fastest one ending with the same direction and
+ * doing the r2c transform in the same direction.
+ *
+ * @param topo the physical topology
+ * @param rhsbc the boundary conditions
+ * @param h the grid spacing
+ * @param L the domain size
+ * @param centertype the location of the data
+ * @param is_timed time the field switchtopos instead of using the model
+ * @param order the order of the directions for the field (order[0]) and for Green (order[1])
+ */
+void Solver::tune_order_(const Topology *topo, BoundaryType *rhsbc[3][2], const double h[3], const double L[3], const CenterType centertype[3], const bool is_timed, int order[2][3]) {
+    BEGIN_FUNC;
+    //-------------------------------------------------------------------------
+    const int        perm[6][3]     = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+    FFTW_plan_dim   *ref_forward[3] = {plan_forward_[0], plan_forward_[1], plan_forward_[2]};
+    FFTW_plan_dim   *ref_green[3]   = {plan_green_[0], plan_green_[1], plan_green_[2]};
+    H3LPR::Profiler *prof           = prof_;
+    // the trials are not profiled
+    prof_ = NULL;
+
+    int    n_cand = 0;
+    int    cand[6][3], r2c_dim[6];
+    double time_field[6], time_green[6];
+    for (int ic = 0; ic < 6; ++ic) {
+        bool is_valid = true;
+        for (int ip = 0; ip < 3; ++ip) {
+            is_valid = is_valid && (ref_forward[perm[ic][ip]]->type() == ref_forward[ip]->type());
+        }
+        if (!is_valid) continue;
+
+        // create the plans, the topologies and the switchtopos in that order
+        for (int ip = 0; ip < 3; ++ip) {
+            const int dimID    = ref_forward[perm[ic][ip]]->dimID();
+            cand[n_cand][ip]   = dimID;
+            plan_forward_[ip]  = new_plan(centertype[dimID], lda_, dimID, h, L, rhsbc[dimID], FLUPS_FORWARD, false);
+            plan_green_[ip]    = new_plan(centertype[dimID], 1, dimID, h, L, rhsbc[dimID], FLUPS_FORWARD, true);
+        }
+        select_decomposition_(topo);
+        init_plansAndTopos_(topo, topo_hat_, switchtopo_, plan_forward_, false);
+        init_plansAndTopos_(topo, topo_green_, switchtopo_green_, plan_green_, true);
+
+        double    time[3];
+        long long volume[3];
+        int       nmsg[3];
+        get_commCost(time, volume, nmsg);
+        time_field[n_cand] = time[0] + time[1] + time[2];
+        r2c_dim[n_cand]    = -1;
+        for (int ip = ndim_ - 1; ip >= 0; --ip) {
+            if (plan_forward_[ip]->isr2c()) r2c_dim[n_cand] = plan_forward_[ip]->dimID();
+        }
+        get_commCost(time, volume, nmsg, true);
+        time_green[n_cand] = time[0] + time[1] + time[2];
+        if (is_timed) {
+            time_field[n_cand] = time_switchtopos_();
+        }
+        FLUPS_INFO("transform order %d %d %d: %e s for the field, %e s for Green", cand[n_cand][0], cand[n_cand][1], cand[n_cand][2], time_field[n_cand], time_green[n_cand]);
+
+        delete_switchtopos_(switchtopo_);
+        delete_switchtopos_(switchtopo_green_);
+        delete_topologies_(topo_hat_);
+        delete_topologies_(topo_green_);
+        delete_plans_(plan_forward_);
+        delete_plans_(plan_green_);
+        ++n_cand;
+    }
+    for (int ip = 0; ip < 3; ++ip) {
+        plan_forward_[ip] = ref_forward[ip];
+        plan_green_[ip]   = ref_green[ip];
+    }
+    prof_ = prof;
+
+    // the times are the same on every rank, the first candidate is the default order
+    int best = 0;
+    for (int ic = 1; ic < n_cand; ++ic) {
+        best = (time_field[ic] < time_field[best]) ? ic : best;
+    }
+    int best_green = best;
+    for (int ic = 0; ic < n_cand; ++ic) {
+        const bool is_compatible = (cand[ic][ndim_ - 1] == cand[best][ndim_ - 1]) && (r2c_dim[ic] == r2c_dim[best]);
+        if (is_compatible && time_green[ic] < time_green[best_green]) best_green = ic;
+    }
+    for (int ip = 0; ip < 3; ++ip) {
+        order[0][ip] = cand[best][ip];
+        order[1][ip] = cand[best_green][ip];
+    }
+
+    int rank;
+    MPI_Comm_rank(topo->get_comm(), &rank);
+    if (rank == 0) {
+        FLUPS_INFO_1("transform order: %d %d %d for the field (%s communication time = %e s), %d %d %d for Green (modeled communication time = %e s)",
+               order[0][0], order[0][1], order[0][2], is_timed ? "timed" : "modeled", time_field[best], order[1][0], order[1][1], order[1][2], time_green[best_green]);
+    }
+    //-------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief sets up the field switchtopos and returns the time of a forward and backward execution of all of them (max among the ranks)
+ *
+ * The data, the buffers and the switchtopos are freed afterwards.
+ */
+double Solver::time_switchtopos_() {
+    BEGIN_FUNC;
+    //-------------------------------------------------------------------------
+    MPI_Comm comm = topo_phys_->get_comm();
+    allocate_data_(topo_hat_, topo_phys_, &data_);
+    allocate_switchTopo_(ndim_, switchtopo_, &sendBuf_, &recvBuf_);
+
+    // the topos follow the state they have in do_FFT
+    double time = 0.0;
+    for (int it = 0; it <= FLUPS_MPI_AUTOTUNE_NITER; ++it) {
+        MPI_Barrier(comm);
+        const double t0 = MPI_Wtime();
+        for (int ip = 0; ip < ndim_; ++ip) {
+            switchtopo_[ip]->execute(data_, FLUPS_FORWARD);
+            if (plan_forward_[ip]->isr2c()) topo_hat_[ip]->switch2complex();
+        }
+        for (int ip = ndim_ - 1; ip >= 0; --ip) {
+            if (plan_forward_[ip]->isr2c()) topo_hat_[ip]->switch2real();
+            switchtopo_[ip]->execute(data_, FLUPS_BACKWARD);
+        }
+        if (it > 0) time += MPI_Wtime() - t0;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &time, 1, MPI_DOUBLE, MPI_MAX, comm);
+
+    // the switchtopos must be deleted before the buffers they might expose (e.g. MPI windows)
+    delete_switchtopos_(switchtopo_);
+    deallocate_switchTopo_(switchtopo_, &sendBuf_, &recvBuf_);
+    m_free(data_);
+    data_ = NULL;
+    //-------------------------------------------------------------------------
+    END_FUNC;
+    return time / FLUPS_MPI_AUTOTUNE_NITER;
+}
+
+/**
+ * @brief returns the number of ranks doing the transforms, the first ones of the communicator, and their pencil decomposition
+ *
+ * The other ranks are idle in the topologies of the solver (see Topology::is_idle): they only send their data in the 1st switchtopo
+ * and get it back in the last one. With p active ranks out of P, the data of the pencils is split in a q x p/q grid and a solve is modeled as
+ *    2 latency * (ceil(P/p) + p/q - 1 + q - 1) + 2 ndim V / (p bandwidth) + 5 N log2(N) / (p flop_rate)
+ * with V the size of the field and N its number of unknowns: the number of messages grows with p while the volume and the FFTs shrink.
+ * The number of ranks is taken among P, P/2, P/4, etc.
+ *
+ * @param topo the physical topology
+ * @param mode the number of ranks to use, or the number of ranks is chosen by the cost model if < 0
+ * @param group the number of ranks q along the 3rd direction of the first topology
+ * @return int the number of active ranks
+ */
+int Solver::subset_size_(const Topology *topo, const int mode, int *group) const {
+    BEGIN_FUNC;
+    //-------------------------------------------------------------------------
+    int comm_size, mpi_topo_type;
+    MPI_Comm_size(topo->get_comm(), &comm_size);
+    MPI_Topo_test(topo->get_comm(), &mpi_topo_type);
+    const int dimOrder[3] = {plan_forward_[0]->dimID(), plan_forward_[1]->dimID(), plan_forward_[2]->dimID()};
+    if (mpi_topo_type == MPI_CART) {
+        FLUPS_WARNING("the subset of ranks is not available with a MPI_CART communicator");
+        *group = 0;
+        return comm_size;
+    }
+
+    // q divides p, no pencil can be empty (the 1st direction might be halved by the r2c transform), q is the closest to sqrt(p)
+    const int n0 = topo->nglob(dimOrder[0]) / 2;
+    const int n1 = topo->nglob(dimOrder[1]);
+    const int n2 = topo->nglob(dimOrder[2]);
+    auto pencil_group = [=](const int p) {
+        int q = 0;
+        for (int iq = 1; iq <= p; ++iq) {
+            const bool is_valid = (p % iq == 0) && iq <= n2 && (ndim_ == 2 || iq <= n1) && p / iq <= n1 && p / iq <= n0;
+            if (is_valid && (q == 0 || std::fabs(iq - std::sqrt(p)) < std::fabs(q - std::sqrt(p)))) q = iq;
+        }
+        return q;
+    };
+
+    int n_active = comm_size;
+    if (mode > 0) {
+        n_active = m_min(mode, comm_size);
+        if (pencil_group(n_active) == 0) {
+            FLUPS_WARNING("no pencil decomposition fits %d ranks, all the ranks are used", n_active);
+            n_active = comm_size;
+        }
+    } else {
+        const double n_unknown = (double)topo->nglob(0) * topo->nglob(1) * topo->nglob(2);
+        const double vol       = (double)lda_ * sizeof(flups_real) * n_unknown;
+        double       best_time = -1.0;
+        for (int p = comm_size; p >= 1; p /= 2) {
+            const int q = pencil_group(p);
+            if (q == 0) continue;
+            const int    n_msg = (comm_size + p - 1) / p + p / q - 1 + q - 1;
+            const double time  = 2.0 * cost_latency * n_msg + 2.0 * ndim_ * vol / (p * cost_bw_internode) + 5.0 * n_unknown * std::log2(n_unknown) / (p * cost_flop_rate);
+            FLUPS_INFO("subset of %d ranks (%d x %d): modeled time = %e s", p, q, p / q, time);
+            if (best_time < 0.0 || time < best_time) {
+                best_time = time;
+                n_active  = p;
+            }
+        }
+    }
+    // all the ranks keep the default decomposition
+    *group = (n_active < comm_size) ? pencil_group(n_active) : 0;
+    //-------------------------------------------------------------------------
+    END_FUNC;
+    return n_active;
+}
+
+/**
+ * @brief returns true if the slab decomposition can be used and, unless forced, if it is faster than the pencils
+ *
+ * With the slabs, every rank owns full planes of the two first directions of the plans: the 2nd switchtopo only transposes
+ * the data of every rank (see SwitchTopoX_self) and a single global transpose remains. The pencils need two global transposes,
+ * among q and P/q ranks, but less messages. Assuming that the field is exchanged between the nodes, the slabs are chosen if
+ *    latency * (P - 1) + V / bandwidth < latency * (q - 1 + P/q - 1) + 2 V / bandwidth
+ * with V the size of the field on a rank and q the number of ranks doing the 2nd switchtopo with the pencils.
+ * P is the number of ranks doing the transforms (see @ref subset_size_).
+ *
+ * @param topo the physical topology
+ * @param is_forced use the slabs as soon as they are possible
+ */
+bool Solver::use_slab_(const Topology *topo, const bool is_forced) const {
+    BEGIN_FUNC;
+    //-------------------------------------------------------------------------
+    int mpi_topo_type;
+    MPI_Topo_test(topo->get_comm(), &mpi_topo_type);
+    const int comm_size   = n_active_;
+    const int dimOrder[3] = {plan_forward_[0]->dimID(), plan_forward_[1]->dimID(), plan_forward_[2]->dimID()};
+
+    // every rank must own at least one plane in the 3rd direction and one line of the 2nd one in the last topology
+    if (comm_size == 1 || mpi_topo_type == MPI_CART || comm_size > topo->nglob(dimOrder[2]) || comm_size > topo->nglob(dimOrder[1])) {
+        FLUPS_INFO("slab decomposition not possible with %d ranks", comm_size);
+        return false;
+    }
+    if (is_forced) {
+        return true;
+    }
+
+    const int    group       = (node_group_ > 0) ? node_group_ : (comm_size / ((active_group_ > 0) ? active_group_ : topo->nproc(dimOrder[2])));
+    const double vol         = (double)lda_ * sizeof(flups_real) * topo->nglob(0) * topo->nglob(1) * topo->nglob(2) / comm_size;
+    const double time_slab   = cost_latency * (comm_size - 1) + vol / cost_bw_internode;
+    const double time_pencil = cost_latency * (group - 1 + comm_size / group - 1) + 2.0 * vol / cost_bw_internode;
+    FLUPS_INFO("slab decomposition: modeled time = %e s vs %e s for the pencils", time_slab, time_pencil);
+    //-------------------------------------------------------------------------
+    END_FUNC;
+    return time_slab < time_pencil;
+}
+
 /**
  * @brief Initializes a set of 3 plans by doing a dry run through the plans
  *
@@ -591,8 +1154,8 @@ void Solver::init_plansAndTopos_(const Topology *topo, Topology *topomap[3], Swi
 
     // @Todo: check that plan_forward_ exists before doing plan_green_ !
 
-    int comm_size;
-    MPI_Comm_size(topo->get_comm(), &comm_size);
+    // only the n_active_ first ranks of the communicator own data in the topologies of the solver
+    const int comm_size = n_active_;
 
     //-------------------------------------------------------------------------
     /** - Store the current topology */
@@ -638,36 +1201,42 @@ void Solver::init_plansAndTopos_(const Topology *topo, Topology *topomap[3], Swi
             // determines the proc repartition using the previous one if available
             if (ip == 0) {
                 // for the first switchTopo, we keep the number of proc constant in the 3rd direction
-                const int nproc_hint[3] = {topo->nproc(0), topo->nproc(1), topo->nproc(2)};
-                pencil_nproc_hint(dimID, nproc, comm_size, dimOrder[1], nproc_hint);
+                int nproc_hint[3] = {topo->nproc(0), topo->nproc(1), topo->nproc(2)};
+                // unless the decomposition is node-aware: the 2nd switchtopo is then done among the node_group_ consecutive ranks
+                // sharing the same rank in the 3rd direction, which are on the same node
+                // or unless we use slabs: every rank then owns full planes of the 3rd direction and the 2nd switchtopo is local
+                // or unless the transforms are done on a subset of the ranks, see @ref subset_size_
+                if (is_slab_) {
+                    nproc_hint[dimOrder[2]] = comm_size;
+                } else if (node_group_ > 0) {
+                    nproc_hint[dimOrder[2]] = comm_size / node_group_;
+                } else if (active_group_ > 0) {
+                    nproc_hint[dimOrder[2]] = active_group_;
+                }
+                pencil_nproc_hint(dimID, nproc, comm_size, dimOrder[1], nproc_hint, is_slab_);
             } else {
                 const int nproc_hint[3] = {current_topo->nproc(0), current_topo->nproc(1), current_topo->nproc(2)};
                 // for the other switchtopos, we keep constant the id that is not mine, neither the old topo id
-                pencil_nproc_hint(dimID, nproc, comm_size, planmap[ip - 1]->dimID(), nproc_hint);
+                pencil_nproc_hint(dimID, nproc, comm_size, planmap[ip - 1]->dimID(), nproc_hint, is_slab_);
             }
             // create the new topology corresponding to planmap[ip] in the output layout (size and isComplex)
             // the rank distribution is computed using the dimOrder array, where every topology
             // const int proc_axis[3] = {dimOrder[ip], dimOrder[(ip + 1) % 3], dimOrder[(ip + 2) % 3]};
-            topomap[ip] = new Topology(dimID, lda_, size_tmp, nproc, isComplex, dimOrder, fftwalignment_, topo_phys_->get_comm());
+            topomap[ip] = new Topology(dimID, lda_, size_tmp, nproc, isComplex, dimOrder, fftwalignment_, topo_phys_->get_comm(), true);
             // determines fieldstart = the point where the old topo has to begin in the new one
             // There are cases (typically for MIXUNB) where the data after being switched starts with an offset in memory in the new topo.
             int fieldstart[3] = {0};
             planmap[ip]->get_fieldstart(fieldstart);
+#if (FLUPS_MPI_AGGRESSIVE)
+            // if no data moves between the ranks (e.g. with the slabs), the switchtopo reduces to a local transpose
+            const SwitchType local_type = SwitchTopoX_isLocal(current_topo, topomap[ip], fieldstart) ? SWITCH_SELF : SWITCH_DEFAULT;
+#endif
             // compute the Switch between the current topo (the one from which we come) and the new one (the one we just created).
             // if the topo was real before the plan and is now complex
             if (planmap[ip]->isr2c()) {
                 topomap[ip]->switch2real();
 #if (FLUPS_MPI_AGGRESSIVE)
-
-#if defined(COMM_NONBLOCK)
-                switchtopo[ip] = new SwitchTopoX_nb(current_topo, topomap[ip], fieldstart, prof_);
-#elif defined(COMM_ISR)
-                switchtopo[ip]     = new SwitchTopoX_isr(current_topo, topomap[ip], fieldstart, prof_);
-#else
-
-                switchtopo[ip]     = new SwitchTopoX_a2a(current_topo, topomap[ip], fieldstart, prof_);
-#endif
-
+                switchtopo[ip] = SwitchTopoX_new(local_type, current_topo, topomap[ip], fieldstart, prof_);
 #else  // deprecated - still there for comparison purpose
 
 #if defined(COMM_NONBLOCK)
@@ -682,15 +1251,7 @@ void Solver::init_plansAndTopos_(const Topology *topo, Topology *topomap[3], Swi
             } else {
                 // create the switchtopoMPI to change topology
 #if (FLUPS_MPI_AGGRESSIVE)
-
-#if defined(COMM_NONBLOCK)
-                switchtopo[ip] = new SwitchTopoX_nb(current_topo, topomap[ip], fieldstart, prof_);
-#elif defined(COMM_ISR)
-                switchtopo[ip]     = new SwitchTopoX_isr(current_topo, topomap[ip], fieldstart, prof_);
-#else
-                switchtopo[ip]     = new SwitchTopoX_a2a(current_topo, topomap[ip], fieldstart, prof_);
-#endif
-
+                switchtopo[ip] = SwitchTopoX_new(local_type, current_topo, topomap[ip], fieldstart, prof_);
 #else  // deprecated - still there for comparison purpose
 
 #if defined(COMM_NONBLOCK)
@@ -738,11 +1299,11 @@ void Solver::init_plansAndTopos_(const Topology *topo, Topology *topomap[3], Swi
                 }
             } else {
                 const int nproc_hint[3] = {current_topo->nproc(0), current_topo->nproc(1), current_topo->nproc(2)};
-                pencil_nproc_hint(dimID, nproc, comm_size, planmap[ip + 1]->dimID(), nproc_hint);
+                pencil_nproc_hint(dimID, nproc, comm_size, planmap[ip + 1]->dimID(), nproc_hint, is_slab_);
             }
 
             // create the new topology in the output layout (size and isComplex). lda of Green is always 1.
-            topomap[ip] = new Topology(dimID, 1, size_tmp, nproc, isComplex, dimOrder, fftwalignment_, topo_phys_->get_comm());
+            topomap[ip] = new Topology(dimID, 1, size_tmp, nproc, isComplex, dimOrder, fftwalignment_, topo_phys_->get_comm(), true);
             // switchmap only to be done for topo0->topo1 and topo1->topo2
             if (ip < ndim_ - 1) {
                 // get the fieldstart = the point where the old topo has to begin in the new
@@ -751,15 +1312,8 @@ void Solver::init_plansAndTopos_(const Topology *topo, Topology *topomap[3], Swi
                 planmap[ip + 1]->get_fieldstart(fieldstart);
                 // we do the link between topomap[ip] and the current_topo
 #if (FLUPS_MPI_AGGRESSIVE)
-
-#if defined(COMM_NONBLOCK)
-                switchtopo[ip + 1] = new SwitchTopoX_nb(topomap[ip], current_topo, fieldstart, NULL);
-#elif defined(COMM_ISR)
-                switchtopo[ip + 1] = new SwitchTopoX_isr(topomap[ip], current_topo, fieldstart, NULL);
-#else
-                switchtopo[ip + 1] = new SwitchTopoX_a2a(topomap[ip], current_topo, fieldstart, NULL);
-#endif
-
+                const SwitchType local_type = SwitchTopoX_isLocal(topomap[ip], current_topo, fieldstart) ? SWITCH_SELF : SWITCH_DEFAULT;
+                switchtopo[ip + 1]          = SwitchTopoX_new(local_type, topomap[ip], current_topo, fieldstart, NULL);
 #else
 
 #if defined(COMM_NONBLOCK)
@@ -818,7 +1372,7 @@ void Solver::init_plansAndTopos_(const Topology *topo, Topology *topomap[3], Swi
 #if (FLUPS_MPI_AGGRESSIVE)
 void Solver::allocate_switchTopo_(const int ntopo, SwitchTopoX **switchtopo, m_ptr_t *send_buff, m_ptr_t *recv_buff) {
 #else
-void Solver::allocate_switchTopo_(const int ntopo, SwitchTopo **switchtopo, opt_double_ptr *send_buff, opt_double_ptr *recv_buff) {
+void Solver::allocate_switchTopo_(const int ntopo, SwitchTopo **switchtopo, opt_real_ptr *send_buff, opt_real_ptr *recv_buff) {
 #endif
     BEGIN_FUNC;
     //-------------------------------------------------------------------------
@@ -827,7 +1381,11 @@ void Solver::allocate_switchTopo_(const int ntopo, SwitchTopo **switchtopo, opt_
     // setup the communication. During this step, the size of the buffers required by each switchtopo might change.
     for (int id = 0; id < ntopo; id++) {
         if (switchtopo[id] != NULL) {
+#if (FLUPS_MPI_AGGRESSIVE)
+            switchtopo[id]->setup(&subcomm_cache_);
+#else
             switchtopo[id]->setup();
+#endif
             FLUPS_INFO("--------------- switchtopo %d set up ----------", id);
         }
     }
@@ -853,28 +1411,30 @@ void Solver::allocate_switchTopo_(const int ntopo, SwitchTopo **switchtopo, opt_
 #endif
         }
     }
-    FLUPS_CHECK(max_mem > 0, "number of memory %zu should be >0", max_mem);
+    // the idle ranks (see @ref subset_size_) might have nothing to exchange
+    FLUPS_CHECK(max_mem > 0 || topo_hat_[0]->is_idle(), "number of memory %zu should be >0", max_mem);
 #if (FLUPS_MPI_AGGRESSIVE)
     if (need_send) {
-        send_buff->calloc(max_mem * sizeof(double));
+        send_buff->calloc(max_mem * sizeof(flups_real));
     }
     if (need_recv) {
-        recv_buff->calloc(max_mem * sizeof(double));
+        recv_buff->calloc(max_mem * sizeof(flups_real));
     }
 #else
-    *send_buff = need_send ? ((opt_double_ptr)m_calloc(max_mem * sizeof(double))) : nullptr;
-    *recv_buff = need_recv ? ((opt_double_ptr)m_calloc(max_mem * sizeof(double))) : nullptr;
+    *send_buff = need_send ? ((opt_real_ptr)m_calloc(max_mem * sizeof(flups_real))) : nullptr;
+    *recv_buff = need_recv ? ((opt_real_ptr)m_calloc(max_mem * sizeof(flups_real))) : nullptr;
 #endif
 
-    // std::memset(*send_buff, 0, max_mem * sizeof(double));
-    // std::memset(*recv_buff, 0, max_mem * sizeof(double));
+    // std::memset(*send_buff, 0, max_mem * sizeof(flups_real));
+    // std::memset(*recv_buff, 0, max_mem * sizeof(flups_real));
 
     // associate the buffers to the switchtopo
     for (int id = 0; id < ntopo; id++) {
         if (switchtopo[id] != NULL) {
 #if (FLUPS_MPI_AGGRESSIVE)
-            switchtopo[id]->setup_buffers(need_send ? (*send_buff)() : nullptr,
-                                          need_recv ? (*recv_buff)() : nullptr);
+            // the backends might differ from one switchtopo to another, only give the buffers they need
+            switchtopo[id]->setup_buffers(switchtopo[id]->need_send_buf() ? (*send_buff)() : nullptr,
+                                          switchtopo[id]->need_recv_buf() ? (*recv_buff)() : nullptr);
 #else
             switchtopo[id]->setup_buffers(*send_buff, *recv_buff);
 #endif
@@ -887,7 +1447,7 @@ void Solver::allocate_switchTopo_(const int ntopo, SwitchTopo **switchtopo, opt_
 #if (FLUPS_MPI_AGGRESSIVE)
 void Solver::deallocate_switchTopo_(SwitchTopoX **switchtopo, m_ptr_t *send_buff, m_ptr_t *recv_buff) {
 #else
-void Solver::deallocate_switchTopo_(SwitchTopo **switchtopo, opt_double_ptr *send_buff, opt_double_ptr *recv_buff) {
+void Solver::deallocate_switchTopo_(SwitchTopo **switchtopo, opt_real_ptr *send_buff, opt_real_ptr *recv_buff) {
 #endif
 #if (FLUPS_MPI_AGGRESSIVE)
     send_buff->free();
@@ -904,6 +1464,312 @@ void Solver::deallocate_switchTopo_(SwitchTopo **switchtopo, opt_double_ptr *sen
 #endif
 }
 
+/**
+ * @brief sets the communication backend of a switchtopo
+ *
+ * @param istp the id of the switchtopo, -1 for all of them
+ * @param type the communication backend
+ */
+void Solver::set_SwitchType(const int istp, const SwitchType type) {
+    BEGIN_FUNC;
+    FLUPS_CHECK(-1 <= istp && istp < 3, "the switchtopo id = %d must be -1, 0, 1 or 2", istp);
+    //-------------------------------------------------------------------------
+#if (FLUPS_MPI_AGGRESSIVE)
+    for (int ip = 0; ip < 3; ++ip) {
+        if (istp == -1 || istp == ip) switch_type_[ip] = type;
+    }
+#else
+    FLUPS_WARNING("the communication backend cannot be changed with the deprecated implementation");
+#endif
+    //-------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief sets the reordering of the ranks based on the communication graph, see @ref reorder_ranks_
+ *
+ * @param reorder true to reorder the ranks at the setup
+ */
+void Solver::set_ReorderRanks(const bool reorder) {
+    BEGIN_FUNC;
+    //-------------------------------------------------------------------------
+    do_reorder_     = reorder;
+    is_reorder_set_ = true;
+    //-------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief returns the modeled cost of the field switchtopos, from the chunks they exchange
+ *
+ * The chunks are computed as in the setup of the switchtopos (see @ref SwitchTopoX::add_toGraph), which can thus be done before it.
+ * The time of a switchtopo is the one of the slowest rank, given by the number of messages it sends and by its volume sent
+ * inside and outside of its node. The self communication is not accounted.
+ *
+ * @param time the modeled time of each switchtopo (for one transform)
+ * @param volume the volume sent by all the ranks for each switchtopo (in bytes)
+ * @param nmsg the maximum number of messages sent by a rank for each switchtopo
+ * @param isGreen model the switchtopos of the Green's function instead, which only exist before the setup
+ */
+void Solver::get_commCost(double time[3], long long volume[3], int nmsg[3], const bool isGreen) const {
+    BEGIN_FUNC;
+    //-------------------------------------------------------------------------
+    MPI_Comm comm = topo_phys_->get_comm();
+    int      comm_size, rank;
+    MPI_Comm_size(comm, &comm_size);
+    MPI_Comm_rank(comm, &rank);
+    int *node     = (int *)m_calloc(comm_size * sizeof(int));
+    int *sourcesW = (int *)m_calloc(comm_size * sizeof(int));
+    int *destsW   = (int *)m_calloc(comm_size * sizeof(int));
+    gather_node_id(comm, node);
+
+#if (FLUPS_MPI_AGGRESSIVE)
+    SwitchTopoX *const *switchtopo = isGreen ? switchtopo_green_ : switchtopo_;
+#else
+    SwitchTopo *const *switchtopo = isGreen ? switchtopo_green_ : switchtopo_;
+#endif
+    // the data is complex after the first r2c transform, Green is complex if its output topology is (see init_plansAndTopos_)
+    bool isComplex = false;
+    for (int ip = 0; ip < 3; ++ip) {
+        time[ip]   = 0.0;
+        volume[ip] = 0;
+        nmsg[ip]   = 0;
+        if (ip < ndim_ && switchtopo[ip] != NULL) {
+            std::memset(sourcesW, 0, sizeof(int) * comm_size);
+            std::memset(destsW, 0, sizeof(int) * comm_size);
+            switchtopo[ip]->add_toGraph(sourcesW, destsW);
+
+            const int       lda       = isGreen ? 1 : lda_;
+            const bool      is_cplx   = isGreen ? topo_green_[ip]->isComplex() : isComplex;
+            const long long elem_size = lda * (is_cplx ? 2 : 1) * sizeof(flups_real);
+            long long       vol_node[2] = {0, 0};  // volume inside and outside of my node
+            for (int ir = 0; ir < comm_size; ++ir) {
+                if (ir == rank || destsW[ir] == 0) continue;
+                vol_node[node[ir] != node[rank]] += destsW[ir] * elem_size;
+                nmsg[ip]++;
+            }
+            time[ip]   = cost_latency * nmsg[ip] + vol_node[0] / cost_bw_intranode + vol_node[1] / cost_bw_internode;
+            volume[ip] = vol_node[0] + vol_node[1];
+        }
+        isComplex = isComplex || (ip < ndim_ && plan_forward_[ip]->isr2c());
+    }
+    MPI_Allreduce(MPI_IN_PLACE, time, 3, MPI_DOUBLE, MPI_MAX, comm);
+    MPI_Allreduce(MPI_IN_PLACE, volume, 3, MPI_LONG_LONG, MPI_SUM, comm);
+    MPI_Allreduce(MPI_IN_PLACE, nmsg, 3, MPI_INT, MPI_MAX, comm);
+    m_free(node);
+    m_free(sourcesW);
+    m_free(destsW);
+    //-------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief returns an estimate of the relative error due to the float transport during the last solve (0 if not used)
+ *
+ * The estimate is the sum over the switchtopos of the max relative error of their chunks (see SwitchTopoX::get_transportError),
+ * the max among the ranks is returned. This function is collective.
+ */
+double Solver::get_transportError() const {
+    BEGIN_FUNC;
+    //-------------------------------------------------------------------------
+    double error = 0.0;
+#if (FLUPS_MPI_AGGRESSIVE)
+    for (int ip = 0; ip < ndim_; ++ip) {
+        if (switchtopo_[ip] != NULL) error += switchtopo_[ip]->get_transportError();
+    }
+#endif
+    MPI_Allreduce(MPI_IN_PLACE, &error, 1, MPI_DOUBLE, MPI_MAX, topo_phys_->get_comm());
+    //-------------------------------------------------------------------------
+    END_FUNC;
+    return error;
+}
+
+/**
+ * @brief returns the proc repartition of the physical topology leading to the lowest modeled communication time
+ *
+ * Every proc grid of the communicator which leaves no rank empty is evaluated: a solver is created on it (without setup) and
+ * its switchtopos are modeled with @ref Solver::get_commCost. The proc grids of the spectral topologies follow from the one
+ * of the physical topology (see @ref pencil_nproc_hint). In case of equal time, the grid requiring the less memory is kept.
+ *
+ * @warning the solvers are destroyed afterwards, which cleans up FFTW: this must be done before the creation of any other solver
+ *
+ * @param lda the number of components of the field
+ * @param nglob the global number of unknowns of the physical topology
+ * @param h the grid spacing
+ * @param L the domain size
+ * @param bc the boundary conditions
+ * @param center_type the location of the data
+ * @param comm the communicator
+ * @param nproc the proc repartition of the physical topology (output)
+ */
+void hint_proc_repartition(const int lda, const int nglob[3], const double h[3], const double L[3], BoundaryType *bc[3][2], const CenterType center_type[3], MPI_Comm comm, int nproc[3]) {
+    BEGIN_FUNC;
+    //-------------------------------------------------------------------------
+    int comm_size, rank;
+    MPI_Comm_size(comm, &comm_size);
+    MPI_Comm_rank(comm, &rank);
+
+    double    best_time   = -1.0;
+    long long best_memory = 0;
+    for (int np0 = 1; np0 <= m_min(comm_size, nglob[0]); ++np0) {
+        if (comm_size % np0 != 0) continue;
+        for (int np1 = 1; np1 <= m_min(comm_size / np0, nglob[1]); ++np1) {
+            if ((comm_size / np0) % np1 != 0) continue;
+            const int cnproc[3] = {np0, np1, comm_size / (np0 * np1)};
+            if (cnproc[2] > nglob[2]) continue;
+
+            Topology *topo   = new Topology(0, lda, nglob, cnproc, false, NULL, FLUPS_ALIGNMENT, comm);
+            Solver   *solver = new Solver(topo, bc, h, L, NOD, center_type, NULL);
+            double    time[3];
+            long long volume[3];
+            int       nmsg[3];
+            solver->get_commCost(time, volume, nmsg);
+            long long memory = solver->get_allocSize() * sizeof(flups_real);
+            MPI_Allreduce(MPI_IN_PLACE, &memory, 1, MPI_LONG_LONG, MPI_MAX, comm);
+            delete solver;
+            delete topo;
+
+            const double ttl_time = time[0] + time[1] + time[2];
+            FLUPS_INFO("proc grid %d x %d x %d: modeled time = %e s (%e %e %e), volume = %lld %lld %lld bytes, max messages = %d %d %d, memory = %lld bytes", cnproc[0], cnproc[1], cnproc[2],
+                       ttl_time, time[0], time[1], time[2], volume[0], volume[1], volume[2], nmsg[0], nmsg[1], nmsg[2], memory);
+            if (best_time < 0.0 || ttl_time < best_time || (ttl_time == best_time && memory < best_memory)) {
+                best_time   = ttl_time;
+                best_memory = memory;
+                for (int id = 0; id < 3; ++id) {
+                    nproc[id] = cnproc[id];
+                }
+            }
+        }
+    }
+    FLUPS_CHECK(best_time >= 0.0, "no proc grid of %d ranks fits the %d %d %d unknowns", comm_size, nglob[0], nglob[1], nglob[2]);
+    if (rank == 0) {
+        FLUPS_INFO_1("proc repartition: %d x %d x %d (modeled communication time = %e s, memory = %lld bytes per rank)", nproc[0], nproc[1], nproc[2], best_time, best_memory);
+    }
+    //-------------------------------------------------------------------------
+    END_FUNC;
+}
+
+#if (FLUPS_MPI_AGGRESSIVE)
+/**
+ * @brief replaces the field switchtopos by the backends asked through @ref set_SwitchType or the FLUPS_COMM environment variable
+ *
+ * The environment variable is either a single backend or a comma-separated list, one per switchtopo.
+ * A backend set by @ref set_SwitchType has the priority on the environment variable.
+ */
+void Solver::select_SwitchType_() {
+    BEGIN_FUNC;
+    //-------------------------------------------------------------------------
+    // get the backends from the environment
+    SwitchType  env_type[3] = {SWITCH_DEFAULT, SWITCH_DEFAULT, SWITCH_DEFAULT};
+    const char *env         = std::getenv("FLUPS_COMM");
+    if (env != NULL) {
+        std::string env_list(env);
+        size_t      pos = 0;
+        for (int ip = 0; ip < 3; ++ip) {
+            const size_t next = env_list.find(',', pos);
+            env_type[ip]      = SwitchTopoX_type(env_list.substr(pos, next - pos).c_str());
+            // the last backend is used for the remaining switchtopos
+            if (next != std::string::npos) pos = next + 1;
+        }
+    }
+
+    int rank;
+    MPI_Comm_rank(topo_phys_->get_comm(), &rank);
+    for (int ip = 0; ip < ndim_; ++ip) {
+        if (switchtopo_[ip] == NULL || (skip_st0_ && ip == 0)) continue;
+        // a single rank never communicates, there is nothing to select
+        if (switchtopo_[ip]->switch_type() == SWITCH_SELF) continue;
+
+        SwitchType type = (switch_type_[ip] != SWITCH_DEFAULT) ? switch_type_[ip] : env_type[ip];
+        if (type == SWITCH_DEFAULT) continue;
+        if (type == SWITCH_AUTO) {
+            type = autotune_SwitchType_(ip);
+        }
+        // replace the switchtopo if needed
+        if (type != switchtopo_[ip]->switch_type()) {
+            SwitchTopoX *new_switchtopo = new_switchtopo_(ip, type, prof_);
+            delete switchtopo_[ip];
+            switchtopo_[ip] = new_switchtopo;
+        }
+        if (rank == 0) {
+            FLUPS_INFO_1("switchtopo %d uses the %s backend", ip, SwitchTopoX_name(type));
+        }
+    }
+    //-------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief creates a new switchtopo with the same topologies and shift as switchtopo_[ip], using the given backend
+ */
+SwitchTopoX *Solver::new_switchtopo_(const int ip, const SwitchType type, H3LPR::Profiler *prof) {
+    BEGIN_FUNC;
+    //-------------------------------------------------------------------------
+    const SwitchTopoX *ref      = switchtopo_[ip];
+    Topology          *topo_out = topo_hat_[ip];
+    FLUPS_CHECK(ref->topo_out() == topo_out, "the output topology of switchtopo %d must be topo_hat_[%d]", ip, ip);
+    // the two topos must have the same nf at the creation, we temporarily go back to real if needed
+    const bool is_r2c = topo_out->isComplex() && !ref->topo_in()->isComplex();
+    if (is_r2c) topo_out->switch2real();
+    SwitchTopoX *switchtopo = SwitchTopoX_new(type, ref->topo_in(), topo_out, ref->shift(), prof);
+    if (is_r2c) topo_out->switch2complex();
+    //-------------------------------------------------------------------------
+    END_FUNC;
+    return switchtopo;
+}
+
+/**
+ * @brief times the forward and backward execution of switchtopo_[ip] with every backend and returns the fastest one
+ *
+ * The timing is done on the field memory, with FLUPS_MPI_AUTOTUNE_NITER executions after a warm-up.
+ * The maximum time among the ranks is used so that every rank selects the same backend.
+ */
+SwitchType Solver::autotune_SwitchType_(const int ip) {
+    BEGIN_FUNC;
+    //-------------------------------------------------------------------------
+    const int        n_candidate            = 4;
+    const SwitchType candidate[n_candidate] = {SWITCH_A2A, SWITCH_A2AW, SWITCH_NB, SWITCH_ISR};
+    MPI_Comm         comm                   = topo_phys_->get_comm();
+
+    SwitchType best_type = SWITCH_DEFAULT;
+    double     best_time = std::numeric_limits<double>::max();
+    for (int ic = 0; ic < n_candidate; ++ic) {
+        SwitchTopoX *switchtopo[1] = {new_switchtopo_(ip, candidate[ic], NULL)};
+        m_ptr_t      send_buf, recv_buf;
+        allocate_switchTopo_(1, switchtopo, &send_buf, &recv_buf);
+
+        // warm-up and timing, the previous topos are in the state they have when the switchtopo is executed (see do_FFT)
+        double time = 0.0;
+        for (int jp = 0; jp < ip; ++jp) {
+            if (plan_forward_[jp]->isr2c()) topo_hat_[jp]->switch2complex();
+        }
+        for (int it = 0; it <= FLUPS_MPI_AUTOTUNE_NITER; ++it) {
+            MPI_Barrier(comm);
+            const double t0 = MPI_Wtime();
+            switchtopo[0]->execute(data_, FLUPS_FORWARD);
+            switchtopo[0]->execute(data_, FLUPS_BACKWARD);
+            if (it > 0) time += MPI_Wtime() - t0;
+        }
+        for (int jp = 0; jp < ip; ++jp) {
+            if (plan_forward_[jp]->isr2c()) topo_hat_[jp]->switch2real();
+        }
+        MPI_Allreduce(MPI_IN_PLACE, &time, 1, MPI_DOUBLE, MPI_MAX, comm);
+        FLUPS_INFO("switchtopo %d with %s backend: %e s", ip, SwitchTopoX_name(candidate[ic]), time / FLUPS_MPI_AUTOTUNE_NITER);
+        if (time < best_time) {
+            best_time = time;
+            best_type = candidate[ic];
+        }
+
+        // the switchtopo must be deleted before the buffers
+        delete switchtopo[0];
+        deallocate_switchTopo_(switchtopo, &send_buf, &recv_buf);
+    }
+    //-------------------------------------------------------------------------
+    END_FUNC;
+    return best_type;
+}
+#endif
+
 /**
  * @brief allocates the plans in planmap according to that computed during the dry run, see \ref init_plansAndTopos_
  *
@@ -911,7 +1777,7 @@ void Solver::deallocate_switchTopo_(SwitchTopo **switchtopo, opt_double_ptr *sen
  * @param planmap the list of plans that we need to allocate
  * @param data pointer to data (on which the FFTs will be applied in place)
  */
-void Solver::allocate_plans_(const Topology *const topo[3], FFTW_plan_dim *planmap[3], double *data) {
+void Solver::allocate_plans_(const Topology *const topo[3], FFTW_plan_dim *planmap[3], flups_real *data) {
     BEGIN_FUNC;
     //-------------------------------------------------------------------------
     for (int ip = 0; ip < ndim_; ip++) {
@@ -928,7 +1794,7 @@ void Solver::allocate_plans_(const Topology *const topo[3], FFTW_plan_dim *planm
  * @param topo_phys optionally, another topo which might drive the maximum allocated size
  * @param data poiter to the pointer to data
  */
-void Solver::allocate_data_(const Topology *const topo[3], const Topology *topo_phys, double **data) {
+void Solver::allocate_data_(const Topology *const topo[3], const Topology *topo_phys, flups_real **data) {
     BEGIN_FUNC;
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -949,9 +1815,9 @@ void Solver::allocate_data_(const Topology *const topo[3], const Topology *topo_
     }
 
     FLUPS_INFO_3("Complex memory allocation, size = %ld", size_tot);
-    (*data) = (double *)m_calloc(size_tot * sizeof(double));
+    (*data) = (flups_real *)m_calloc(size_tot * sizeof(flups_real));
 
-    std::memset(*data, 0, size_tot * sizeof(double));
+    std::memset(*data, 0, size_tot * sizeof(flups_real));
     //-------------------------------------------------------------------------
     /** - Check memory alignement */
     //-------------------------------------------------------------------------
@@ -974,7 +1840,7 @@ void Solver::allocate_data_(const Topology *const topo[3], const Topology *topo_
  * -----------------------------------
  * We do the following operations
  */
-void Solver::cmptGreenFunction_(Topology *topo[3], double *green, FFTW_plan_dim *planmap[3]) {
+void Solver::cmptGreenFunction_(Topology *topo[3], flups_real *green, FFTW_plan_dim *planmap[3]) {
     BEGIN_FUNC;
     //-------------------------------------------------------------------------
     //-------------------------------------------------------------------------
@@ -1060,7 +1926,9 @@ void Solver::cmptGreenFunction_(Topology *topo[3], double *green, FFTW_plan_dim
 
         // go to the topology for the plan, if we are not already on it
         if (ip > 0) {
+            if (progress_ != NULL) progress_->activate();
             switchtopo_green_[ip]->execute(green, FLUPS_FORWARD);
+            if (progress_ != NULL) progress_->deactivate();
         }
 
         // execute the plan, if not already spectral
@@ -1107,7 +1975,7 @@ void Solver::cmptGreenFunction_(Topology *topo[3], double *green, FFTW_plan_dim
  * @param data the Green's function
  * @param killModeZero  specify if you want to kill what's in kx=ky=kz=0
  */
-void Solver::scaleGreenFunction_(const Topology *topo, opt_double_ptr data, const bool killModeZero) {
+void Solver::scaleGreenFunction_(const Topology *topo, opt_real_ptr data, const bool killModeZero) {
     BEGIN_FUNC;
     // the symmetry is done along the fastest rotating index
     const int ax0 = topo->axis();
@@ -1120,12 +1988,12 @@ void Solver::scaleGreenFunction_(const Topology *topo, opt_double_ptr data, cons
     const size_t inmax   = topo->nloc(ax0) * topo->nf();
     const double volfact = volfact_;
 
-    FLUPS_CHECK(FLUPS_ISALIGNED(data) && (nmem[ax0] * topo->nf() * sizeof(double)) % FLUPS_ALIGNMENT == 0, "please use FLUPS_ALIGNMENT to align the memory");
+    FLUPS_CHECK(FLUPS_ISALIGNED(data) && (nmem[ax0] * topo->nf() * sizeof(flups_real)) % FLUPS_ALIGNMENT == 0, "please use FLUPS_ALIGNMENT to align the memory");
 
     // do the loop
 #pragma omp parallel for default(none) proc_bind(close) schedule(static) firstprivate(nf, onmax, inmax, nmem, data, volfact, ax0)
     for (int io = 0; io < onmax; io++) {
-        opt_double_ptr dataloc = data + collapsedIndex(ax0, 0, io, nmem, nf);
+        opt_real_ptr dataloc = data + collapsedIndex(ax0, 0, io, nmem, nf);
         // set the alignment
         FLUPS_ASSUME_ALIGNED(dataloc, FLUPS_ALIGNMENT);
         for (size_t ii = 0; ii < inmax; ii++) {
@@ -1158,7 +2026,7 @@ void Solver::scaleGreenFunction_(const Topology *topo, opt_double_ptr data, cons
  * @param topo the last topology used for green (in full spectral)
  * @param plan the last plan of the Green's function
  */
-void Solver::finalizeGreenFunction_(Topology *topo_field, double *green, const Topology *topo, FFTW_plan_dim *planmap[3]) {
+void Solver::finalizeGreenFunction_(Topology *topo_field, flups_real *green, const Topology *topo, FFTW_plan_dim *planmap[3]) {
     BEGIN_FUNC;
     //-------------------------------------------------------------------------
     /** - If needed, we create a new switchTopo from the current Green topo to the field one */
@@ -1199,7 +2067,7 @@ void Solver::finalizeGreenFunction_(Topology *topo_field, double *green, const T
  * -----------------------------------------------
  * We perform the following operations:
  */
-void Solver::solve(double *field, double *rhs, const SolverType type) {
+void Solver::solve(flups_real *field, flups_real *rhs, const SolverType type) {
     BEGIN_FUNC;
     FLUPS_CHECK((type == ROT && topo_phys_->lda() == 3) || (type !=ROT), "You need vectors when using the ROT solver");
     FLUPS_CHECK(!(type == ROT && odiff_ == NOD), "If calling the ROT solver, you need to initialize it with orderDiff = SPE or orderDiff = FD2");
@@ -1208,13 +2076,13 @@ void Solver::solve(double *field, double *rhs, const SolverType type) {
     FLUPS_CHECK(rhs != NULL, "rhs is NULL");
     //-------------------------------------------------------------------------
 
-    opt_double_ptr mydata = data_;
+    opt_real_ptr mydata = data_;
 
     m_profStarti(prof_, "solve");
     //-------------------------------------------------------------------------
     /** - clean the data memory */
     //-------------------------------------------------------------------------
-    std::memset(mydata, 0, sizeof(double) * get_allocSize());
+    std::memset(mydata, 0, sizeof(flups_real) * get_allocSize());
 
     //-------------------------------------------------------------------------
     /** - copy the rhs in the correct order */
@@ -1273,15 +2141,15 @@ void Solver::solve(double *field, double *rhs, const SolverType type) {
  * @param data
  * @param sign
  */
-void Solver::do_copy(const Topology *topo, double *data, const int sign) {
+void Solver::do_copy(const Topology *topo, flups_real *data, const int sign) {
     BEGIN_FUNC;
     FLUPS_CHECK(data != NULL, "data is NULL");
     FLUPS_CHECK(lda_ == topo->lda(), "the solver lda = %d must match the topology one = %d", lda_, topo->lda());
     //-------------------------------------------------------------------------
     m_profStart(prof_, "copy rhs");
 
-    double *owndata = data_;
-    double *argdata = data;
+    flups_real *owndata = data_;
+    flups_real *argdata = data;
 
     const int    ax0     = topo->axis();
     const int    ax1     = (ax0 + 1) % 3;
@@ -1293,7 +2161,7 @@ void Solver::do_copy(const Topology *topo, double *data, const int sign) {
     const size_t inmax   = topo->nloc(ax0);
 
     // if the data is aligned and the FRI is a multiple of the alignment we can go for a full aligned loop
-    if (FLUPS_ISALIGNED(argdata) && (nmem[ax0] * topo->nf() * sizeof(double)) % FLUPS_ALIGNMENT == 0) {
+    if (FLUPS_ISALIGNED(argdata) && (nmem[ax0] * topo->nf() * sizeof(flups_real)) % FLUPS_ALIGNMENT == 0) {
         // do the loop
         if (sign == FLUPS_FORWARD) {
             // Copying from arg to own
@@ -1303,8 +2171,8 @@ void Solver::do_copy(const Topology *topo, double *data, const int sign) {
                 const size_t lia = id / ondim;
                 const size_t io  = id % ondim;
                 // get the pointers
-                opt_double_ptr argloc = argdata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
-                opt_double_ptr ownloc = owndata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
+                opt_real_ptr argloc = argdata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
+                opt_real_ptr ownloc = owndata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
                 // set the alignment
                 FLUPS_ASSUME_ALIGNED(argloc, FLUPS_ALIGNMENT);
                 FLUPS_ASSUME_ALIGNED(ownloc, FLUPS_ALIGNMENT);
@@ -1320,8 +2188,8 @@ void Solver::do_copy(const Topology *topo, double *data, const int sign) {
                 const size_t lia = id / ondim;
                 const size_t io  = id % ondim;
                 // get the pointers
-                opt_double_ptr argloc = argdata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
-                opt_double_ptr ownloc = owndata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
+                opt_real_ptr argloc = argdata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
+                opt_real_ptr ownloc = owndata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
                 // set the alignment
                 FLUPS_ASSUME_ALIGNED(argloc, FLUPS_ALIGNMENT);
                 FLUPS_ASSUME_ALIGNED(ownloc, FLUPS_ALIGNMENT);
@@ -1332,7 +2200,7 @@ void Solver::do_copy(const Topology *topo, double *data, const int sign) {
         }
     } else {
         // do the loop
-        FLUPS_WARNING("loop uses unaligned access: alignment(&data[0]) = %d, alignment(data[i]) = %lu. Please align your topology using FLUPS_ALIGNMENT!!", FLUPS_CMPT_ALIGNMENT(argdata), (nmem[ax0] * topo->nf() * sizeof(double)) % FLUPS_ALIGNMENT);
+        FLUPS_WARNING("loop uses unaligned access: alignment(&data[0]) = %d, alignment(data[i]) = %lu. Please align your topology using FLUPS_ALIGNMENT!!", FLUPS_CMPT_ALIGNMENT(argdata), (nmem[ax0] * topo->nf() * sizeof(flups_real)) % FLUPS_ALIGNMENT);
         if (sign == FLUPS_FORWARD) {
             // Copying from arg to own
 #pragma omp parallel for default(none) proc_bind(close) schedule(static) firstprivate(onmax, inmax, owndata, argdata, nmem, ax0, ondim, memdim)
@@ -1341,8 +2209,8 @@ void Solver::do_copy(const Topology *topo, double *data, const int sign) {
                 const size_t lia = id / ondim;
                 const size_t io  = id % ondim;
                 // get the pointers
-                double *__restrict argloc = argdata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
-                opt_double_ptr ownloc     = owndata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
+                flups_real *__restrict argloc = argdata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
+                opt_real_ptr ownloc     = owndata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
                 FLUPS_ASSUME_ALIGNED(ownloc, FLUPS_ALIGNMENT);
                 for (size_t ii = 0; ii < inmax; ii++) {
                     ownloc[ii] = argloc[ii];
@@ -1356,8 +2224,8 @@ void Solver::do_copy(const Topology *topo, double *data, const int sign) {
                 const size_t lia = id / ondim;
                 const size_t io  = id % ondim;
                 // get the pointers
-                double *__restrict argloc = argdata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
-                opt_double_ptr ownloc     = owndata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
+                flups_real *__restrict argloc = argdata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
+                opt_real_ptr ownloc     = owndata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
                 FLUPS_ASSUME_ALIGNED(ownloc, FLUPS_ALIGNMENT);
                 for (size_t ii = 0; ii < inmax; ii++) {
                     argloc[ii] = ownloc[ii];
@@ -1371,8 +2239,8 @@ void Solver::do_copy(const Topology *topo, double *data, const int sign) {
         // get the lia and the io
         const size_t lia          = id / ondim;
         const size_t io           = id % ondim;
-        double *__restrict argloc = argdata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
-        opt_double_ptr ownloc     = owndata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
+        flups_real *__restrict argloc = argdata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
+        opt_real_ptr ownloc     = owndata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, 1);
         FLUPS_ASSUME_ALIGNED(ownloc, FLUPS_ALIGNMENT);
         for (size_t ii = 0; ii < inmax; ii++) {
             FLUPS_CHECK(std::isfinite(argloc[ii]), "You should not have nan here... -> %zu", ii);
@@ -1394,18 +2262,20 @@ void Solver::do_copy(const Topology *topo, double *data, const int sign) {
  * @param data pointer to data
  * @param sign FLUPS_FORWARD or FLUPS_BACKWARD
  */
-void Solver::do_FFT(double *data, const int sign) {
+void Solver::do_FFT(flups_real *data, const int sign) {
     BEGIN_FUNC;
     FLUPS_CHECK(data != NULL, "data is NULL");
     //-------------------------------------------------------------------------
-    opt_double_ptr mydata = data;
+    opt_real_ptr mydata = data;
 
     if (sign == FLUPS_FORWARD) {
         for (int ip = 0; ip < ndim_; ip++) {
             // go to the correct topo
             m_profStarti(prof_, "SwitchTopo");
             if (!(skip_st0_ && (ip == 0))) {
+                if (progress_ != NULL) progress_->activate();
                 switchtopo_[ip]->execute(mydata, FLUPS_FORWARD);
+                if (progress_ != NULL) progress_->deactivate();
             }
             m_profStopi(prof_, "SwitchTopo");
             // run the FFT
@@ -1430,7 +2300,9 @@ void Solver::do_FFT(double *data, const int sign) {
             plan_backward_[ip]->postprocess_plan(topo_hat_[ip], mydata);
             m_profStarti(prof_, "SwitchTopo");
             if (!(skip_st0_ && (ip == 0))) {
+                if (progress_ != NULL) progress_->activate();
                 switchtopo_[ip]->execute(mydata, FLUPS_BACKWARD);
+                if (progress_ != NULL) progress_->deactivate();
             }
             m_profStopi(prof_, "SwitchTopo");
         }
@@ -1447,7 +2319,9 @@ void Solver::do_FFT(double *data, const int sign) {
 
             m_profStarti(prof_, "SwitchTopo");
             if (!(skip_st0_ && (ip == 0))) {
+                if (progress_ != NULL) progress_->activate();
                 switchtopo_[ip]->execute(mydata, FLUPS_BACKWARD);
+                if (progress_ != NULL) progress_->deactivate();
             }
             m_profStopi(prof_, "SwitchTopo");
         }
@@ -1463,7 +2337,7 @@ void Solver::do_FFT(double *data, const int sign) {
  * @param data
  * @param type
  */
-void Solver::do_mult(double *data, const SolverType type) {
+void Solver::do_mult(flups_real *data, const SolverType type) {
     BEGIN_FUNC;
     FLUPS_CHECK(data != NULL, "data is NULL");
 
@@ -16,11 +16,13 @@
 #include "defines.hpp"
 #include "green_functions.hpp"
 #include "hdf5_io.hpp"
+#include "ProgressThread.hpp"
 
 #if (FLUPS_MPI_AGGRESSIVE)
 #include "SwitchTopoX_a2a.hpp"
 #include "SwitchTopoX_isr.hpp"
 #include "SwitchTopoX_nb.hpp"
+#include "SwitchTopoX_rma.hpp"
 #else
 #include "SwitchTopo.hpp"
 #include "SwitchTopo_a2a.hpp"
@@ -61,7 +63,7 @@ class Solver {
     double   normfact_      = 1.0;    //!< normalization factor so that the forward/backward FFT gives output = input */
     double   volfact_       = 1.0;    //!< volume factor due to the convolution computation */
     double   hgrid_[3]      = {0.0};  //!< grid spacing in the tranposed directions */
-    double*  data_          = NULL;   //!< data pointer to the transposed memory */
+    flups_real* data_       = NULL;   //!< data pointer to the transposed memory */
 
     /**
      * @name Forward and backward
@@ -81,12 +83,26 @@ class Solver {
     SwitchTopo*    switchtopo_[3]       = {NULL, NULL, NULL}; /**< @brief switcher of topologies for the forward transform (phys->topo[0], topo[0]->topo[1], topo[1]->topo[2]).*/
 #endif
 
+#if (FLUPS_MPI_AGGRESSIVE)
+    SwitchType   switch_type_[3] = {SWITCH_DEFAULT, SWITCH_DEFAULT, SWITCH_DEFAULT}; /**< @brief the communication backend asked for each switchtopo */
+    SubCommCache subcomm_cache_;                                                     /**< @brief the subcomms of the switchtopos, shared by the field and the Green's function */
+#endif
+
+    bool      do_reorder_       = FLUPS_REORDER_RANKS; /**< @brief reorder the ranks based on the communication graph at the setup */
+    bool      is_reorder_set_   = false;               /**< @brief true if the reordering has been set through @ref set_ReorderRanks */
+    MPI_Comm  graph_comm_       = MPI_COMM_NULL;       /**< @brief the communicator with the reordered ranks (if any) */
+    long long internode_vol_[2] = {0, 0};              /**< @brief volume of the graph exchanged between the nodes before and after (predicted) the reordering */
+    int       node_group_       = 0;                   /**< @brief number of ranks doing the 2nd switchtopo together in the node-aware decomposition (0 if not used) */
+    bool      is_slab_          = false;               /**< @brief true if the slab decomposition is used, the 2nd switchtopo is then local */
+    int       n_active_         = 1;                   /**< @brief number of ranks doing the transforms, the first ones of the communicator (see @ref subset_size_) */
+    int       active_group_     = 0;                   /**< @brief number of ranks along the 3rd direction of the 1st topology with a subset of the ranks (0 if not used) */
+
 #if (FLUPS_MPI_AGGRESSIVE)
     m_ptr_t sendBuf_;
     m_ptr_t recvBuf_;
 #else
-    opt_double_ptr sendBuf_             = NULL;               /**<@brief The send buffer for switchtopo_ */
-    opt_double_ptr recvBuf_             = NULL;               /**<@brief The recv buffer for switchtopo_ */
+    opt_real_ptr sendBuf_             = NULL;               /**<@brief The send buffer for switchtopo_ */
+    opt_real_ptr recvBuf_             = NULL;               /**<@brief The recv buffer for switchtopo_ */
 #endif
     /**@} */
 
@@ -96,7 +112,7 @@ class Solver {
      */
     /**@{ */
     double    alphaGreen_ = 2.0;    /**< @brief regularization parameter for HEJ_* Green's functions */
-    double*   green_      = NULL;   /**< @brief data pointer to the transposed memory for Green */
+    flups_real* green_    = NULL;   /**< @brief data pointer to the transposed memory for Green */
     GreenType typeGreen_  = CHAT_2; /**< @brief the type of Green's function */
 
     FFTW_plan_dim* plan_green_[3];                      /**< @brief map containing the plan for the Green's function */
@@ -112,13 +128,16 @@ class Solver {
     // time the solve
     H3LPR::Profiler* prof_ = NULL;
 
+    // drive the MPI progress during the switchtopos (only with FLUPS_MPI_PROGRESS)
+    ProgressThread* progress_ = NULL;
+
    protected:
     /**
      * @name Data management
      *
      * @{
      */
-    void allocate_data_(const Topology* const topo[3], const Topology* topo_phys, double** data);
+    void allocate_data_(const Topology* const topo[3], const Topology* topo_phys, flups_real** data);
 #if (FLUPS_MPI_AGGRESSIVE)
     void delete_switchtopos_(SwitchTopoX* switchtopo[3]);
 #else
@@ -137,7 +156,13 @@ class Solver {
 #else
     void           init_plansAndTopos_(const Topology* topo, Topology* topomap[3], SwitchTopo* switchtopo[3], FFTW_plan_dim* planmap[3], bool isGreen);
 #endif
-    void allocate_plans_(const Topology* const topo[3], FFTW_plan_dim* planmap[3], double* data);
+    int  node_pencil_group_(const Topology* topo) const;
+    int  subset_size_(const Topology* topo, const int mode, int* group) const;
+    bool use_slab_(const Topology* topo, const bool is_forced) const;
+    void select_decomposition_(const Topology* topo);
+    void tune_order_(const Topology* topo, BoundaryType* rhsbc[3][2], const double h[3], const double L[3], const CenterType centertype[3], const bool is_timed, int order[2][3]);
+    double time_switchtopos_();
+    void allocate_plans_(const Topology* const topo[3], FFTW_plan_dim* planmap[3], flups_real* data);
     void delete_plans_(FFTW_plan_dim* planmap[3]);
     /**@} */
 
@@ -149,10 +174,15 @@ class Solver {
 #if (FLUPS_MPI_AGGRESSIVE)
     void allocate_switchTopo_(const int ntopo, SwitchTopoX** switchtopo, m_ptr_t* send_buff, m_ptr_t* recv_buff);
     void deallocate_switchTopo_(SwitchTopoX** switchtopo, m_ptr_t* send_buff, m_ptr_t* recv_buff);
+    void select_SwitchType_();
+    SwitchType   autotune_SwitchType_(const int ip);
+    SwitchTopoX* new_switchtopo_(const int ip, const SwitchType type, H3LPR::Profiler* prof);
 #else
-    void           allocate_switchTopo_(const int ntopo, SwitchTopo** switchtopo, opt_double_ptr* send_buff, opt_double_ptr* recv_buff);
-    void           deallocate_switchTopo_(SwitchTopo** switchtopo, opt_double_ptr* send_buff, opt_double_ptr* recv_buff);
+    void           allocate_switchTopo_(const int ntopo, SwitchTopo** switchtopo, opt_real_ptr* send_buff, opt_real_ptr* recv_buff);
+    void           deallocate_switchTopo_(SwitchTopo** switchtopo, opt_real_ptr* send_buff, opt_real_ptr* recv_buff);
 #endif
+    void add_toGraph_(const bool changeTopoComm, int* sourcesW, int* destsW);
+    void reorder_ranks_(const bool changeTopoComm);
     void reorder_metis_(MPI_Comm comm, int* sources, int* sourcesW, int* dests, int* destsW, int* order);
     /**@} */
 
@@ -161,16 +191,16 @@ class Solver {
      *
      * @{
      */
-    void dothemagic_std_real(double* data);
-    void dothemagic_std_complex(double* data);
-    void dothemagic_rot_real_o1(double* data, const double koffset[3], const double kfact[3][3][2], const double symstart[3]);
-    void dothemagic_rot_complex_o1(double* data, const double koffset[3], const double kfact[3][3][2], const double symstart[3]);
-    void dothemagic_rot_real_o2(double* data, const double koffset[3], const double kfact[3][3][2], const double symstart[3], const double hgrid[3]);
-    void dothemagic_rot_complex_o2(double* data, const double koffset[3], const double kfact[3][3][2], const double symstart[3], const double hgrid[3]);
-    void dothemagic_rot_real_o4(double* data, const double koffset[3], const double kfact[3][3][2], const double symstart[3], const double hgrid[3]);
-    void dothemagic_rot_complex_o4(double* data, const double koffset[3], const double kfact[3][3][2], const double symstart[3], const double hgrid[3]);
-    void dothemagic_rot_real_o6(double* data, const double koffset[3], const double kfact[3][3][2], const double symstart[3], const double hgrid[3]);
-    void dothemagic_rot_complex_o6(double* data, const double koffset[3], const double kfact[3][3][2], const double symstart[3], const double hgrid[3]);
+    void dothemagic_std_real(flups_real* data);
+    void dothemagic_std_complex(flups_real* data);
+    void dothemagic_rot_real_o1(flups_real* data, const double koffset[3], const double kfact[3][3][2], const double symstart[3]);
+    void dothemagic_rot_complex_o1(flups_real* data, const double koffset[3], const double kfact[3][3][2], const double symstart[3]);
+    void dothemagic_rot_real_o2(flups_real* data, const double koffset[3], const double kfact[3][3][2], const double symstart[3], const double hgrid[3]);
+    void dothemagic_rot_complex_o2(flups_real* data, const double koffset[3], const double kfact[3][3][2], const double symstart[3], const double hgrid[3]);
+    void dothemagic_rot_real_o4(flups_real* data, const double koffset[3], const double kfact[3][3][2], const double symstart[3], const double hgrid[3]);
+    void dothemagic_rot_complex_o4(flups_real* data, const double koffset[3], const double kfact[3][3][2], const double symstart[3], const double hgrid[3]);
+    void dothemagic_rot_real_o6(flups_real* data, const double koffset[3], const double kfact[3][3][2], const double symstart[3], const double hgrid[3]);
+    void dothemagic_rot_complex_o6(flups_real* data, const double koffset[3], const double kfact[3][3][2], const double symstart[3], const double hgrid[3]);
     /**@} */
 
     /**
@@ -178,10 +208,10 @@ class Solver {
      *
      * @{
      */
-    void cmptGreenFunction_(Topology* topo[3], double* green, FFTW_plan_dim* planmap[3]);
-    void cmptGreenSymmetry_(const Topology* topo, const int sym_idx, double* data, const bool isComplex);
-    void scaleGreenFunction_(const Topology* topo, double* data, bool killModeZero);
-    void finalizeGreenFunction_(Topology* topo_field, double* green, const Topology* topo, FFTW_plan_dim* planmap[3]);
+    void cmptGreenFunction_(Topology* topo[3], flups_real* green, FFTW_plan_dim* planmap[3]);
+    void cmptGreenSymmetry_(const Topology* topo, const int sym_idx, flups_real* data, const bool isComplex);
+    void scaleGreenFunction_(const Topology* topo, flups_real* data, bool killModeZero);
+    void finalizeGreenFunction_(Topology* topo_field, flups_real* green, const Topology* topo, FFTW_plan_dim* planmap[3]);
     /**@} */
 
    public:
@@ -192,7 +222,7 @@ class Solver {
     Topology* get_innerTopo_physical();
     Topology* get_innerTopo_spectral();
 
-    double* get_innerBuffer() { return data_; };
+    flups_real* get_innerBuffer() { return data_; };
 
     void skip_firstSwitchtopo() { skip_st0_ = true; };
 
@@ -230,7 +260,7 @@ class Solver {
      *
      * @{
      */
-    void solve(double* field, double* rhs, const SolverType type);
+    void solve(flups_real* field, flups_real* rhs, const SolverType type);
     /**@} */
 
     /**
@@ -238,9 +268,9 @@ class Solver {
      *
      * @{
      */
-    void do_copy(const Topology* topo, double* data, const int sign);
-    void do_FFT(double* data, const int sign);
-    void do_mult(double* data, const SolverType type);
+    void do_copy(const Topology* topo, flups_real* data, const int sign);
+    void do_FFT(flups_real* data, const int sign);
+    void do_mult(flups_real* data, const SolverType type);
     /**@} */
 
     /**
@@ -252,6 +282,17 @@ class Solver {
     void set_alpha(const double alpha) { alphaGreen_ = alpha; }
     /**@} */
 
+    /**
+     * @name Communications
+     *
+     * @{
+     */
+    void set_SwitchType(const int istp, const SwitchType type);
+    void set_ReorderRanks(const bool reorder);
+    void get_commCost(double time[3], long long volume[3], int nmsg[3], const bool isGreen = false) const;
+    double get_transportError() const;
+    /**@} */
+
     /**
      * @name Print MPI info of the Switchtopos
      *
@@ -271,9 +312,10 @@ class Solver {
  * @param comm_size the total communicator size
  * @param id_hint the axis where we allow the proc decomposition to change
  * @param nproc_hint the number of procs in the other decomposition we want to be compatible with
+ * @param is_slab true if the slab decomposition is asked (no warning is then issued)
  *
  */
-static inline void pencil_nproc_hint(const int id, int nproc[3], const int comm_size, const int id_hint, const int nproc_hint[3]) {
+static inline void pencil_nproc_hint(const int id, int nproc[3], const int comm_size, const int id_hint, const int nproc_hint[3], const bool is_slab = false) {
     // get the id shared between the hint topo
     int sharedID = 0;
     for (int i = 0; i < 3; i++) {
@@ -289,9 +331,11 @@ static inline void pencil_nproc_hint(const int id, int nproc[3], const int comm_
     FLUPS_INFO("My proc repartition in this topo is %d %d %d", nproc[0], nproc[1], nproc[2]);
     FLUPS_CHECK(nproc[0] * nproc[1] * nproc[2] == comm_size, "the number of proc %d %d %d does not match the comm size %d", nproc[0], nproc[1], nproc[2], comm_size);
 
-    if (comm_size > 8 && (nproc[sharedID] == 1 || nproc[id_hint] == 1)) {
+    if (!is_slab && comm_size > 8 && (nproc[sharedID] == 1 || nproc[id_hint] == 1)) {
         FLUPS_WARNING("A slab decomposition was used instead of a pencil decomposition in direction %d. This may increase communication time.", id);
     }
 }
 
+void hint_proc_repartition(const int lda, const int nglob[3], const double h[3], const double L[3], BoundaryType* bc[3][2], const CenterType center_type[3], MPI_Comm comm, int nproc[3]);
+
 #endif
@@ -557,16 +557,16 @@ void SwitchTopo::cmpt_start_and_count_(MPI_Comm comm, const int nBlock, const in
  * @param data the data on which to apply the transformation
  * @param shuffle the suffle plan
  */
-void SwitchTopo::setup_shuffle_(const int bSize[3], const Topology* topo_in, const Topology* topo_out, double* data, fftw_plan* shuffle) {
+void SwitchTopo::setup_shuffle_(const int bSize[3], const Topology* topo_in, const Topology* topo_out, flups_real* data, FLUPS_FFTW(plan)* shuffle) {
     BEGIN_FUNC;
 
     // the nf will always be the max of both topologies !!
     const int nf = std::max(topo_in->nf(),topo_out->nf());
 
     // enable the multithreading for this plan
-    fftw_plan_with_nthreads(omp_get_max_threads());
+    FLUPS_FFTW(plan_with_nthreads)(omp_get_max_threads());
 
-    fftw_iodim dims[2];
+    FLUPS_FFTW(iodim) dims[2];
     // dim[0] = dimension of the targeted FRI (FFTW-convention)
     dims[0].n  = 1;
     dims[0].is = 1;
@@ -605,10 +605,10 @@ void SwitchTopo::setup_shuffle_(const int bSize[3], const Topology* topo_in, con
     // plan the real or complex plan
     // the nf is driven by the OUT topology ALWAYS
     if (nf == 1) {
-        *shuffle = fftw_plan_guru_r2r(0, NULL, 2, dims, data, data, NULL, FLUPS_FFTW_FLAG);
+        *shuffle = FLUPS_FFTW(plan_guru_r2r)(0, NULL, 2, dims, data, data, NULL, FLUPS_FFTW_FLAG);
         FLUPS_CHECK(*shuffle != NULL, "Plan has not been setup");
     } else if (nf == 2) {
-        *shuffle = fftw_plan_guru_dft(0, NULL, 2, dims, (fftw_complex*)data, (fftw_complex*)data, FLUPS_FORWARD, FLUPS_FFTW_FLAG);
+        *shuffle = FLUPS_FFTW(plan_guru_dft)(0, NULL, 2, dims, (FLUPS_FFTW(complex)*)data, (FLUPS_FFTW(complex)*)data, FLUPS_FORWARD, FLUPS_FFTW_FLAG);
         FLUPS_CHECK(*shuffle != NULL, "Plan has not been setup");
     }
 
@@ -50,11 +50,11 @@ class SwitchTopo {
     const Topology *topo_in_  = NULL; /**<@brief input topology  */
     const Topology *topo_out_ = NULL; /**<@brief  output topology */
 
-    opt_double_ptr *sendBuf_ = NULL; /**<@brief The send buffer for MPI send */
-    opt_double_ptr *recvBuf_ = NULL; /**<@brief The recv buffer for MPI recv */
+    opt_real_ptr *sendBuf_ = NULL; /**<@brief The send buffer for MPI send */
+    opt_real_ptr *recvBuf_ = NULL; /**<@brief The recv buffer for MPI recv */
 
-    fftw_plan* i2o_shuffle_ = NULL;
-    fftw_plan* o2i_shuffle_ = NULL;
+    FLUPS_FFTW(plan)* i2o_shuffle_ = NULL;
+    FLUPS_FFTW(plan)* o2i_shuffle_ = NULL;
 
     H3LPR::Profiler* prof_    = NULL;
     int       iswitch_ = -1;
@@ -62,8 +62,8 @@ class SwitchTopo {
    public:
     virtual ~SwitchTopo() {};
     virtual void setup()                                                                    = 0;
-    virtual void setup_buffers(opt_double_ptr sendData, opt_double_ptr recvData)            = 0;
-    virtual void execute(opt_double_ptr v, const int sign) const                            = 0;
+    virtual void setup_buffers(opt_real_ptr sendData, opt_real_ptr recvData)            = 0;
+    virtual void execute(opt_real_ptr v, const int sign) const                            = 0;
     virtual void disp() const                                                               = 0;
     
 
@@ -84,9 +84,9 @@ class SwitchTopo {
         // get the in and out sizes
         size_t total = (size_t)(blockSize[0][ib]) * (size_t)(blockSize[1][ib]) * (size_t)(blockSize[2][ib]) * (size_t)(nf);
         // add the difference with the alignement to be always aligned
-        size_t alignDelta = ((total * sizeof(double)) % FLUPS_ALIGNMENT == 0) ? 0 : (FLUPS_ALIGNMENT - (total * sizeof(double)) % FLUPS_ALIGNMENT) / sizeof(double);
+        size_t alignDelta = ((total * sizeof(flups_real)) % FLUPS_ALIGNMENT == 0) ? 0 : (FLUPS_ALIGNMENT - (total * sizeof(flups_real)) % FLUPS_ALIGNMENT) / sizeof(flups_real);
         total             = total + alignDelta;
-        FLUPS_CHECK((total * sizeof(double)) % FLUPS_ALIGNMENT == 0, "The total size of one block HAS to match the alignement size");
+        FLUPS_CHECK((total * sizeof(flups_real)) % FLUPS_ALIGNMENT == 0, "The total size of one block HAS to match the alignement size");
         // return the total size
         return total;
     };
@@ -125,7 +125,7 @@ class SwitchTopo {
     void cmpt_commSplit_();
     void setup_subComm_(const int nBlock, const int lda, int* blockSize[3], int* destRank, int** count, int** start);
     void cmpt_start_and_count_(MPI_Comm comm, const int nBlock, const int lda, int* blockSize[3], int* destRank, int** count, int** start);
-    void setup_shuffle_(const int bSize[3], const Topology* topo_in, const Topology* topo_out, double* data, fftw_plan* shuffle);
+    void setup_shuffle_(const int bSize[3], const Topology* topo_in, const Topology* topo_out, flups_real* data, FLUPS_FFTW(plan)* shuffle);
     void gather_blocks_(const Topology* topo, int nByBlock[3], int istart[3],int iend[3], int nBlockv[3], int* blockSize[3], int* blockiStart[3], int* nBlock, int** destRank);
     void gather_tags_(MPI_Comm comm, const int inBlock, const int onBlock, const int* i2o_destRank, const int* o2i_destRank, int** i2o_destTag, int** o2i_destTag);
 };
@@ -4,6 +4,11 @@
  *      See LICENSE file in top-level directory
 */
 #include "SwitchTopoX.hpp"
+#include "SwitchTopoX_a2a.hpp"
+#include "SwitchTopoX_isr.hpp"
+#include "SwitchTopoX_nb.hpp"
+#include "SwitchTopoX_rma.hpp"
+#include "SwitchTopoX_self.hpp"
 
 using namespace std;
 
@@ -18,9 +23,10 @@ SwitchTopoX::SwitchTopoX(const Topology* topo_in, const Topology* topo_out, cons
     // also, I cannot think about any situation where it would be useful.
     // supporting it would be cool though!
     // in order to do so, we need to improse a convention on which communicator is used for the communication
+    // the only exception is the reordering of the ranks, where the two communicators have the same processes
     int comp;
     MPI_Comm_compare(topo_in->get_comm(), topo_out->get_comm(), &comp);
-    FLUPS_CHECK(comp == MPI_IDENT, "we do NOT support different communicators in and out for the moment");
+    FLUPS_CHECK(comp != MPI_UNEQUAL, "we do NOT support different communicators in and out for the moment");
 #endif
     idswitchtopo_ = topo_out->axproc(topo_out->axis());
     //--------------------------------------------------------------------------
@@ -33,15 +39,13 @@ SwitchTopoX::~SwitchTopoX() {
     // deallocate the plans
     for (int ic = 0; ic < i2o_nchunks_; ic++) {
         // the shuffle happens in the "out" topology
-        MPI_Type_free(&i2o_chunks_[ic].dtype);
-        MPI_Type_free(&i2o_chunks_[ic].dest_dtype);
-        fftw_destroy_plan(i2o_chunks_[ic].shuffle);
+        FreeChunkMPIDataType(i2o_chunks_ + ic);
+        if (i2o_chunks_[ic].shuffle != NULL) FLUPS_FFTW(destroy_plan)(i2o_chunks_[ic].shuffle);
     }
     for (int ic = 0; ic < o2i_nchunks_; ic++) {
         // the shuffle happens in the "in" topology
-        MPI_Type_free(&o2i_chunks_[ic].dtype);
-        MPI_Type_free(&o2i_chunks_[ic].dest_dtype);
-        fftw_destroy_plan(o2i_chunks_[ic].shuffle);
+        FreeChunkMPIDataType(o2i_chunks_ + ic);
+        if (o2i_chunks_[ic].shuffle != NULL) FLUPS_FFTW(destroy_plan)(o2i_chunks_[ic].shuffle);
     }
 
     // free the MemChunks
@@ -50,10 +54,13 @@ SwitchTopoX::~SwitchTopoX() {
 
     // deallocate the subcom, only if it's NOT the inComm
     // MPI_Comm_free(&subcomm_);
-    int comp;
-    MPI_Comm_compare(subcomm_,inComm_,&comp);
-    if(comp!=MPI_IDENT){
-        MPI_Comm_free(&subcomm_);
+    // the subcomm does not exist if the switchtopo has never been setup
+    if (subcomm_ != MPI_COMM_NULL) {
+        int comp;
+        MPI_Comm_compare(subcomm_, inComm_, &comp);
+        if (comp != MPI_IDENT) {
+            MPI_Comm_free(&subcomm_);
+        }
     }
 
     //--------------------------------------------------------------------------
@@ -63,8 +70,33 @@ SwitchTopoX::~SwitchTopoX() {
 /**
  * @brief Setup the chunks and the subcommunicator for the communications
  *
+ * @param cache the subcommunicators of the switchtopos already setup, the new subcommunicator is taken from it or added to it (can be NULL)
  */
-void SwitchTopoX::setup() {
+void SwitchTopoX::setup(SubCommCache *cache) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    // the communicator of the topologies might have changed since the creation (see the rank reordering in Solver::setup)
+    inComm_  = topo_in_->get_comm();
+    outComm_ = topo_out_->get_comm();
+
+    // Populate the arrays of memory chunks
+    PopulateChunks_(&i2o_nchunks_, &i2o_chunks_, &o2i_nchunks_, &o2i_chunks_);
+
+    // Split the communication according to the destination of each chunk in the MPI_COMM_WORLD
+    SubCom_SplitComm(cache);
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief computes the chunks of both directions from the topologies
+ *
+ * @param i2o_nchunks the number of chunks in the input topology
+ * @param i2o_chunks the chunks in the input topology, their dest_rank is given in the communicator of the output topology
+ * @param o2i_nchunks the number of chunks in the output topology
+ * @param o2i_chunks the chunks in the output topology, their dest_rank is given in the communicator of the input topology
+ */
+void SwitchTopoX::PopulateChunks_(int *i2o_nchunks, MemChunk **i2o_chunks, int *o2i_nchunks, MemChunk **o2i_chunks) const {
     BEGIN_FUNC;
     //--------------------------------------------------------------------------
     // The input topo may have been reset to real, even if this switchtopo is a complex2complex.
@@ -76,7 +108,8 @@ void SwitchTopoX::setup() {
         tmp_axproc[i] = topo_in_->axproc(i);
     }
     
-    Topology * topo_in_tmp = new Topology(topo_in_->axis(), topo_in_->lda(), tmp_nglob, tmp_nproc, topo_in_->isComplex(), tmp_axproc, FLUPS_ALIGNMENT, topo_in_->get_comm());
+    // the input topo might have idle ranks if it has been built by the solver
+    Topology * topo_in_tmp = new Topology(topo_in_->axis(), topo_in_->lda(), tmp_nglob, tmp_nproc, topo_in_->isComplex(), tmp_axproc, FLUPS_ALIGNMENT, topo_in_->get_comm(), true);
     // If the output topo is complex while the input topo is real, switch the input topo as a complex one 
     if(topo_out_->isComplex() && !topo_in_->isComplex()){
         topo_in_tmp->switch2complex();
@@ -84,14 +117,68 @@ void SwitchTopoX::setup() {
     
     // Populate the arrays of memory chunks
     FLUPS_INFO("I2O chunks");
-    PopulateChunk(i2o_shift_, topo_in_tmp, topo_out_, &i2o_nchunks_, &i2o_chunks_);
+    PopulateChunk(i2o_shift_, topo_in_tmp, topo_out_, i2o_nchunks, i2o_chunks);
     FLUPS_INFO("O2I chunks");
-    PopulateChunk(o2i_shift_, topo_out_, topo_in_tmp, &o2i_nchunks_, &o2i_chunks_);
+    PopulateChunk(o2i_shift_, topo_out_, topo_in_tmp, o2i_nchunks, o2i_chunks);
 
     delete(topo_in_tmp);
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
 
-    // Split the communication according to the destination of each chunk in the MPI_COMM_WORLD
-    SubCom_SplitComm();
+/**
+ * @brief Determine and add the weights of the edges in the communication graph, i.e. the number of points exchanged with every rank
+ *
+ * The ranks are the ones of the communicator of the input topology. If the switchtopo has not been setup yet,
+ * the chunks are computed from the topologies, which allows to reorder the ranks before the setup.
+ *
+ * @param sourcesW the weights associated to the edge between other processors communicating to me
+ * @param destsW the weights associated to the edge betwenn me communicating to other processors
+ */
+void SwitchTopoX::add_toGraph(int *sourcesW, int *destsW) const {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    // the subcomm only exists once the switchtopo has been setup
+    const bool is_setup    = (subcomm_ != MPI_COMM_NULL);
+    int        i2o_nchunks = i2o_nchunks_;
+    int        o2i_nchunks = o2i_nchunks_;
+    MemChunk  *i2o_chunks  = i2o_chunks_;
+    MemChunk  *o2i_chunks  = o2i_chunks_;
+    if (!is_setup) {
+        PopulateChunks_(&i2o_nchunks, &i2o_chunks, &o2i_nchunks, &o2i_chunks);
+    }
+
+    // the chunks might refer to another communicator (output topology or subcomm)
+    MPI_Group graph_group;
+    MPI_Comm_group(topo_in_->get_comm(), &graph_group);
+    auto add_chunks = [=](const int nchunks, const MemChunk *chunks, int *weight) {
+        int *rank = reinterpret_cast<int *>(m_calloc(m_max(nchunks, 1) * sizeof(int)));
+        ChunksDestRankInGroup(graph_group, nchunks, chunks, rank);
+        for (int ic = 0; ic < nchunks; ++ic) {
+            const MemChunk *cchunk = chunks + ic;
+            FLUPS_CHECK(rank[ic] != MPI_UNDEFINED, "the destination rank %d of the chunk is not in the graph", cchunk->dest_rank);
+            weight[rank[ic]] += cchunk->isize[0] * cchunk->isize[1] * cchunk->isize[2];
+        }
+        m_free(rank);
+    };
+    add_chunks(i2o_nchunks, i2o_chunks, destsW);
+    add_chunks(o2i_nchunks, o2i_chunks, sourcesW);
+    MPI_Group_free(&graph_group);
+
+    if (!is_setup) {
+        for (int ic = 0; ic < i2o_nchunks; ++ic) {
+            FreeChunkMPIDataType(i2o_chunks + ic);
+        }
+        for (int ic = 0; ic < o2i_nchunks; ++ic) {
+            FreeChunkMPIDataType(o2i_chunks + ic);
+        }
+        m_free(i2o_chunks);
+        m_free(o2i_chunks);
+    }
+    // Note: by counting the edges like this on every process, we actually obtain
+    // twice the number of edges in the total final graph, as the in and out edges
+    // between 2 processes have been accounted by both procs. However, the weight
+    // is relative so it doesnt matter.
     //--------------------------------------------------------------------------
     END_FUNC;
 }
@@ -102,7 +189,7 @@ void SwitchTopoX::setup() {
  * @param sendData 
  * @param recvData 
  */
-void SwitchTopoX::setup_buffers(opt_double_ptr sendData, opt_double_ptr recvData){
+void SwitchTopoX::setup_buffers(opt_real_ptr sendData, opt_real_ptr recvData){
     BEGIN_FUNC;
     FLUPS_CHECK(this->need_recv_buf() || this->need_recv_buf(),"not needing any buffer is incompatible with the inplace approach");
     //..........................................................................
@@ -144,6 +231,22 @@ void SwitchTopoX::setup_buffers(opt_double_ptr sendData, opt_double_ptr recvData
         PlanShuffleChunk(topo_out_->nf() == 2, o2i_chunks_ + ic);
     }
 
+#if (FLUPS_PACK_TUNING)
+    //..........................................................................
+    // the chunks are packed in the send buffer, choose the fastest way to do it
+    if (need_send) {
+        int nmem[3];
+        if (i2o_nchunks_ > 0) {
+            ChunkNmem(topo_in_, i2o_chunks_, nmem);
+            TuneChunkPack(nmem, i2o_nchunks_, i2o_chunks_);
+        }
+        if (o2i_nchunks_ > 0) {
+            ChunkNmem(topo_out_, o2i_chunks_, nmem);
+            TuneChunkPack(nmem, o2i_nchunks_, o2i_chunks_);
+        }
+    }
+#endif
+
     //..........................................................................
     // we have to update the ranks for each of the i2o_chunks and o2i_chunks
     // the i2o_chunks have for the moment a dest_rank in the outcomm
@@ -152,22 +255,72 @@ void SwitchTopoX::setup_buffers(opt_double_ptr sendData, opt_double_ptr recvData
     MPI_Comm_group(subcomm_, &sub_group);
 
     // replace the old ranks by the newest ones
+    const int i2o_nsub = ChunksToNewComm(subcomm_, sub_group, i2o_nchunks_, i2o_chunks_);
+    FLUPS_CHECK(i2o_nsub == i2o_nchunks_, "only %d chunks out of %d are in the sub comm", i2o_nsub, i2o_nchunks_);
+    const int o2i_nsub = ChunksToNewComm(subcomm_, sub_group, o2i_nchunks_, o2i_chunks_);
+    FLUPS_CHECK(o2i_nsub == o2i_nchunks_, "only %d chunks out of %d are in the sub comm", o2i_nsub, o2i_nchunks_);
+    // free the allocated array
+    MPI_Group_free(&sub_group);
+
+    //..........................................................................
+    // the chunk we send to ourselves does not go through MPI, the backends directly copy it in the matching chunk
     for (int ic = 0; ic < i2o_nchunks_; ++ic) {
-        bool is_in_sub;
-        ChunkToNewComm(subcomm_, sub_group, i2o_chunks_ + ic, &is_in_sub);
-        FLUPS_CHECK(is_in_sub, "the rank %d is not in the sub comm", i2o_chunks_[ic].dest_rank);
+        if (i2o_chunks_[ic].dest_rank == sub_rank) i2o_selfcomm_ = ic;
     }
     for (int ic = 0; ic < o2i_nchunks_; ++ic) {
-        bool is_in_sub;
-        ChunkToNewComm(subcomm_, sub_group, o2i_chunks_ + ic, &is_in_sub);
-        FLUPS_CHECK(is_in_sub, "the rank %d is not in the sub comm", i2o_chunks_[ic].dest_rank);
+        if (o2i_chunks_[ic].dest_rank == sub_rank) o2i_selfcomm_ = ic;
     }
-    // free the allocated array
-    MPI_Group_free(&sub_group);
+    FLUPS_CHECK((i2o_selfcomm_ < 0) == (o2i_selfcomm_ < 0), "the self communication must exist in both directions: %d vs %d", i2o_selfcomm_, o2i_selfcomm_);
     //--------------------------------------------------------------------------
     END_FUNC;
 }
 
+/**
+ * @brief sends the chunks as floats if asked by @ref set_floatTransport
+ *
+ * The self communication is not sent and remains in double. Must be called by the backends that pack every chunk with
+ * CopyData2Chunk() and shuffle every received chunk with DoShuffleChunk(), once the chunks have their memory and before
+ * the message sizes are used.
+ */
+void SwitchTopoX::setup_floatTransport_() {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    // the single precision data is already sent as floats
+    if (!is_float_ || FLUPS_SINGLE_PREC) {
+        END_FUNC;
+        return;
+    }
+    for (int ic = 0; ic < i2o_nchunks_; ++ic) {
+        if (ic != i2o_selfcomm_) ChunkToFloatTransport(i2o_chunks_ + ic);
+    }
+    for (int ic = 0; ic < o2i_nchunks_; ++ic) {
+        if (ic != o2i_selfcomm_) ChunkToFloatTransport(o2i_chunks_ + ic);
+    }
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief returns the local estimate of the relative error due to the float transport during the last forward and backward executions
+ *
+ * The error of a direction is the max relative error of its chunks, the errors of the two directions are added.
+ */
+double SwitchTopoX::get_transportError() const {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    double i2o_err = 0.0;
+    double o2i_err = 0.0;
+    for (int ic = 0; ic < i2o_nchunks_; ++ic) {
+        if (i2o_chunks_[ic].is_float) i2o_err = m_max(i2o_err, i2o_chunks_[ic].float_err);
+    }
+    for (int ic = 0; ic < o2i_nchunks_; ++ic) {
+        if (o2i_chunks_[ic].is_float) o2i_err = m_max(o2i_err, o2i_chunks_[ic].float_err);
+    }
+    //--------------------------------------------------------------------------
+    END_FUNC;
+    return i2o_err + o2i_err;
+}
+
 /**
  * @brief returns the communication buffer as the max between i2o and o2i
  *
@@ -214,9 +367,11 @@ size_t SwitchTopoX::get_bufMemSize() const {
  * We here find the colors of the comm, i.e. ranks communicating together have the same color.
  * Once the color are known, we divide the current communicator into subcomms.
  *
+ * If every rank exchanges with the same ranks as in a subcommunicator of the cache, the subcommunicator is duplicated instead.
  *
+ * @param cache the cache of the subcommunicators (can be NULL)
  */
-void SwitchTopoX::SubCom_SplitComm() {
+void SwitchTopoX::SubCom_SplitComm(SubCommCache *cache) {
     BEGIN_FUNC;
     //--------------------------------------------------------------------------
     // get my rank and use-it as the initial color
@@ -244,6 +399,13 @@ void SwitchTopoX::SubCom_SplitComm() {
     //-------------------------------------------------------------------------
     /** - Set the starting color and determine who I wish to get in my group */
     //-------------------------------------------------------------------------
+    // the chunks are first expressed in the input communicator, the output one might have its ranks reordered
+    MPI_Group in_group;
+    MPI_Comm_group(inComm_, &in_group);
+    const int n_in_comm = ChunksToNewComm(inComm_, in_group, i2o_nchunks_, i2o_chunks_);
+    FLUPS_CHECK(n_in_comm == i2o_nchunks_, "the destination of the chunks must be in the input communicator");
+    MPI_Group_free(&in_group);
+
     // allocate colors and inMyGroup array
     int*  colors    = (int*)m_calloc(comm_size * sizeof(int));
     bool* inMyGroup = (bool*)m_calloc(comm_size * sizeof(bool));
@@ -267,6 +429,27 @@ void SwitchTopoX::SubCom_SplitComm() {
         inMyGroup[chunk_dest_rank] = true;
     }
 
+    //-------------------------------------------------------------------------
+    /** - reuse a known subcomm if every rank exchanges with the same ranks, the entry must be the same on every rank */
+    //-------------------------------------------------------------------------
+    std::vector<int> partners;
+    if (cache != NULL) {
+        for (int ir = 0; ir < comm_size; ir++) {
+            if (inMyGroup[ir]) partners.push_back(ir);
+        }
+        const int id     = cache->find(inComm_, partners);
+        int       idr[2] = {id, -id};
+        MPI_Allreduce(MPI_IN_PLACE, idr, 2, MPI_INT, MPI_MIN, inComm_);
+        if (idr[0] >= 0 && idr[0] == -idr[1]) {
+            FLUPS_INFO("the subcomm %d of the cache is reused", id);
+            MPI_Comm_dup(cache->subcomm(id), &subcomm_);
+            m_free(colors);
+            m_free(inMyGroup);
+            END_FUNC;
+            return;
+        }
+    }
+
     //-------------------------------------------------------------------------
     /** - count how much ranks are in my group and assumes they don't have the same color as I do */
     //-------------------------------------------------------------------------
@@ -346,6 +529,9 @@ void SwitchTopoX::SubCom_SplitComm() {
 #endif
         }
     }
+    if (cache != NULL) {
+        cache->add(inComm_, partners, subcomm_);
+    }
     // free the vectors
     m_free(colors);
     m_free(inMyGroup);
@@ -353,6 +539,62 @@ void SwitchTopoX::SubCom_SplitComm() {
     END_FUNC;
 }
 
+SubCommCache::~SubCommCache() {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    for (size_t ie = 0; ie < entries_.size(); ++ie) {
+        MPI_Group_free(&entries_[ie].in_group);
+        MPI_Comm_free(&entries_[ie].subcomm);
+    }
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief returns the id of the subcomm split from the same group of ranks, in which I exchange with the given partners
+ *
+ * @param in_comm the communicator to split
+ * @param partners the ranks of in_comm exchanging chunks with me, in increasing order
+ * @return int the id of the subcomm, -1 if none matches
+ */
+int SubCommCache::find(MPI_Comm in_comm, const std::vector<int> &partners) const {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    MPI_Group in_group;
+    MPI_Comm_group(in_comm, &in_group);
+    int id = -1;
+    for (size_t ie = 0; ie < entries_.size() && id < 0; ++ie) {
+        if (entries_[ie].partners != partners) continue;
+        // the ranks must be the same and in the same order
+        int comp;
+        MPI_Group_compare(entries_[ie].in_group, in_group, &comp);
+        if (comp == MPI_IDENT) id = (int)ie;
+    }
+    MPI_Group_free(&in_group);
+    //--------------------------------------------------------------------------
+    END_FUNC;
+    return id;
+}
+
+/**
+ * @brief adds a duplicate of the subcomm to the cache
+ *
+ * @param in_comm the communicator which has been split
+ * @param partners the ranks of in_comm exchanging chunks with me, in increasing order
+ * @param subcomm the subcomm
+ */
+void SubCommCache::add(MPI_Comm in_comm, const std::vector<int> &partners, MPI_Comm subcomm) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    Entry entry;
+    MPI_Comm_group(in_comm, &entry.in_group);
+    entry.partners = partners;
+    MPI_Comm_dup(subcomm, &entry.subcomm);
+    entries_.push_back(entry);
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
 
 void SwitchTopoX::print_info() const {
     BEGIN_FUNC;
@@ -392,8 +634,23 @@ void SwitchTopoX::print_info() const {
     }  min_size_i2ochunks,min_size_o2ichunks,\
       loc_min_size_i2ochunk, loc_min_size_o2ichunk;
 
+    // number of chunks packed with each strategy
+    int loc_npack_i2ochunk[n_chunk_pack] = {0};
+    int loc_npack_o2ichunk[n_chunk_pack] = {0};
+    int ttl_npack_i2ochunks[n_chunk_pack];
+    int ttl_npack_o2ichunks[n_chunk_pack];
+    // number of chunks without shuffle
+    int loc_nid_i2ochunk = 0, ttl_nid_i2ochunks;
+    int loc_nid_o2ichunk = 0, ttl_nid_o2ichunks;
+    // number of chunks received directly in the memory with their datatype
+    int loc_nmpi_i2ochunk = 0, ttl_nmpi_i2ochunks;
+    int loc_nmpi_o2ichunk = 0, ttl_nmpi_o2ichunks;
+
     for (int ir = 0; ir < i2o_nchunks_; ++ir) {
         MemChunk      *cchunk = i2o_chunks_ + ir;
+        loc_npack_i2ochunk[cchunk->pack] += 1;
+        loc_nid_i2ochunk += cchunk->is_identity;
+        loc_nmpi_i2ochunk += (cchunk->unpack == CHUNK_UNPACK_MPI);
         loc_ttl_size_i2ochunk += cchunk->size_padded * cchunk->nda;
         loc_max_size_i2ochunk.val  =  std::max((cchunk->size_padded * cchunk->nda), loc_max_size_i2ochunk.val);
         loc_min_size_i2ochunk.val  =  std::min((cchunk->size_padded * cchunk->nda), loc_min_size_i2ochunk.val);
@@ -404,6 +661,9 @@ void SwitchTopoX::print_info() const {
     
     for (int ir = 0; ir < o2i_nchunks_; ++ir) {
         MemChunk      *cchunk = o2i_chunks_ + ir;
+        loc_npack_o2ichunk[cchunk->pack] += 1;
+        loc_nid_o2ichunk += cchunk->is_identity;
+        loc_nmpi_o2ichunk += (cchunk->unpack == CHUNK_UNPACK_MPI);
         loc_ttl_size_o2ichunk += cchunk->size_padded * cchunk->nda;
         loc_max_size_o2ichunk.val  = std::max((cchunk->size_padded * cchunk->nda), loc_max_size_o2ichunk.val);
         loc_min_size_o2ichunk.val  = std::min((cchunk->size_padded * cchunk->nda), loc_min_size_o2ichunk.val);
@@ -438,6 +698,13 @@ void SwitchTopoX::print_info() const {
         MPI_Reduce(&loc_ttl_size_o2ichunk, &ttl_size_o2ichunks, 1, MPI_LONG, MPI_SUM, 0, inComm_);
         MPI_Reduce(&loc_max_size_o2ichunk, &max_size_o2ichunks, 1, MPI_LONG_INT, MPI_MAXLOC, 0, inComm_);
         MPI_Reduce(&loc_min_size_o2ichunk, &min_size_o2ichunks, 1, MPI_LONG_INT, MPI_MINLOC, 0, inComm_);
+
+        MPI_Reduce(loc_npack_i2ochunk, ttl_npack_i2ochunks, n_chunk_pack, MPI_INT, MPI_SUM, 0, inComm_);
+        MPI_Reduce(loc_npack_o2ichunk, ttl_npack_o2ichunks, n_chunk_pack, MPI_INT, MPI_SUM, 0, inComm_);
+        MPI_Reduce(&loc_nid_i2ochunk, &ttl_nid_i2ochunks, 1, MPI_INT, MPI_SUM, 0, inComm_);
+        MPI_Reduce(&loc_nid_o2ichunk, &ttl_nid_o2ichunks, 1, MPI_INT, MPI_SUM, 0, inComm_);
+        MPI_Reduce(&loc_nmpi_i2ochunk, &ttl_nmpi_i2ochunks, 1, MPI_INT, MPI_SUM, 0, inComm_);
+        MPI_Reduce(&loc_nmpi_o2ichunk, &ttl_nmpi_o2ichunks, 1, MPI_INT, MPI_SUM, 0, inComm_);
     }
     
     if(rank_world == 0){
@@ -455,7 +722,7 @@ void SwitchTopoX::print_info() const {
         FILE *file = fopen(name.c_str(), "a+");
 
         // Print the information
-        fprintf(file,"Switchtopo %d - from axis in = %d to axis out = %d -- total number of ranks = %d\n", idswitchtopo_, topo_in_->axis(), topo_out_->axis(), size_world);
+        fprintf(file,"Switchtopo %d - from axis in = %d to axis out = %d -- total number of ranks = %d -- backend = %s\n", idswitchtopo_, topo_in_->axis(), topo_out_->axis(), size_world, SwitchTopoX_name(switch_type()));
         fprintf(file, "-----------------------------------------------------------------------------------------------------\n");
         fprintf(file,"Topo in: lda   = %d -- iscomplex = %d\n", topo_in_->lda(), topo_in_->isComplex());
         fprintf(file,"         nglob = %d %d %d \n", topo_in_->nglob(0), topo_in_->nglob(1), topo_in_->nglob(2));
@@ -477,6 +744,11 @@ void SwitchTopoX::print_info() const {
         fprintf(file, "mean  chunk size in the input topo = %lu \n", ttl_size_i2ochunks/ttl_ni2ochunks);
         fprintf(file, "max   chunk size in the input topo = %lu belongs to rank %d in Comm_WORLD \n", max_size_i2ochunks.val, max_size_i2ochunks.rank);
         fprintf(file, "min   chunk size in the input topo = %lu belongs to rank %d in Comm_WORLD \n", min_size_i2ochunks.val, min_size_i2ochunks.rank);
+        fprintf(file, "\n");
+        fprintf(file, "packing of the chunks in the input topo: %s = %d, %s = %d, %s = %d \n", ChunkPackName(CHUNK_PACK_MEMCPY), ttl_npack_i2ochunks[CHUNK_PACK_MEMCPY],
+                ChunkPackName(CHUNK_PACK_MPI), ttl_npack_i2ochunks[CHUNK_PACK_MPI], ChunkPackName(CHUNK_PACK_STREAM), ttl_npack_i2ochunks[CHUNK_PACK_STREAM]);
+        fprintf(file, "number of chunks without shuffle in the input topo = %d \n", ttl_nid_i2ochunks);
+        fprintf(file, "unpacking of the chunks in the input topo: shuffle = %d, MPI datatype = %d \n", ttl_ni2ochunks - ttl_nmpi_i2ochunks, ttl_nmpi_i2ochunks);
         fprintf(file, "-----------------------------------------------------------------------------------------------------\n");
         fprintf(file, "total  number of chunks in the output topo = %d \n", ttl_no2ichunks);
         fprintf(file, "mean  number of chunks in the output topo = %d \n", ttl_no2ichunks/size_world);
@@ -486,10 +758,141 @@ void SwitchTopoX::print_info() const {
         fprintf(file, "mean  chunk size in the output topo = %lu \n", ttl_size_o2ichunks/ttl_no2ichunks);
         fprintf(file, "max   chunk size in the output topo = %lu belongs to rank %d in Comm_WORLD \n", max_size_o2ichunks.val, max_size_o2ichunks.rank);
         fprintf(file, "min   chunk size in the output topo = %lu belongs to rank %d in Comm_WORLD \n", min_size_o2ichunks.val, min_size_o2ichunks.rank);
+        fprintf(file, "\n");
+        fprintf(file, "packing of the chunks in the output topo: %s = %d, %s = %d, %s = %d \n", ChunkPackName(CHUNK_PACK_MEMCPY), ttl_npack_o2ichunks[CHUNK_PACK_MEMCPY],
+                ChunkPackName(CHUNK_PACK_MPI), ttl_npack_o2ichunks[CHUNK_PACK_MPI], ChunkPackName(CHUNK_PACK_STREAM), ttl_npack_o2ichunks[CHUNK_PACK_STREAM]);
+        fprintf(file, "number of chunks without shuffle in the output topo = %d \n", ttl_nid_o2ichunks);
+        fprintf(file, "unpacking of the chunks in the output topo: shuffle = %d, MPI datatype = %d \n", ttl_no2ichunks - ttl_nmpi_o2ichunks, ttl_nmpi_o2ichunks);
         fclose(file);
     }
     
     MPI_Barrier(inComm_);
     //--------------------------------------------------------------------------
     END_FUNC;
-}
\ No newline at end of file
+}
+/**
+ * @brief creates a new switchtopo using the given communication backend
+ *
+ * @param type the backend, SWITCH_DEFAULT gives the one chosen at compilation (SWITCH_AUTO is not accepted)
+ */
+SwitchTopoX *SwitchTopoX_new(const SwitchType type, const Topology *topo_in, const Topology *topo_out, const int shift[3], H3LPR::Profiler *prof) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    const SwitchType ctype = (type == SWITCH_DEFAULT) ? FLUPS_DEFAULT_COMM : type;
+    FLUPS_CHECK(ctype != SWITCH_AUTO, "the auto selection must be resolved before the creation of the switchtopo");
+    // on a single rank there is nothing to communicate, whatever the requested backend
+    int comm_size;
+    MPI_Comm_size(topo_in->get_comm(), &comm_size);
+    SwitchTopoX *switchtopo = NULL;
+    if (comm_size == 1) {
+        switchtopo = new SwitchTopoX_self(topo_in, topo_out, shift, prof);
+    } else {
+        switch (ctype) {
+            case SWITCH_NB:
+                switchtopo = new SwitchTopoX_nb(topo_in, topo_out, shift, prof);
+                break;
+            case SWITCH_ISR:
+                switchtopo = new SwitchTopoX_isr(topo_in, topo_out, shift, prof);
+                break;
+            case SWITCH_RMA:
+                switchtopo = new SwitchTopoX_rma(topo_in, topo_out, shift, prof);
+                break;
+            case SWITCH_A2AW:
+                switchtopo = new SwitchTopoX_a2a(topo_in, topo_out, shift, prof, true);
+                break;
+            case SWITCH_SELF:
+                switchtopo = new SwitchTopoX_self(topo_in, topo_out, shift, prof);
+                break;
+            default:
+                switchtopo = new SwitchTopoX_a2a(topo_in, topo_out, shift, prof);
+                break;
+        }
+    }
+    //--------------------------------------------------------------------------
+    END_FUNC;
+    return switchtopo;
+}
+
+/**
+ * @brief returns true if the switch from topo_in to topo_out does not move any data between the ranks
+ *
+ * This is the case if every rank sends its whole block to itself and receives its whole block from itself, i.e. if the
+ * switchtopo reduces to a local transpose (see SwitchTopoX_self). As in SwitchTopoX::PopulateChunks_, the input topology
+ * is considered as complex if the output one is. This function is collective on the communicator of topo_in.
+ *
+ * @param topo_in the input topology
+ * @param topo_out the output topology
+ * @param shift the position of the input topology in the output one
+ */
+bool SwitchTopoX_isLocal(const Topology *topo_in, const Topology *topo_out, const int shift[3]) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    int tmp_nglob[3], tmp_nproc[3], tmp_axproc[3];
+    for (int i = 0; i < 3; i++) {
+        tmp_nglob[i]  = topo_in->nglob(i);
+        tmp_nproc[i]  = topo_in->nproc(i);
+        tmp_axproc[i] = topo_in->axproc(i);
+    }
+    // the input topo might have idle ranks if it has been built by the solver
+    Topology *topo_in_tmp = new Topology(topo_in->axis(), topo_in->lda(), tmp_nglob, tmp_nproc, topo_in->isComplex(), tmp_axproc, FLUPS_ALIGNMENT, topo_in->get_comm(), true);
+    if (topo_out->isComplex() && !topo_in->isComplex()) {
+        topo_in_tmp->switch2complex();
+    }
+
+    // my block in both topologies, intersected with the other topology, must be the same
+    int is_local = true;
+    for (int id = 0; id < 3; ++id) {
+        const int in_start  = topo_in_tmp->cmpt_start_id(id) + shift[id];
+        const int in_end    = in_start + topo_in_tmp->nloc(id);
+        const int out_start = topo_out->cmpt_start_id(id);
+        const int out_end   = out_start + topo_out->nloc(id);
+        const int i2o_start = m_max(in_start, 0);
+        const int i2o_end   = m_min(in_end, topo_out->nglob(id));
+        const int o2i_start = m_max(out_start, shift[id]);
+        const int o2i_end   = m_min(out_end, topo_in_tmp->nglob(id) + shift[id]);
+        is_local            = is_local && (i2o_start < i2o_end) && (i2o_start == o2i_start) && (i2o_end == o2i_end);
+    }
+    delete (topo_in_tmp);
+    MPI_Allreduce(MPI_IN_PLACE, &is_local, 1, MPI_INT, MPI_LAND, topo_in->get_comm());
+    //--------------------------------------------------------------------------
+    END_FUNC;
+    return is_local;
+}
+
+/**
+ * @brief returns the name of a communication backend
+ */
+const char *SwitchTopoX_name(const SwitchType type) {
+    switch (type) {
+        case SWITCH_A2A:
+            return "a2a";
+        case SWITCH_A2AW:
+            return "a2aw";
+        case SWITCH_NB:
+            return "nb";
+        case SWITCH_ISR:
+            return "isr";
+        case SWITCH_RMA:
+            return "rma";
+        case SWITCH_AUTO:
+            return "auto";
+        case SWITCH_SELF:
+            return "self";
+        default:
+            return "default";
+    }
+}
+
+/**
+ * @brief returns the communication backend from its name, SWITCH_DEFAULT if the name is not recognized
+ */
+SwitchType SwitchTopoX_type(const char *name) {
+    const SwitchType types[6] = {SWITCH_A2A, SWITCH_A2AW, SWITCH_NB, SWITCH_ISR, SWITCH_RMA, SWITCH_AUTO};
+    for (int it = 0; it < 6; ++it) {
+        if (strcmp(name, SwitchTopoX_name(types[it])) == 0) return types[it];
+    }
+    if (strcmp(name, "default") != 0) {
+        FLUPS_WARNING("unknown communication backend %s, using the default one", name);
+    }
+    return SWITCH_DEFAULT;
+}
@@ -11,6 +11,31 @@
 #include "defines.hpp"
 #include "chunk_tools.hpp"
 
+#include <vector>
+
+/**
+ * @brief The subcommunicators created by the setup of the switchtopos, reused by the switchtopos exchanging with the same ranks
+ *
+ * The subcommunicator of a switchtopo only depends on the ranks every rank exchanges chunks with.
+ * If they match the ones of a previous switchtopo on every rank (e.g. between the field and the Green's function switchtopos),
+ * the known subcommunicator is duplicated instead of running the iterative coloring and the split again.
+ */
+class SubCommCache {
+    struct Entry {
+        MPI_Group        in_group;  //!< the group of the communicator which has been split
+        std::vector<int> partners;  //!< the ranks of in_group exchanging chunks with me, in increasing order
+        MPI_Comm         subcomm;   //!< a duplicate of the subcommunicator
+    };
+    std::vector<Entry> entries_;
+
+   public:
+    ~SubCommCache();
+
+    int      find(MPI_Comm in_comm, const std::vector<int> &partners) const;
+    MPI_Comm subcomm(const int id) const { return entries_[id].subcomm; }
+    void     add(MPI_Comm in_comm, const std::vector<int> &partners, MPI_Comm subcomm);
+};
+
 /**
  * @brief More efficient implementation of the SwitchTopo
  *
@@ -33,40 +58,67 @@ class SwitchTopoX {
     MemChunk *i2o_chunks_ = NULL;  //!< the local chunks of memory in the output topology
     MemChunk *o2i_chunks_ = NULL;  //!< the local chunks of memory in the output topology
 
-    // int i2o_selfcomm_ = -1; //!< Index of the self communication chunk (remains at -1 if there is no self communication)
-    // int o2i_selfcomm_ = -1; //!< Index of the self communication chunk (remains at -1 if there is no self communication)
+    int i2o_selfcomm_ = -1;  //!< Index of the self communication chunk (remains at -1 if there is no self communication)
+    int o2i_selfcomm_ = -1;  //!< Index of the self communication chunk (remains at -1 if there is no self communication)
 
-    opt_double_ptr send_buf_ = NULL; /**<@brief The send buffer for MPI send */
-    opt_double_ptr recv_buf_ = NULL; /**<@brief The recv buffer for MPI recv */
+    opt_real_ptr send_buf_ = NULL; /**<@brief The send buffer for MPI send */
+    opt_real_ptr recv_buf_ = NULL; /**<@brief The recv buffer for MPI recv */
 
-    fftw_plan *i2o_shuffle_ = NULL;  //!< FFTW plan to shuffle the indexes around from the input topo to the output topo
-    fftw_plan *o2i_shuffle_ = NULL;  //!< FFTW plan to shuffle the indexes around from the input topo to the ouput topo
+    FLUPS_FFTW(plan) *i2o_shuffle_ = NULL;  //!< FFTW plan to shuffle the indexes around from the input topo to the output topo
+    FLUPS_FFTW(plan) *o2i_shuffle_ = NULL;  //!< FFTW plan to shuffle the indexes around from the input topo to the ouput topo
 
     H3LPR::Profiler *prof_         = NULL;
     int              idswitchtopo_ = -1;
 
+    bool is_float_ = false;  //!< true if the chunks are sent as floats, if supported by the backend (see setup_floatTransport_)
+
    public:
     explicit SwitchTopoX(const Topology *topo_in, const Topology *topo_out, const int shift[3], H3LPR::Profiler *prof);
     virtual ~SwitchTopoX();
 
     virtual bool need_send_buf()const  = 0;
     virtual bool need_recv_buf()const  = 0;
+    virtual SwitchType switch_type()const  = 0;
+
+    const Topology *topo_in() const { return topo_in_; }
+    const Topology *topo_out() const { return topo_out_; }
+    const int      *shift() const { return i2o_shift_; }
+
+    /**
+     * @brief sends the chunks as floats, must be called before @ref setup_buffers
+     */
+    void   set_floatTransport(const bool is_float) { is_float_ = is_float; }
+    double get_transportError() const;
 
     // abstract functions
-    void setup();
+    virtual void setup(SubCommCache *cache = NULL);
     virtual void print_info() const;
-    virtual void setup_buffers(opt_double_ptr sendData, opt_double_ptr recvData);
-    virtual void execute(opt_double_ptr data, const int sign) const = 0;
+    virtual void setup_buffers(opt_real_ptr sendData, opt_real_ptr recvData);
+    virtual void execute(opt_real_ptr data, const int sign) const = 0;
     virtual void disp() const                                       = 0;
     
 
+    void add_toGraph(int *sourcesW, int *destsW) const;
+
     size_t get_bufMemSize() const;
     size_t get_ChunkArraysMemSize(const int lda, const int nchunks, const MemChunk *chunks) const;
 
    protected:
-    void SubCom_SplitComm();
+    void PopulateChunks_(int *i2o_nchunks, MemChunk **i2o_chunks, int *o2i_nchunks, MemChunk **o2i_chunks) const;
+    void SubCom_SplitComm(SubCommCache *cache);
+    void setup_floatTransport_();
     // void SubCom_UpdateRanks();
     // setup_subComm_(const int nBlock, const int lda, int *blockSize[3], int *destRank, int **count, int **start);
 };
 
+/**
+ * @name Backend registry
+ * @{
+ */
+SwitchTopoX *SwitchTopoX_new(const SwitchType type, const Topology *topo_in, const Topology *topo_out, const int shift[3], H3LPR::Profiler *prof);
+const char  *SwitchTopoX_name(const SwitchType type);
+SwitchType   SwitchTopoX_type(const char *name);
+bool         SwitchTopoX_isLocal(const Topology *topo_in, const Topology *topo_out, const int shift[3]);
+/**@} */
+
 #endif  // SWITCHTOPOX_HPP_
\ No newline at end of file
@@ -5,17 +5,33 @@
 */
 #include "SwitchTopoX_a2a.hpp"
 
-void All2Allv(MemChunk *send_chunks, const int *count_send, const int *disp_send,
-              MemChunk *recv_chunks, const int *count_recv, const int *disp_recv, 
-              opt_double_ptr send_buf, opt_double_ptr recv_buf, MPI_Request* all2all_rqst, MPI_Comm subcomm,
-              const Topology *topo_in, const Topology *topo_out, opt_double_ptr mem, H3LPR::Profiler* prof);
+void All2Allv(const int n_send_chunk, MemChunk *send_chunks, const a2a_count_t *count_send, const a2a_disp_t *disp_send, const MPI_Datatype *dtype_send, const MPI_Datatype *mem_dtype_send,
+              const int n_recv_chunk, MemChunk *recv_chunks, const a2a_count_t *count_recv, const a2a_disp_t *disp_recv, const MPI_Datatype *dtype_recv,
+              const int self_send, const int self_recv, const int n_round,
+              opt_real_ptr send_buf, opt_real_ptr recv_buf, MPI_Request* all2all_rqst, MPI_Comm subcomm,
+              const Topology *topo_in, const Topology *topo_out, opt_real_ptr mem, H3LPR::Profiler* prof);
 
-void PrintCountArr(const std::string filename, const int* count_arr, int array_size, MPI_Comm incomm);
+void PrintCountArr(const std::string filename, const size_t* count_arr, int array_size, MPI_Comm incomm);
 
-void PrintCountArr(const std::string filename, const int* count_arr, int array_size, MPI_Comm incomm);
+/**
+ * @brief returns the round of the all_to_all_v in which the rank exchanges with the peer
+ *
+ * the round only depends on the distance between the two ranks on the ring of the subcomm,
+ * so that two ranks send and receive to/from each other in the same round, in both directions
+ *
+ * @param rank the current rank
+ * @param peer the other rank, != rank
+ * @param size the size of the communicator
+ * @param n_round the number of rounds, <= size/2
+ */
+static inline int a2a_round(const int rank, const int peer, const int size, const int n_round) {
+    const int shift = (peer - rank + size) % size;
+    const int dist  = m_min(shift, size - shift);
+    return ((dist - 1) * n_round) / (size / 2);
+}
 
-SwitchTopoX_a2a::SwitchTopoX_a2a(const Topology *topo_in, const Topology *topo_out, const int shift[3], H3LPR::Profiler *prof)
-    : SwitchTopoX(topo_in, topo_out, shift, prof) {
+SwitchTopoX_a2a::SwitchTopoX_a2a(const Topology *topo_in, const Topology *topo_out, const int shift[3], H3LPR::Profiler *prof, const bool is_zerocopy)
+    : SwitchTopoX(topo_in, topo_out, shift, prof), is_zerocopy_(is_zerocopy) {
     BEGIN_FUNC;
     //--------------------------------------------------------------------------
     // nothing special to do here
@@ -23,58 +39,139 @@ SwitchTopoX_a2a::SwitchTopoX_a2a(const Topology *topo_in, const Topology *topo_o
     END_FUNC;
 }
 
-void SwitchTopoX_a2a::setup_buffers(opt_double_ptr sendData, opt_double_ptr recvData) {
+void SwitchTopoX_a2a::setup_buffers(opt_real_ptr sendData, opt_real_ptr recvData) {
     BEGIN_FUNC;
     //--------------------------------------------------------------------------
     // first setup the basic stuffs
     this->SwitchTopoX::setup_buffers(sendData, recvData);
+    // the zero-copy variant does not pack the chunks, they remain in double
+    if (!is_zerocopy_) setup_floatTransport_();
 
     // Retrieve MPI information for the subcomm
     int sub_rank, sub_size;
     MPI_Comm_rank(subcomm_, &sub_rank);
     MPI_Comm_size(subcomm_, &sub_size);
 
+    //..........................................................................
+    // get the number of rounds: each rank sends about FLUPS_MPI_A2A_ROUND_SIZE bytes per round.
+    // As every round is a collective, all the ranks of the subcomm must agree on it
+    unsigned long send_size = 0;
+    for (int ic = 0; ic < i2o_nchunks_; ++ic) {
+        if (ic != i2o_selfcomm_) send_size += get_ChunkMsgSize(i2o_chunks_ + ic) * sizeof(flups_real);
+    }
+    unsigned long recv_size = 0;
+    for (int ic = 0; ic < o2i_nchunks_; ++ic) {
+        if (ic != o2i_selfcomm_) recv_size += get_ChunkMsgSize(o2i_chunks_ + ic) * sizeof(flups_real);
+    }
+    unsigned long max_size = m_max(send_size, recv_size);
+    MPI_Allreduce(MPI_IN_PLACE, &max_size, 1, MPI_UNSIGNED_LONG, MPI_MAX, subcomm_);
+    const unsigned long round_size = FLUPS_MPI_A2A_ROUND_SIZE;
+    n_round_ = (int)m_min((max_size + round_size - 1) / round_size, (unsigned long)FLUPS_MPI_A2A_MAX_ROUND);
+    // a round contains at least the two ranks at a given distance
+    n_round_ = m_max(m_min(n_round_, sub_size / 2), 1);
+    FLUPS_INFO("the all to all is done in %d rounds (max %lu bytes per rank)", n_round_, max_size);
+
     //..........................................................................
     // Allocate the arrays needed by MPI_all2allv
-    i2o_count_ = reinterpret_cast<int *>(m_calloc(sub_size * sizeof(int)));
-    i2o_disp_  = reinterpret_cast<int *>(m_calloc(sub_size * sizeof(int)));
-    o2i_count_ = reinterpret_cast<int *>(m_calloc(sub_size * sizeof(int)));
-    o2i_disp_  = reinterpret_cast<int *>(m_calloc(sub_size * sizeof(int)));
+    i2o_count_ = reinterpret_cast<a2a_count_t *>(m_calloc(n_round_ * sub_size * sizeof(a2a_count_t)));
+    i2o_disp_  = reinterpret_cast<a2a_disp_t *>(m_calloc(sub_size * sizeof(a2a_disp_t)));
+    o2i_count_ = reinterpret_cast<a2a_count_t *>(m_calloc(n_round_ * sub_size * sizeof(a2a_count_t)));
+    o2i_disp_  = reinterpret_cast<a2a_disp_t *>(m_calloc(sub_size * sizeof(a2a_disp_t)));
+    std::memset(i2o_count_, 0, n_round_ * sub_size * sizeof(a2a_count_t));
+    std::memset(i2o_disp_, 0, sub_size * sizeof(a2a_disp_t));
+    std::memset(o2i_count_, 0, n_round_ * sub_size * sizeof(a2a_count_t));
+    std::memset(o2i_disp_, 0, sub_size * sizeof(a2a_disp_t));
+
+#if (FLUPS_MPI_LARGE_COUNT)
+    const bool is_large = is_zerocopy_;
+#else
+    //..........................................................................
+    // the counts and the displacements must fit in an int, otherwise we switch to MPI_Ialltoallw with derived datatypes.
+    // As the collective must match, all the ranks of the subcomm take the same decision
+    int is_large_int = is_zerocopy_;
+    for (int ic = 0; ic < i2o_nchunks_; ++ic) {
+        const size_t end = (i2o_chunks_[ic].data - send_buf_) + i2o_chunks_[ic].size_padded * i2o_chunks_[ic].nda;
+        is_large_int |= (ic != i2o_selfcomm_) && (end > (size_t)FLUPS_MPI_MAX_COUNT);
+    }
+    for (int ic = 0; ic < o2i_nchunks_; ++ic) {
+        const size_t end = (o2i_chunks_[ic].data - recv_buf_) + o2i_chunks_[ic].size_padded * o2i_chunks_[ic].nda;
+        is_large_int |= (ic != o2i_selfcomm_) && (end > (size_t)FLUPS_MPI_MAX_COUNT);
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &is_large_int, 1, MPI_INT, MPI_LOR, subcomm_);
+    const bool is_large = is_large_int;
+#endif
+    // the zero-copy variant always relies on MPI_Ialltoallw: the buffers are described by datatypes at the absolute address of the chunks
+    // and the memory by the datatype of the chunks, relative to the memory
+    if (is_large) {
+        FLUPS_INFO("using MPI_Ialltoallw (zero-copy? %d)", is_zerocopy_);
+        i2o_dtype_ = reinterpret_cast<MPI_Datatype *>(m_calloc(sub_size * sizeof(MPI_Datatype)));
+        o2i_dtype_ = reinterpret_cast<MPI_Datatype *>(m_calloc(sub_size * sizeof(MPI_Datatype)));
+        for (int ir = 0; ir < sub_size; ++ir) {
+            i2o_dtype_[ir] = FLUPS_MPI_REAL;
+            o2i_dtype_[ir] = FLUPS_MPI_REAL;
+        }
+    }
+    if (is_zerocopy_) {
+        i2o_mem_dtype_ = reinterpret_cast<MPI_Datatype *>(m_calloc(sub_size * sizeof(MPI_Datatype)));
+        o2i_mem_dtype_ = reinterpret_cast<MPI_Datatype *>(m_calloc(sub_size * sizeof(MPI_Datatype)));
+        for (int ir = 0; ir < sub_size; ++ir) {
+            i2o_mem_dtype_[ir] = FLUPS_MPI_REAL;
+            o2i_mem_dtype_[ir] = FLUPS_MPI_REAL;
+        }
+    }
 
     //..........................................................................
     // this is the loop over the input topo and the associated chunks
     // Chunks are organised by rank so we loop over them and compute the counts
     // there is only one chunk per cpu so the displacement is obvious
-    for (int ic = 0; ic < i2o_nchunks_; ++ic) {
-        MemChunk *cchunk = i2o_chunks_ + ic;
-        size_t    count  = cchunk->size_padded * cchunk->nda;
-        int       drank  = cchunk->dest_rank;
-
-        // add the a number of data to the destination rank
-        i2o_count_[drank] = count;
-        i2o_disp_[drank]  = cchunk->data - sendData;
-
-        // do some sanity checks to make sure everything is coherent and that the chunk will write at the correct memory location
-        FLUPS_CHECK(count < std::numeric_limits<int>::max(), "message is too big: %ld vs %d", count, std::numeric_limits<int>::max());
-        FLUPS_CHECK(drank < sub_size, "Destination rank of the chunk should be inside the subcomm %d vs %d", drank, sub_size);
+    // the self communication is not done by MPI, its count remains 0
+    // the count of a rank is only non-zero in the round of the rank
+    auto set_count = [=](const int nchunks, const int self_idx, MemChunk *chunks, opt_real_ptr buf,
+                         a2a_count_t *count_arr, a2a_disp_t *disp_arr, MPI_Datatype *dtype_arr, MPI_Datatype *mem_dtype_arr) {
+        for (int ic = 0; ic < nchunks; ++ic) {
+            if (ic == self_idx) continue;
+            MemChunk *cchunk = chunks + ic;
+            int       drank  = cchunk->dest_rank;
+            FLUPS_CHECK(drank < sub_size, "Destination rank of the chunk should be inside the subcomm %d vs %d", drank, sub_size);
+            const int iround = a2a_round(sub_rank, drank, sub_size, n_round_);
+
+            if (!is_large) {
+                // add the a number of data to the destination rank
+                count_arr[iround * sub_size + drank] = get_ChunkMsgSize(cchunk);
+                disp_arr[drank]  = cchunk->data - buf;
+            } else {
+                // one element of a datatype located at the absolute address of the chunk, used with MPI_BOTTOM
+                // the zero-copy sends the unpadded components: they are received with the datatype skipping the padding
+                MPI_Aint addr;
+                MPI_Get_address(cchunk->data, &addr);
+                int one = 1;
+                if (is_zerocopy_) {
+                    MPI_Type_create_hindexed(1, &one, &addr, cchunk->dest_dtype, dtype_arr + drank);
+                } else {
+                    MPI_Type_create_hindexed(1, &cchunk->msg_count, &addr, cchunk->msg_dtype, dtype_arr + drank);
+                }
+                MPI_Type_commit(dtype_arr + drank);
+                count_arr[iround * sub_size + drank] = 1;
+                disp_arr[drank]                      = 0;
+            }
+            if (is_zerocopy_) {
+                // one element of the chunk datatype located at the offset of the chunk in the memory
+                int      one  = 1;
+                MPI_Aint disp = cchunk->offset * sizeof(flups_real);
+                MPI_Type_create_hindexed(1, &one, &disp, cchunk->dtype, mem_dtype_arr + drank);
+                MPI_Type_commit(mem_dtype_arr + drank);
+            }
+        }
+    };
+    set_count(i2o_nchunks_, i2o_selfcomm_, i2o_chunks_, send_buf_, i2o_count_, i2o_disp_, i2o_dtype_, i2o_mem_dtype_);
+    set_count(o2i_nchunks_, o2i_selfcomm_, o2i_chunks_, recv_buf_, o2i_count_, o2i_disp_, o2i_dtype_, o2i_mem_dtype_);
+
+    i2o_rqst_ = reinterpret_cast<MPI_Request *>(m_calloc(n_round_ * sizeof(MPI_Request)));
+    o2i_rqst_ = reinterpret_cast<MPI_Request *>(m_calloc(n_round_ * sizeof(MPI_Request)));
+    for (int ir = 0; ir < n_round_; ++ir) {
+        i2o_rqst_[ir] = MPI_REQUEST_NULL;
+        o2i_rqst_[ir] = MPI_REQUEST_NULL;
     }
-    for (int ic = 0; ic < o2i_nchunks_; ++ic) {
-        MemChunk *cchunk = o2i_chunks_ + ic;
-        size_t    count  = cchunk->size_padded * cchunk->nda;
-        int       drank  = cchunk->dest_rank;
-
-        o2i_count_[drank] = count;
-        o2i_disp_[drank]  = (cchunk->data - recvData);
-
-        // again here we check that the chunk will write at the correct memory location
-        FLUPS_CHECK(count < std::numeric_limits<int>::max(), "message is too big: %ld vs %d", count, std::numeric_limits<int>::max());
-        FLUPS_CHECK(drank < sub_size, "Destination rank of the chunk should be inside the subcomm %d vs %d", drank, sub_size);
-    }
-    i2o_rqst_  = reinterpret_cast<MPI_Request *>(m_calloc(1 * sizeof(MPI_Request)));    
-    i2o_rqst_[0] = MPI_REQUEST_NULL;
-    
-    o2i_rqst_ = reinterpret_cast<MPI_Request *>(m_calloc(1 * sizeof(MPI_Request)));
-    o2i_rqst_[0] = MPI_REQUEST_NULL;
 
     //--------------------------------------------------------------------------
     END_FUNC;
@@ -85,17 +182,21 @@ SwitchTopoX_a2a::~SwitchTopoX_a2a(){
     //--------------------------------------------------------------------------
     // free the request arrays
     if(i2o_rqst_ != NULL){
-        if (i2o_rqst_[0] != MPI_REQUEST_NULL) {
-            FLUPS_INFO("Freeing i2o rqst");
-            MPI_Request_free(i2o_rqst_);
+        for (int ir = 0; ir < n_round_; ++ir) {
+            if (i2o_rqst_[ir] != MPI_REQUEST_NULL) {
+                FLUPS_INFO("Freeing i2o rqst");
+                MPI_Request_free(i2o_rqst_ + ir);
+            }
         }
         m_free(i2o_rqst_);
     }
 
     if(o2i_rqst_ != NULL){
-        if (o2i_rqst_[0] != MPI_REQUEST_NULL) {
-            FLUPS_INFO("Freeing o2i rqst");
-            MPI_Request_free(o2i_rqst_);
+        for (int ir = 0; ir < n_round_; ++ir) {
+            if (o2i_rqst_[ir] != MPI_REQUEST_NULL) {
+                FLUPS_INFO("Freeing o2i rqst");
+                MPI_Request_free(o2i_rqst_ + ir);
+            }
         }
         m_free(o2i_rqst_);
     }
@@ -105,6 +206,23 @@ SwitchTopoX_a2a::~SwitchTopoX_a2a(){
     m_free(i2o_disp_);
     m_free(o2i_count_);
     m_free(o2i_disp_);
+
+    // free the datatypes of the large counts, if any
+    int sub_size = 0;
+    if (i2o_dtype_ != NULL || o2i_dtype_ != NULL) MPI_Comm_size(subcomm_, &sub_size);
+    for (int ir = 0; ir < sub_size; ++ir) {
+        if (i2o_dtype_[ir] != FLUPS_MPI_REAL) MPI_Type_free(i2o_dtype_ + ir);
+        if (o2i_dtype_[ir] != FLUPS_MPI_REAL) MPI_Type_free(o2i_dtype_ + ir);
+    }
+    if (i2o_dtype_ != NULL) m_free(i2o_dtype_);
+    if (o2i_dtype_ != NULL) m_free(o2i_dtype_);
+    // and the memory datatypes of the zero-copy
+    for (int ir = 0; is_zerocopy_ && ir < sub_size; ++ir) {
+        if (i2o_mem_dtype_[ir] != FLUPS_MPI_REAL) MPI_Type_free(i2o_mem_dtype_ + ir);
+        if (o2i_mem_dtype_[ir] != FLUPS_MPI_REAL) MPI_Type_free(o2i_mem_dtype_ + ir);
+    }
+    if (i2o_mem_dtype_ != NULL) m_free(i2o_mem_dtype_);
+    if (o2i_mem_dtype_ != NULL) m_free(o2i_mem_dtype_);
     //--------------------------------------------------------------------------
     END_FUNC;
 }
@@ -115,19 +233,21 @@ SwitchTopoX_a2a::~SwitchTopoX_a2a(){
  * @param v
  * @param sign
  */
-void SwitchTopoX_a2a::execute(opt_double_ptr v, const int sign) const {
+void SwitchTopoX_a2a::execute(opt_real_ptr v, const int sign) const {
     BEGIN_FUNC;
     //--------------------------------------------------------------------------
     m_profStarti(prof_, "Switchtopo%d_%s", idswitchtopo_, (FLUPS_FORWARD == sign) ? "forward" : "backward");
 
     if (sign == FLUPS_FORWARD) { 
-        All2Allv(i2o_chunks_, i2o_count_, i2o_disp_,
-                 o2i_chunks_, o2i_count_, o2i_disp_,
+        All2Allv(i2o_nchunks_, i2o_chunks_, i2o_count_, i2o_disp_, i2o_dtype_, i2o_mem_dtype_,
+                 o2i_nchunks_, o2i_chunks_, o2i_count_, o2i_disp_, o2i_dtype_,
+                 i2o_selfcomm_, o2i_selfcomm_, n_round_,
                  send_buf_, recv_buf_, i2o_rqst_, subcomm_,
                  topo_in_, topo_out_, v, prof_);
     } else {
-        All2Allv(o2i_chunks_, o2i_count_, o2i_disp_,
-                 i2o_chunks_, i2o_count_, i2o_disp_,
+        All2Allv(o2i_nchunks_, o2i_chunks_, o2i_count_, o2i_disp_, o2i_dtype_, o2i_mem_dtype_,
+                 i2o_nchunks_, i2o_chunks_, i2o_count_, i2o_disp_, i2o_dtype_,
+                 o2i_selfcomm_, i2o_selfcomm_, n_round_,
                  recv_buf_, send_buf_, o2i_rqst_, subcomm_,
                  topo_out_, topo_in_, v, prof_);
     }
@@ -159,30 +279,57 @@ void SwitchTopoX_a2a::disp() const {
 /**
  * @brief process to the Send/Recv operation to go from topo_in to topo_out
  *
- * The indexing of the requests and the chunks is the same
+ * The exchange is split in n_round rounds, each of them being an all2all restricted to a subset of the ranks.
+ * The chunks of a round are packed while the previous rounds are in flight and the chunks of a round are unpacked
+ * as soon as the round completes, while the next ones are still in flight.
+ * As the computation is inplace, the unpacking can only start once all the chunks have been packed.
+ *
+ * The self communication (if any) does not go through MPI: the chunk is directly copied in the shuffled layout
+ * of the matching recv chunk while the all2all is progressing.
+ *
+ * In the zero-copy variant (mem_dtype_send != NULL), nothing is packed and the rounds are all started at once with MPI_Ialltoallw.
+ * As the sends read the memory until the rounds complete, the chunks of a round are only shuffled as soon as it completes,
+ * and they are copied back once all the rounds have completed and the memory has been reset.
  *
- * @param n_send_rqst
- * @param send_rqst
- * @param send_chunks
- * @param n_recv_rqst
- * @param recv_rqst
- * @param recv_chunks
+ * @param n_send_chunk the number of send chunks
+ * @param send_chunks the send chunks
+ * @param count_send the count for every rank of the subcomm, for every round
+ * @param disp_send the displacement for every rank of the subcomm
+ * @param dtype_send the datatype for every rank of the subcomm if the counts do not fit in an int (NULL otherwise)
+ * @param mem_dtype_send the datatype in the memory of the chunk sent to every rank for the zero-copy variant (NULL otherwise)
+ * @param n_recv_chunk the number of recv chunks
+ * @param recv_chunks the recv chunks
+ * @param count_recv the count for every rank of the subcomm, for every round
+ * @param disp_recv the displacement for every rank of the subcomm
+ * @param dtype_recv the datatype for every rank of the subcomm if the counts do not fit in an int (NULL otherwise)
+ * @param self_send the index of the self communication in the send chunks (-1 if none)
+ * @param self_recv the index of the self communication in the recv chunks (-1 if none)
+ * @param n_round the number of rounds
+ * @param send_buf
+ * @param recv_buf
+ * @param all2all_rqst the requests, one per round
+ * @param subcomm
  * @param topo_in
  * @param topo_out
  * @param mem
+ * @param prof
  */
-void All2Allv(MemChunk *send_chunks, const int *count_send, const int *disp_send,
-              MemChunk *recv_chunks, const int *count_recv, const int *disp_recv, 
-              opt_double_ptr send_buf, opt_double_ptr recv_buf, MPI_Request* all2all_rqst, MPI_Comm subcomm,
-              const Topology *topo_in, const Topology *topo_out, opt_double_ptr mem, H3LPR::Profiler* prof) {
+void All2Allv(const int n_send_chunk, MemChunk *send_chunks, const a2a_count_t *count_send, const a2a_disp_t *disp_send, const MPI_Datatype *dtype_send, const MPI_Datatype *mem_dtype_send,
+              const int n_recv_chunk, MemChunk *recv_chunks, const a2a_count_t *count_recv, const a2a_disp_t *disp_recv, const MPI_Datatype *dtype_recv,
+              const int self_send, const int self_recv, const int n_round,
+              opt_real_ptr send_buf, opt_real_ptr recv_buf, MPI_Request* all2all_rqst, MPI_Comm subcomm,
+              const Topology *topo_in, const Topology *topo_out, opt_real_ptr mem, H3LPR::Profiler* prof) {
 
     BEGIN_FUNC;
     //--------------------------------------------------------------------------
     const int nmem_in[3]  = {topo_in->nmem(0), topo_in->nmem(1), topo_in->nmem(2)};
     const int nmem_out[3] = {topo_out->nmem(0), topo_out->nmem(1), topo_out->nmem(2)};
 
-    int sub_size;
+    int sub_rank, sub_size;
+    MPI_Comm_rank(subcomm, &sub_rank);
     MPI_Comm_size(subcomm, &sub_size);
+    const bool is_zerocopy = (mem_dtype_send != NULL);
+
     //..........................................................................
     auto set_sendbuf = [=](MemChunk *chunk) {
         FLUPS_INFO("sending request to rank %d of size %d %d %d", chunk->dest_rank, chunk->isize[0], chunk->isize[1], chunk->isize[2]);
@@ -196,52 +343,103 @@ void All2Allv(MemChunk *send_chunks, const int *count_send, const int *disp_send
         DoShuffleChunk(chunk);
         CopyChunk2Data(chunk, nmem_out, mem);
     };
+
+    auto start_round = [=](const int ir) {
+        const a2a_count_t *round_count_send = count_send + ir * sub_size;
+        const a2a_count_t *round_count_recv = count_recv + ir * sub_size;
+#if (FLUPS_MPI_LARGE_COUNT)
+        if (is_zerocopy) {
+            // the memory datatypes are relative to the memory and the recv ones contain the absolute address of the chunks
+            MPI_Ialltoallw_c(mem, round_count_send, disp_send, mem_dtype_send, MPI_BOTTOM, round_count_recv, disp_recv, dtype_recv, subcomm, all2all_rqst + ir);
+        } else {
+            MPI_Ialltoallv_c(send_buf, round_count_send, disp_send, FLUPS_MPI_REAL, recv_buf, round_count_recv, disp_recv, FLUPS_MPI_REAL, subcomm, all2all_rqst + ir);
+        }
+#else
+        if (is_zerocopy) {
+            // the memory datatypes are relative to the memory and the recv ones contain the absolute address of the chunks
+            MPI_Ialltoallw(mem, round_count_send, disp_send, mem_dtype_send, MPI_BOTTOM, round_count_recv, disp_recv, dtype_recv, subcomm, all2all_rqst + ir);
+        } else if (dtype_send != NULL) {
+            // the datatypes contain the absolute address of the chunks
+            MPI_Ialltoallw(MPI_BOTTOM, round_count_send, disp_send, dtype_send, MPI_BOTTOM, round_count_recv, disp_recv, dtype_recv, subcomm, all2all_rqst + ir);
+        } else {
+            MPI_Ialltoallv(send_buf, round_count_send, disp_send, FLUPS_MPI_REAL, recv_buf, round_count_recv, disp_recv, FLUPS_MPI_REAL, subcomm, all2all_rqst + ir);
+        }
+#endif
+    };
     //..........................................................................
-    // Prepare the send buffer
-    {
+    // Prepare the send buffer and start the rounds as soon as they are packed, the zero-copy starts them all at once
+    for (int ir = 0; ir < n_round; ++ir) {
         m_profStarti(prof, "copy data 2 chunk");
-        int count = 0;
-        for (int ir = 0; ir < sub_size; ++ir) {
-            // we might have nothing to send to that rank in the subcomm
-            if (count_send[ir] > 0) {
-                MemChunk *cchunk = send_chunks + count;
-                // FLUPS_CHECK(cchunk->dest_rank == ir, "Destination rank of the chunk should correspond to the chunk indexing %d vs %d", cchunk->dest_rank, ir);
-                set_sendbuf(cchunk);
-                count += 1;
+        for (int ic = 0; ic < n_send_chunk && !is_zerocopy; ++ic) {
+            if (ic != self_send && a2a_round(sub_rank, send_chunks[ic].dest_rank, sub_size, n_round) == ir) {
+                set_sendbuf(send_chunks + ic);
+                // make the previous rounds progress
+                if (ir > 0) {
+                    int flag;
+                    MPI_Testall(ir, all2all_rqst, &flag, MPI_STATUSES_IGNORE);
+                }
             }
         }
         m_profStopi(prof, "copy data 2 chunk");
-    }
-
 
-    m_profStarti(prof, "all2all - start");
+        m_profStarti(prof, "all2all - start");
+        start_round(ir);
+        m_profStopi(prof, "all2all - start");
+    }
 
-    MPI_Ialltoallv(send_buf, count_send, disp_send, MPI_DOUBLE, recv_buf, count_recv, disp_recv, MPI_DOUBLE, subcomm, all2all_rqst);
-    m_profStopi(prof, "all2all - start");
+    // the self communication is copied and shuffled in one pass while the data is being exchanged
+    if (self_send >= 0) {
+        m_profStarti(prof, "self copy");
+        CopyData2ShuffledChunk(nmem_in, mem, send_chunks + self_send, recv_chunks + self_recv);
+        m_profStopi(prof, "self copy");
+    }
 
-    // reset the memory to 0.0 as we do inplace computations
+    // reset the memory to 0.0 as we do inplace computations, the zero-copy sends read the memory until the end of the rounds
     const size_t reset_size = topo_out->memsize();
-    std::memset(mem, 0, reset_size * sizeof(double));
+    if (!is_zerocopy) {
+        std::memset(mem, 0, reset_size * sizeof(flups_real));
+    }
+
+    if (self_recv >= 0 && !is_zerocopy) {
+        m_profStarti(prof, "self copy");
+        CopyChunk2Data(recv_chunks + self_recv, nmem_out, mem);
+        m_profStopi(prof, "self copy");
+    }
 
-    m_profStarti(prof, "all2all - wait");
-    MPI_Wait(all2all_rqst, MPI_STATUS_IGNORE);    
-    m_profStopi(prof, "all2all - wait");
+    // Copy back the recveived data, round by round
+    for (int ir = 0; ir < n_round; ++ir) {
+        m_profStarti(prof, "all2all - wait");
+        MPI_Wait(all2all_rqst + ir, MPI_STATUS_IGNORE);
+        m_profStopi(prof, "all2all - wait");
 
-    // Copy back the recveived data
-    {
         m_profStarti(prof, "shuffle and copy chunk 2 data");
-        int count = 0;
-        for (int ir = 0; ir < sub_size; ++ir) {
-            if (count_recv[ir] > 0) {
-                MemChunk *cchunk = recv_chunks + count;
-                // FLUPS_CHECK(cchunk->dest_rank == ir, "Destination rank of the chunk should correspond to the chunk indexing %d vs %d", cchunk->dest_rank, ir);
-                complete_recv(cchunk);
-                count += 1;
+        for (int ic = 0; ic < n_recv_chunk; ++ic) {
+            if (ic != self_recv && a2a_round(sub_rank, recv_chunks[ic].dest_rank, sub_size, n_round) == ir) {
+                if (is_zerocopy) {
+                    DoShuffleChunk(recv_chunks + ic);
+                } else {
+                    complete_recv(recv_chunks + ic);
+                }
+                // make the next rounds progress
+                if (ir < n_round - 1) {
+                    int flag;
+                    MPI_Testall(n_round - ir - 1, all2all_rqst + ir + 1, &flag, MPI_STATUSES_IGNORE);
+                }
             }
         }
         m_profStopi(prof, "shuffle and copy chunk 2 data");
     }
 
+    // the zero-copy can now reset the memory and copy back all the shuffled chunks
+    if (is_zerocopy) {
+        std::memset(mem, 0, reset_size * sizeof(flups_real));
+        m_profStarti(prof, "shuffle and copy chunk 2 data");
+        for (int ic = 0; ic < n_recv_chunk; ++ic) {
+            CopyChunk2Data(recv_chunks + ic, nmem_out, mem);
+        }
+        m_profStopi(prof, "shuffle and copy chunk 2 data");
+    }
+
     //--------------------------------------------------------------------------
     END_FUNC;
 }
@@ -260,19 +458,32 @@ void SwitchTopoX_a2a::print_info() const {
     int sub_size;
     MPI_Comm_size(subcomm_, &sub_size);
 
+    // get the number of doubles sent to each rank, the count arrays might contain datatype counts
+    size_t *count = reinterpret_cast<size_t *>(m_calloc(sub_size * sizeof(size_t)));
+    auto get_count = [=](const int nchunks, const int self_idx, const MemChunk *chunks) {
+        std::memset(count, 0, sub_size * sizeof(size_t));
+        for (int ic = 0; ic < nchunks; ++ic) {
+            if (ic == self_idx) continue;
+            count[chunks[ic].dest_rank] = get_ChunkMsgSize(chunks + ic);
+        }
+    };
+
     // Get filename  
     std::string filename_forward = "./prof/Nrank_" + std::to_string(world_size)+ "_SwitchTopo_" + std::to_string(idswitchtopo_) + "_forward_messages.txt";
-    PrintCountArr(filename_forward, i2o_count_, sub_size, inComm_);
+    get_count(i2o_nchunks_, i2o_selfcomm_, i2o_chunks_);
+    PrintCountArr(filename_forward, count, sub_size, inComm_);
     
     std::string filename_backward = "./prof/Nrank_" + std::to_string(world_size)+ "_SwitchTopo_" + std::to_string(idswitchtopo_) + "_backward_messages.txt";
-    PrintCountArr(filename_backward, o2i_count_, sub_size, inComm_);
+    get_count(o2i_nchunks_, o2i_selfcomm_, o2i_chunks_);
+    PrintCountArr(filename_backward, count, sub_size, inComm_);
+    m_free(count);
     //--------------------------------------------------------------------------
     END_FUNC;
 
 }
 
 
-void PrintCountArr(const std::string filename, const int* count_arr, int array_size, MPI_Comm incomm){
+void PrintCountArr(const std::string filename, const size_t* count_arr, int array_size, MPI_Comm incomm){
     BEGIN_FUNC;
     FLUPS_CHECK(count_arr!=NULL, "The setup must be initialised before printring their information");
     //--------------------------------------------------------------------------
@@ -283,7 +494,7 @@ void PrintCountArr(const std::string filename, const int* count_arr, int array_s
     // Create the message for this rank
     std::string msg = std::string((world_rank == 0) ? "" : "\n") + "rank " + std::to_string(world_rank);
     for(int i = 0; i < array_size; ++i){
-        msg += " " +  std::to_string((count_arr[i]/1000.0)*sizeof(double));
+        msg += " " +  std::to_string((count_arr[i]/1000.0)*sizeof(flups_real));
     }
     size_t msg_size = msg.length();
 
@@ -9,26 +9,50 @@
 
 #include "SwitchTopoX.hpp"
 
+#if (FLUPS_MPI_LARGE_COUNT)
+typedef MPI_Count a2a_count_t;  //!< count type of the all_to_all_v (MPI_Ialltoallv_c)
+typedef MPI_Aint  a2a_disp_t;   //!< displacement type of the all_to_all_v (MPI_Ialltoallv_c)
+#else
+typedef int a2a_count_t;  //!< count type of the all_to_all_v
+typedef int a2a_disp_t;   //!< displacement type of the all_to_all_v
+#endif
+
+/**
+ * @brief All to all implementation of the SwitchTopoX
+ *
+ * The chunks are packed in the send buffer and exchanged with MPI_Ialltoallv, in one or several rounds.
+ * In the zero-copy variant (SWITCH_A2AW), the chunks are sent directly from the memory with MPI_Ialltoallw and their datatype,
+ * which removes the packing and the send buffer.
+ */
 class SwitchTopoX_a2a : public SwitchTopoX {
-    MPI_Request* i2o_rqst_ = NULL;  //!< MPI i2o requests
-    MPI_Request* o2i_rqst_ = NULL;  //!< MPI o2i requests
+    const bool   is_zerocopy_;      //!< true if the chunks are sent directly from the memory (MPI_Ialltoallw)
+    int          n_round_  = 1;     //!< number of rounds of the all_to_all_v, each of them exchanging with a subset of the ranks
+    MPI_Request* i2o_rqst_ = NULL;  //!< MPI i2o requests, one per round
+    MPI_Request* o2i_rqst_ = NULL;  //!< MPI o2i requests, one per round
+
+    a2a_count_t *i2o_count_ = NULL; /**<@brief count argument of the all_to_all_v for input to output, for each round */
+    a2a_disp_t  *i2o_disp_  = NULL; /**<@brief start argument of the all_to_all_v for input to output */
+    a2a_count_t *o2i_count_ = NULL; /**<@brief count argument of the all_to_all_v for output to input, for each round */
+    a2a_disp_t  *o2i_disp_  = NULL; /**<@brief start argument of the all_to_all_v for output to input */
+
+    MPI_Datatype *i2o_dtype_ = NULL; /**<@brief datatype of each rank for input to output if the counts do not fit in an int (MPI_Ialltoallw), NULL otherwise */
+    MPI_Datatype *o2i_dtype_ = NULL; /**<@brief datatype of each rank for output to input if the counts do not fit in an int (MPI_Ialltoallw), NULL otherwise */
 
-    int *i2o_count_ = NULL; /**<@brief count argument of the all_to_all_v for input to output */
-    int *i2o_disp_  = NULL; /**<@brief start argument of the all_to_all_v for input to output */
-    int *o2i_count_ = NULL; /**<@brief count argument of the all_to_all_v for output to input */
-    int *o2i_disp_  = NULL; /**<@brief start argument of the all_to_all_v for output to input */
+    MPI_Datatype *i2o_mem_dtype_ = NULL; /**<@brief datatype in the memory of the chunk sent to each rank for input to output (zero-copy only) */
+    MPI_Datatype *o2i_mem_dtype_ = NULL; /**<@brief datatype in the memory of the chunk sent to each rank for output to input (zero-copy only) */
 
    public:
-    explicit SwitchTopoX_a2a(const Topology* topo_in, const Topology* topo_out, const int shift[3], H3LPR::Profiler* prof);
+    explicit SwitchTopoX_a2a(const Topology* topo_in, const Topology* topo_out, const int shift[3], H3LPR::Profiler* prof, const bool is_zerocopy = false);
     ~SwitchTopoX_a2a();
 
     void print_info() const override;
 
-    virtual bool need_send_buf()const override{return true;};
+    virtual bool need_send_buf()const override{return !is_zerocopy_;};
     virtual bool need_recv_buf()const override{return true;};
+    virtual SwitchType switch_type()const override{return is_zerocopy_ ? SWITCH_A2AW : SWITCH_A2A;};
 
-    virtual void setup_buffers(opt_double_ptr sendData, opt_double_ptr recvData) override;
-    virtual void execute(opt_double_ptr data, const int sign) const override;
+    virtual void setup_buffers(opt_real_ptr sendData, opt_real_ptr recvData) override;
+    virtual void execute(opt_real_ptr data, const int sign) const override;
     virtual void disp() const override;
 };
 
@@ -7,8 +7,18 @@
 
 void SendRecv(const int n_send_chunk, MPI_Request *send_rqst, MemChunk *send_chunks,
               const int n_recv_chunk, MPI_Request *recv_rqst, MemChunk *recv_chunks,
-              const int *send_order_list, int *completed_id, int* recv_order_list,
-              const Topology *topo_out, opt_double_ptr mem, H3LPR::Profiler *prof);
+              const int *send_order_list, SendSchedule *schedule, int *completed_id, int* recv_order_list, int *send_done,
+              const int *copy_dep_idx, const int *copy_dep, const int *recv_box,
+              const int self_send, const int self_recv,
+              const Topology *topo_in, const Topology *topo_out, opt_real_ptr mem, H3LPR::Profiler *prof);
+bool SetupCopyDependencies(const int n_send_chunk, const MemChunk *send_chunks, const int *send_order_list, const int nmem_in[3],
+                           const int n_recv_chunk, const MemChunk *recv_chunks, const int nmem_out[3],
+                           int **copy_dep_idx, int **copy_dep, int recv_box[6]);
+void SendRecvThreaded(const int n_send_chunk, MPI_Request *send_rqst, MemChunk *send_chunks,
+                      const int n_recv_chunk, MPI_Request *recv_rqst, MemChunk *recv_chunks,
+                      const int *send_order_list, SendSchedule *schedule, int *send_state, int *recv_state,
+                      const int self_send, const int self_recv,
+                      const Topology *topo_in, const Topology *topo_out, opt_real_ptr mem, H3LPR::Profiler *prof);
 
 SwitchTopoX_isr::SwitchTopoX_isr(const Topology *topo_in, const Topology *topo_out, const int shift[3], H3LPR::Profiler *prof)
     : SwitchTopoX(topo_in, topo_out, shift, prof) {
@@ -19,7 +29,7 @@ SwitchTopoX_isr::SwitchTopoX_isr(const Topology *topo_in, const Topology *topo_o
     END_FUNC;
 }
 
-void SwitchTopoX_isr::setup_buffers(opt_double_ptr sendData, opt_double_ptr recvData) {
+void SwitchTopoX_isr::setup_buffers(opt_real_ptr sendData, opt_real_ptr recvData) {
     BEGIN_FUNC;
     FLUPS_CHECK(sendData == nullptr, "The send data must be = to nullptr");
     FLUPS_CHECK(recvData != nullptr, "The recv data must be != to nullptr");
@@ -32,6 +42,7 @@ void SwitchTopoX_isr::setup_buffers(opt_double_ptr sendData, opt_double_ptr recv
     const int n_rqst = m_max(i2o_nchunks_, o2i_nchunks_);
     completed_id_    = reinterpret_cast<int *>(m_calloc(n_rqst * sizeof(int)));
     recv_order_      = reinterpret_cast<int *>(m_calloc(n_rqst * sizeof(int)));
+    send_done_       = reinterpret_cast<int *>(m_calloc(n_rqst * sizeof(int)));
     send_rqst_       = reinterpret_cast<MPI_Request *>(m_calloc(n_rqst * sizeof(MPI_Request)));
     recv_rqst_       = reinterpret_cast<MPI_Request *>(m_calloc(n_rqst * sizeof(MPI_Request)));
     i2o_send_order_  = reinterpret_cast<int *>(m_calloc(i2o_nchunks_ * sizeof(int)));
@@ -60,6 +71,8 @@ void SwitchTopoX_isr::setup_buffers(opt_double_ptr sendData, opt_double_ptr recv
     MPI_Comm_group(shared_comm_, &shared_group);
 
     auto setup_priority = [=](const int nchunks, MemChunk *chunks, int *send_order, int *prior_idx, int *noprior_idx) {
+        // switch the chunks to the shared comm when possible
+        ChunksToNewComm(shared_comm_, shared_group, nchunks, chunks);
         for (int ir = 0; ir < nchunks; ++ir) {
             // we offset the starting index to avoid congestion
 #if (FLUPS_ROLLING_RANK)
@@ -70,8 +83,7 @@ void SwitchTopoX_isr::setup_buffers(opt_double_ptr sendData, opt_double_ptr recv
             // get the chunk informations
             MemChunk *cchunk = chunks + ichunk;
 
-            bool is_in_shared;
-            ChunkToNewComm(shared_comm_, shared_group, cchunk, &is_in_shared);
+            const bool is_in_shared = (cchunk->comm == shared_comm_);
 
             // store the id in the send order list and update the comm + dest_rank if needed
 #if (FLUPS_PRIORITYLIST)
@@ -100,6 +112,35 @@ void SwitchTopoX_isr::setup_buffers(opt_double_ptr sendData, opt_double_ptr recv
 
     // free the groups
     MPI_Group_free(&shared_group);
+
+    // the send order and the throttling are then adapted during the first executions
+    i2o_schedule_ = new SendSchedule(i2o_nchunks_, subcomm_);
+    o2i_schedule_ = new SendSchedule(o2i_nchunks_, subcomm_);
+
+    //..........................................................................
+    // use the threaded engine if asked (see MPI_MULTITHREAD) and if MPI supports it
+#if (FLUPS_MPI_MULTITHREAD)
+    int provided;
+    MPI_Query_thread(&provided);
+    is_multithread_ = (provided == MPI_THREAD_MULTIPLE) && (omp_get_max_threads() > 1);
+#endif
+
+    //..........................................................................
+    // track which sends read the memory of each recv chunk, so that the copy does not wait for all the sends
+    // the topologies might not be in the complex/real state of the chunks, so we get the memory size matching the chunks
+    // the threaded engine waits for all its sends before copying, the dependencies are not used
+    if (!is_multithread_ && i2o_nchunks_ > 0 && o2i_nchunks_ > 0) {
+        int nmem_in[3], nmem_out[3];
+        ChunkNmem(topo_in_, i2o_chunks_, nmem_in);
+        ChunkNmem(topo_out_, o2i_chunks_, nmem_out);
+        SetupCopyDependencies(i2o_nchunks_, i2o_chunks_, i2o_send_order_, nmem_in,
+                              o2i_nchunks_, o2i_chunks_, nmem_out,
+                              &o2i_copy_dep_idx_, &o2i_copy_dep_, o2i_recv_box_);
+        SetupCopyDependencies(o2i_nchunks_, o2i_chunks_, o2i_send_order_, nmem_out,
+                              i2o_nchunks_, i2o_chunks_, nmem_in,
+                              &i2o_copy_dep_idx_, &i2o_copy_dep_, i2o_recv_box_);
+    }
+
     //--------------------------------------------------------------------------
     END_FUNC;
 }
@@ -114,8 +155,15 @@ SwitchTopoX_isr::~SwitchTopoX_isr() {
     m_free(o2i_send_order_);
     m_free(completed_id_);
     m_free(recv_order_);
+    m_free(send_done_);
+    if (i2o_copy_dep_idx_ != nullptr) m_free(i2o_copy_dep_idx_);
+    if (o2i_copy_dep_idx_ != nullptr) m_free(o2i_copy_dep_idx_);
+    if (i2o_copy_dep_ != nullptr) m_free(i2o_copy_dep_);
+    if (o2i_copy_dep_ != nullptr) m_free(o2i_copy_dep_);
+    if (i2o_schedule_ != nullptr) delete i2o_schedule_;
+    if (o2i_schedule_ != nullptr) delete o2i_schedule_;
 
-    MPI_Comm_free(&shared_comm_);
+    if (shared_comm_ != MPI_COMM_NULL) MPI_Comm_free(&shared_comm_);
     //--------------------------------------------------------------------------
     END_FUNC;
 }
@@ -126,20 +174,51 @@ SwitchTopoX_isr::~SwitchTopoX_isr() {
  * @param v
  * @param sign
  */
-void SwitchTopoX_isr::execute(opt_double_ptr v, const int sign) const {
+void SwitchTopoX_isr::execute(opt_real_ptr v, const int sign) const {
     BEGIN_FUNC;
     //--------------------------------------------------------------------------
     m_profStarti(prof_, "Switchtopo%d_%s", idswitchtopo_, (FLUPS_FORWARD == sign) ? "forward" : "backward");
-    if (sign == FLUPS_FORWARD) {
+    SendSchedule *schedule = (sign == FLUPS_FORWARD) ? i2o_schedule_ : o2i_schedule_;
+    schedule->start_exec();
+    if (is_multithread_) {
+        // the arrays completed_id_ and recv_order_ store the state of the send and recv requests
+        if (sign == FLUPS_FORWARD) {
+            SendRecvThreaded(i2o_nchunks_, send_rqst_, i2o_chunks_,
+                             o2i_nchunks_, recv_rqst_, o2i_chunks_,
+                             i2o_send_order_, i2o_schedule_, completed_id_, recv_order_,
+                             i2o_selfcomm_, o2i_selfcomm_,
+                             topo_in_, topo_out_, v, prof_);
+        } else {
+            SendRecvThreaded(o2i_nchunks_, send_rqst_, o2i_chunks_,
+                             i2o_nchunks_, recv_rqst_, i2o_chunks_,
+                             o2i_send_order_, o2i_schedule_, completed_id_, recv_order_,
+                             o2i_selfcomm_, i2o_selfcomm_,
+                             topo_out_, topo_in_, v, prof_);
+        }
+    } else if (sign == FLUPS_FORWARD) {
         SendRecv(i2o_nchunks_, send_rqst_, i2o_chunks_,
                  o2i_nchunks_, recv_rqst_, o2i_chunks_,
-                 i2o_send_order_, completed_id_, recv_order_,
-                 topo_out_, v, prof_);
+                 i2o_send_order_, i2o_schedule_, completed_id_, recv_order_, send_done_,
+                 o2i_copy_dep_idx_, o2i_copy_dep_, o2i_recv_box_,
+                 i2o_selfcomm_, o2i_selfcomm_,
+                 topo_in_, topo_out_, v, prof_);
     } else {
         SendRecv(o2i_nchunks_, send_rqst_, o2i_chunks_,
                  i2o_nchunks_, recv_rqst_, i2o_chunks_,
-                 o2i_send_order_, completed_id_, recv_order_,
-                 topo_in_, v, prof_);
+                 o2i_send_order_, o2i_schedule_, completed_id_, recv_order_, send_done_,
+                 i2o_copy_dep_idx_, i2o_copy_dep_, i2o_recv_box_,
+                 o2i_selfcomm_, i2o_selfcomm_,
+                 topo_out_, topo_in_, v, prof_);
+    }
+    // the copy dependencies are expressed as positions in the send order, they follow the adapted one
+    const int *copy_dep_idx = (sign == FLUPS_FORWARD) ? o2i_copy_dep_idx_ : i2o_copy_dep_idx_;
+    int       *copy_dep     = (sign == FLUPS_FORWARD) ? o2i_copy_dep_ : i2o_copy_dep_;
+    const int  n_recv       = (sign == FLUPS_FORWARD) ? o2i_nchunks_ : i2o_nchunks_;
+    if (schedule->end_exec((sign == FLUPS_FORWARD) ? i2o_selfcomm_ : o2i_selfcomm_, (sign == FLUPS_FORWARD) ? i2o_send_order_ : o2i_send_order_, completed_id_) &&
+        copy_dep_idx != nullptr) {
+        for (int id = 0; id < copy_dep_idx[n_recv]; ++id) {
+            copy_dep[id] = completed_id_[copy_dep[id]];
+        }
     }
     m_profStopi(prof_, "Switchtopo%d_%s", idswitchtopo_, (FLUPS_FORWARD == sign) ? "forward" : "backward");
     //--------------------------------------------------------------------------
@@ -161,14 +240,40 @@ void SwitchTopoX_isr::disp() const {
     FLUPS_INFO("------------------------------------------");
 }
 
+/**
+ * @brief Send and receive the non-blocking calls, overlaping with the shuffle execution
+ *
+ * If the copy dependencies are given (copy_dep_idx != nullptr), a received chunk is copied as soon as the sends
+ * reading its memory region have completed, and only the memory outside of the received box is reset once every send has completed.
+ * Otherwise the whole memory is reset once every send has completed and the copies wait for it.
+ * The self communication does not go through MPI: when its turn comes in the send order, it is copied and shuffled in one pass
+ * and its send is immediately completed.
+ */
 void SendRecv(const int n_send_chunk, MPI_Request *send_rqst, MemChunk *send_chunks,
               const int n_recv_chunk, MPI_Request *recv_rqst, MemChunk *recv_chunks,
-              const int *send_order_list, int *completed_id, int* recv_order_list,
-              const Topology *topo_out, opt_double_ptr mem, H3LPR::Profiler *prof) {
+              const int *send_order_list, SendSchedule *schedule, int *completed_id, int* recv_order_list, int *send_done,
+              const int *copy_dep_idx, const int *copy_dep, const int *recv_box,
+              const int self_send, const int self_recv,
+              const Topology *topo_in, const Topology *topo_out, opt_real_ptr mem, H3LPR::Profiler *prof) {
     BEGIN_FUNC;
     //--------------------------------------------------------------------------
+    const int nmem_in[3] = {topo_in->nmem(0), topo_in->nmem(1), topo_in->nmem(2)};
+    //..........................................................................
+    // Define the counter needed to perform the send and receive
+    const int  send_batch    = schedule->batch();         // number of sends done at the same time
+    const int  max_nbsend    = schedule->max_inflight();  // max number of sends in flight
+    int        send_cntr     = 0;                         // counter the number of send done
+    int        recv_cntr     = 0;                         // count the number of recv completed
+    int        copy_cntr     = 0;                         // count the number of processed received
+    int        finished_send = 0;                         // count the number of completed send
+    bool       is_mem_reset  = false;                     // track if the mem has been reset
+    const bool is_tracked    = (copy_dep_idx != nullptr);  // track the memory regions freed by the sends
+
+    std::memset(send_done, 0, n_send_chunk * sizeof(int));
+
+    //..........................................................................
     // Define the send of a batch of requests
-    auto send_my_batch = [=](const int n_ttl_to_send, int *n_already_send, const int n_batch) {
+    auto send_my_batch = [=, &recv_cntr, &finished_send](const int n_ttl_to_send, int *n_already_send, const int n_batch) {
         // determine how many requests are left to send
         int count_send = m_min(n_ttl_to_send - n_already_send[0], n_batch);
         FLUPS_CHECK(count_send >= 0, "count send = %d cannot be negative", count_send);
@@ -183,11 +288,25 @@ void SendRecv(const int n_send_chunk, MPI_Request *send_rqst, MemChunk *send_chu
 
             // send is done directly from the memory to MPI
             MemChunk *c_chunk = send_chunks + chunk_idx;
-            int       rank_in_chunk;
+
+            // the self communication is copied and shuffled in one pass, it is then ready to be copied back
+            if (chunk_idx == self_send) {
+                m_profStart(prof, "copy");
+                CopyData2ShuffledChunk(nmem_in, mem, c_chunk, recv_chunks + self_recv);
+                m_profStop(prof, "copy");
+                send_rqst[ridx]            = MPI_REQUEST_NULL;
+                send_done[ridx]            = 1;
+                recv_order_list[recv_cntr] = self_recv;
+                recv_cntr++;
+                finished_send++;
+                continue;
+            }
+            int rank_in_chunk;
             MPI_Comm_rank(c_chunk->comm, &rank_in_chunk);
 
             // start the Isend and store it using ridx to make sure we can test it later
             m_profStart(prof, "start");
+            schedule->start_send(ridx);
             MPI_Isend(mem + c_chunk->offset, 1, c_chunk->dtype, c_chunk->dest_rank, rank_in_chunk, c_chunk->comm, send_rqst + ridx);
             m_profStop(prof, "start");
         }
@@ -196,14 +315,6 @@ void SendRecv(const int n_send_chunk, MPI_Request *send_rqst, MemChunk *send_chu
         FLUPS_INFO(" I am all done here, moving on");
     };
 
-    //..........................................................................
-    // Define the counter needed to perform the send and receive
-    const int send_batch    = FLUPS_MPI_BATCH_SEND;  // number of sends done at the same time
-    int       send_cntr     = 0;                     // counter the number of send done
-    int       recv_cntr     = 0;                     // count the number of recv completed
-    int       copy_cntr     = 0;                     // count the number of processed received
-    int       finished_send = 0;                     // count the number of completed send
-    bool      is_mem_reset  = false;                 // track if the mem has been reset
 
     //..........................................................................
     m_profStart(prof, "send/recv");
@@ -216,6 +327,11 @@ void SendRecv(const int n_send_chunk, MPI_Request *send_rqst, MemChunk *send_chu
         m_profStart(prof, "start");
         for (int ir = 0; ir < n_recv_chunk; ++ir) {
             MemChunk *c_chunk   = recv_chunks + ir;
+            if (ir == self_recv) {
+                // the self communication has no request
+                recv_rqst[ir] = MPI_REQUEST_NULL;
+                continue;
+            }
             MPI_Irecv(c_chunk->data, 1, c_chunk->dest_dtype, c_chunk->dest_rank, c_chunk->dest_rank, c_chunk->comm, recv_rqst + ir);
         }
         m_profStop(prof, "start");
@@ -233,7 +349,7 @@ void SendRecv(const int n_send_chunk, MPI_Request *send_rqst, MemChunk *send_chu
     m_profInitLeave(prof, "start");
     m_profInitLeave(prof, "shuffle");
     // while we have to send msgs to others or recv msg, we keep going
-    while ((send_cntr < n_send_chunk) || (recv_cntr < n_recv_chunk) || (copy_cntr < n_recv_chunk)) {
+    while ((send_cntr < n_send_chunk) || (finished_send < n_send_chunk) || (recv_cntr < n_recv_chunk) || (copy_cntr < n_recv_chunk)) {
         FLUPS_INFO("sent %d/%d - recvd %d/%d - copied %d/%d - reset done? %d", send_cntr, n_send_chunk, recv_cntr, n_recv_chunk, copy_cntr, n_recv_chunk, is_mem_reset);
         //......................................................................
         // [1] test if we have finished some send requests and start new ones
@@ -242,21 +358,31 @@ void SendRecv(const int n_send_chunk, MPI_Request *send_rqst, MemChunk *send_chu
             // completed id can be reused here as it has been allocated on the max of send and recv
             int n_send_completed;
             MPI_Testsome(send_cntr, send_rqst, &n_send_completed, completed_id, MPI_STATUSES_IGNORE);
+            // the only active request might be the self communication, which has no request
+            n_send_completed = (n_send_completed == MPI_UNDEFINED) ? 0 : n_send_completed;
 
             // this is the total number of send that have completed
             finished_send += n_send_completed;
+            for (int id = 0; id < n_send_completed; ++id) {
+                send_done[completed_id[id]] = 1;
+                schedule->end_send(completed_id[id], send_order_list[completed_id[id]]);
+            }
             const int still_ongoing_send = send_cntr - finished_send;
-            const int n_to_resend        = m_min(FLUPS_MPI_MAX_NBSEND - still_ongoing_send, send_batch);
+            const int n_to_resend        = m_min(max_nbsend - still_ongoing_send, send_batch);
             FLUPS_CHECK(n_to_resend >= 0, " You need to send a positive number of request");
             send_my_batch(n_send_chunk, &send_cntr, n_to_resend);
-
-            // if all the send have completed I can reset the memory to 0
-            is_mem_reset = (finished_send == n_send_chunk);
-            if (is_mem_reset) {
-                const size_t reset_size = topo_out->memsize();
-                std::memset(mem, 0, reset_size * sizeof(double));
-                FLUPS_INFO("reset mem done ");
+        }
+        // if all the send have completed I can reset the memory to 0
+        if (!is_mem_reset && (finished_send == n_send_chunk)) {
+            const size_t reset_size = topo_out->memsize();
+            if (is_tracked) {
+                // the received chunks might have already been copied, only reset the rest of the memory
+                ResetOutsideBox(recv_chunks, recv_box, nmem_out, reset_size, mem);
+            } else {
+                std::memset(mem, 0, reset_size * sizeof(flups_real));
             }
+            is_mem_reset = true;
+            FLUPS_INFO("reset mem done ");
         }
         //......................................................................
         // [2] test if we have finished some recv requests and shuffle them
@@ -265,6 +391,8 @@ void SendRecv(const int n_send_chunk, MPI_Request *send_rqst, MemChunk *send_chu
         if (recv_cntr < n_recv_chunk) {
             int n_completed = 0;
             MPI_Testsome(n_recv_chunk, recv_rqst, &n_completed, completed_id, MPI_STATUSES_IGNORE);
+            // the only recv left might be the self communication, which has no request
+            n_completed = (n_completed == MPI_UNDEFINED) ? 0 : n_completed;
 
             // for each of the completed request save its id for processing later
             for (int id = 0; id < n_completed; ++id) {
@@ -284,14 +412,26 @@ void SendRecv(const int n_send_chunk, MPI_Request *send_rqst, MemChunk *send_chu
         // [3] test if we have finished some recv requests and shuffle them
         //......................................................................
         // for each of the ready  and not copied yet request, copy them
-        if (is_mem_reset && (copy_cntr < recv_cntr)) {
+        if ((is_mem_reset || is_tracked) && (copy_cntr < recv_cntr)) {
             for(int icpy =  copy_cntr; icpy < recv_cntr; ++icpy){
                 const int rqst_id = recv_order_list[icpy];
+                // the memory region is free once all the sends reading it have completed
+                bool is_free = is_mem_reset;
+                if (!is_free) {
+                    is_free = true;
+                    for (int id = copy_dep_idx[rqst_id]; id < copy_dep_idx[rqst_id + 1]; ++id) {
+                        is_free = is_free && send_done[copy_dep[id]];
+                    }
+                }
+                if (!is_free) continue;
                 FLUPS_INFO("treating recv request %d/%d with id = %d", icpy, n_recv_chunk, rqst_id);
                 // copy the data
                 m_profStart(prof, "copy");
                 CopyChunk2Data(recv_chunks + rqst_id, nmem_out, mem);
                 m_profStop(prof, "copy");
+                // move the request in the copied part of the list
+                recv_order_list[icpy]      = recv_order_list[copy_cntr];
+                recv_order_list[copy_cntr] = rqst_id;
                 ++copy_cntr;
             }
         }
@@ -301,3 +441,315 @@ void SendRecv(const int n_send_chunk, MPI_Request *send_rqst, MemChunk *send_chu
     //--------------------------------------------------------------------------
     END_FUNC;
 }
+
+/**
+ * @brief Send and receive the non-blocking calls using all the threads
+ *
+ * Every thread owns a subset of the send requests (following the send order) and of the receive requests.
+ * Each thread starts its sends, tests its requests and shuffles its received chunks.
+ * Once all the threads have completed their sends, the memory is reset and each thread copies its chunks.
+ * The self communication is copied and shuffled by the thread owning it in the send order.
+ *
+ * @warning requires MPI_THREAD_MULTIPLE
+ */
+void SendRecvThreaded(const int n_send_chunk, MPI_Request *send_rqst, MemChunk *send_chunks,
+                      const int n_recv_chunk, MPI_Request *recv_rqst, MemChunk *recv_chunks,
+                      const int *send_order_list, SendSchedule *schedule, int *send_state, int *recv_state,
+                      const int self_send, const int self_recv,
+                      const Topology *topo_in, const Topology *topo_out, opt_real_ptr mem, H3LPR::Profiler *prof) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    const int    nmem_in[3]  = {topo_in->nmem(0), topo_in->nmem(1), topo_in->nmem(2)};
+    const int    nmem_out[3] = {topo_out->nmem(0), topo_out->nmem(1), topo_out->nmem(2)};
+    const size_t reset_size  = topo_out->memsize();
+
+    // reset the state of the requests: 0 = ongoing, 1 = completed (send) or shuffled (recv), 2 = copied (recv)
+    std::memset(send_state, 0, n_send_chunk * sizeof(int));
+    std::memset(recv_state, 0, n_recv_chunk * sizeof(int));
+
+    m_profStart(prof, "send/recv");
+#pragma omp parallel proc_bind(close)
+    {
+        const int tid  = omp_get_thread_num();
+        const int nthr = omp_get_num_threads();
+
+        // the requests owned by the thread are the ones with id = tid + k * nthr
+        const int my_n_send  = (n_send_chunk > tid) ? ((n_send_chunk - tid - 1) / nthr + 1) : 0;
+        const int my_n_recv  = (n_recv_chunk > tid) ? ((n_recv_chunk - tid - 1) / nthr + 1) : 0;
+        const int send_batch = schedule->batch();
+        const int max_nbsend = m_max(schedule->max_inflight() / nthr, 1);
+
+        int send_cntr     = 0;  // number of send started by the thread
+        int finished_send = 0;  // number of send completed by the thread
+        int copy_cntr     = 0;  // number of recv copied by the thread
+
+        // post all my receive requests, the self communication has no request
+        for (int ir = tid; ir < n_recv_chunk; ir += nthr) {
+            MemChunk *c_chunk = recv_chunks + ir;
+            if (ir == self_recv) continue;
+            MPI_Irecv(c_chunk->data, 1, c_chunk->dest_dtype, c_chunk->dest_rank, c_chunk->dest_rank, c_chunk->comm, recv_rqst + ir);
+        }
+
+        // test my receive requests and shuffle the completed ones
+        auto test_my_recv = [=]() {
+            for (int ir = tid; ir < n_recv_chunk; ir += nthr) {
+                if (recv_state[ir] == 0 && ir != self_recv) {
+                    int flag;
+                    MPI_Test(recv_rqst + ir, &flag, MPI_STATUS_IGNORE);
+                    if (flag) {
+                        DoShuffleChunk(recv_chunks + ir);
+                        recv_state[ir] = 1;
+                    }
+                }
+            }
+        };
+
+        //......................................................................
+        // [1] start the sends, shuffle the recvs as they arrive
+        while (finished_send < my_n_send) {
+            const int n_to_send = m_min(my_n_send - send_cntr, m_min(send_batch, max_nbsend - (send_cntr - finished_send)));
+            for (int is = 0; is < n_to_send; ++is) {
+                const int ridx    = tid + send_cntr * nthr;
+                MemChunk *c_chunk = send_chunks + send_order_list[ridx];
+                send_cntr++;
+                // the self communication is copied and shuffled in one pass, the recv is then ready to be copied back after the barrier
+                if (send_order_list[ridx] == self_send) {
+                    CopyData2ShuffledChunk(nmem_in, mem, c_chunk, recv_chunks + self_recv);
+                    recv_state[self_recv] = 1;
+                    send_state[ridx]      = 1;
+                    finished_send++;
+                    continue;
+                }
+                int rank_in_chunk;
+                MPI_Comm_rank(c_chunk->comm, &rank_in_chunk);
+                schedule->start_send(ridx);
+                MPI_Isend(mem + c_chunk->offset, 1, c_chunk->dtype, c_chunk->dest_rank, rank_in_chunk, c_chunk->comm, send_rqst + ridx);
+            }
+            for (int ks = 0; ks < send_cntr; ++ks) {
+                const int ridx = tid + ks * nthr;
+                if (send_state[ridx] == 0) {
+                    int flag;
+                    MPI_Test(send_rqst + ridx, &flag, MPI_STATUS_IGNORE);
+                    if (flag) schedule->end_send(ridx, send_order_list[ridx]);
+                    send_state[ridx] = flag;
+                    finished_send += flag;
+                }
+            }
+            test_my_recv();
+        }
+
+        //......................................................................
+        // [2] once every thread has completed its sends, reset the memory
+#pragma omp barrier
+#pragma omp for schedule(static)
+        for (size_t id = 0; id < reset_size; ++id) {
+            mem[id] = 0.0;
+        }
+
+        //......................................................................
+        // [3] copy the shuffled chunks and wait for the remaining ones
+        while (copy_cntr < my_n_recv) {
+            for (int ir = tid; ir < n_recv_chunk; ir += nthr) {
+                if (recv_state[ir] == 1) {
+                    CopyChunk2Data(recv_chunks + ir, nmem_out, mem);
+                    recv_state[ir] = 2;
+                    copy_cntr++;
+                }
+            }
+            test_my_recv();
+        }
+    }
+    m_profStop(prof, "send/recv");
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief computes for each recv chunk the send requests reading the memory where the chunk is copied
+ *
+ * The send chunks form a tensor grid in their memory layout (the "in" one). Every row of a recv chunk in the "out" layout
+ * is decomposed in rows of the "in" layout, which are matched with the send chunks owning them.
+ * The recv chunks must cover a box in the "out" layout, outside of which the memory will be reset.
+ *
+ * @param n_send_chunk the number of send chunks
+ * @param send_chunks the send chunks
+ * @param send_order_list the send order, the dependencies are expressed as position in this list (= the id of the send request)
+ * @param nmem_in the memory size of the layout of the send chunks
+ * @param n_recv_chunk the number of recv chunks
+ * @param recv_chunks the recv chunks
+ * @param nmem_out the memory size of the layout of the recv chunks
+ * @param copy_dep_idx for each recv chunk, the first index in copy_dep (size n_recv_chunk + 1), allocated here
+ * @param copy_dep the id of the send requests, allocated here
+ * @param recv_box the box covered by the recv chunks (start and end, 012-indexing)
+ * @return true if the dependencies have been computed, false if the memory regions cannot be tracked
+ */
+bool SetupCopyDependencies(const int n_send_chunk, const MemChunk *send_chunks, const int *send_order_list, const int nmem_in[3],
+                           const int n_recv_chunk, const MemChunk *recv_chunks, const int nmem_out[3],
+                           int **copy_dep_idx, int **copy_dep, int recv_box[6]) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    copy_dep_idx[0] = nullptr;
+    copy_dep[0]     = nullptr;
+    if (n_send_chunk == 0 || n_recv_chunk == 0) {
+        return false;
+    }
+
+    //..........................................................................
+    // the recv chunks must cover a box (they don't overlap, so the volumes must match)
+    size_t recv_volume = 0;
+    for (int id = 0; id < 3; ++id) {
+        recv_box[id]     = recv_chunks[0].istart[id];
+        recv_box[3 + id] = recv_chunks[0].istart[id] + recv_chunks[0].isize[id];
+    }
+    for (int ic = 0; ic < n_recv_chunk; ++ic) {
+        const MemChunk *cchunk = recv_chunks + ic;
+        for (int id = 0; id < 3; ++id) {
+            recv_box[id]     = m_min(recv_box[id], cchunk->istart[id]);
+            recv_box[3 + id] = m_max(recv_box[3 + id], cchunk->istart[id] + cchunk->isize[id]);
+        }
+        recv_volume += (size_t)cchunk->isize[0] * (size_t)cchunk->isize[1] * (size_t)cchunk->isize[2];
+    }
+    const size_t box_volume = (size_t)(recv_box[3] - recv_box[0]) * (size_t)(recv_box[4] - recv_box[1]) * (size_t)(recv_box[5] - recv_box[2]);
+    if (recv_volume != box_volume) {
+        FLUPS_INFO("the recv chunks do not cover a box, no memory region tracking");
+        return false;
+    }
+
+    //..........................................................................
+    // get the block id of every index in each direction, the send chunks start a new block
+    int *blk_id[3];
+    int  nblk[3];
+    bool is_grid = true;
+    for (int id = 0; id < 3; ++id) {
+        blk_id[id] = reinterpret_cast<int *>(m_calloc(nmem_in[id] * sizeof(int)));
+        std::memset(blk_id[id], 0, nmem_in[id] * sizeof(int));
+        for (int ic = 0; ic < n_send_chunk; ++ic) {
+            blk_id[id][send_chunks[ic].istart[id]] = 1;
+        }
+        // the indexes before the first chunk get -1
+        nblk[id] = 0;
+        for (int i = 0; i < nmem_in[id]; ++i) {
+            nblk[id] += blk_id[id][i];
+            blk_id[id][i] = nblk[id] - 1;
+        }
+    }
+    // register the send request id associated to each block and check that the blocks are not shared
+    const int nblk_ttl  = nblk[0] * nblk[1] * nblk[2];
+    int      *blk_rqst  = reinterpret_cast<int *>(m_calloc(m_max(nblk_ttl, 1) * sizeof(int)));
+    int      *blk_end   = reinterpret_cast<int *>(m_calloc(3 * n_send_chunk * sizeof(int)));
+    is_grid             = (nblk_ttl == n_send_chunk);
+    std::memset(blk_end, 0, 3 * n_send_chunk * sizeof(int));
+    for (int ib = 0; ib < nblk_ttl; ++ib) {
+        blk_rqst[ib] = -1;
+    }
+    for (int ir = 0; is_grid && ir < n_send_chunk; ++ir) {
+        const MemChunk *cchunk = send_chunks + send_order_list[ir];
+        int             ib[3];
+        for (int id = 0; id < 3; ++id) {
+            ib[id]         = blk_id[id][cchunk->istart[id]];
+            int *cblk_end  = blk_end + id * n_send_chunk + ib[id];
+            const int iend = cchunk->istart[id] + cchunk->isize[id];
+            // all the chunks of a block must have the same end
+            is_grid        = is_grid && (cblk_end[0] == 0 || cblk_end[0] == iend);
+            cblk_end[0]    = iend;
+        }
+        const int blk = ib[0] + nblk[0] * (ib[1] + nblk[1] * ib[2]);
+        is_grid       = is_grid && (blk_rqst[blk] < 0);
+        blk_rqst[blk] = ir;
+    }
+    // the indexes after the end of the block don't belong to any block
+    for (int id = 0; is_grid && id < 3; ++id) {
+        for (int i = 0; i < nmem_in[id]; ++i) {
+            if (blk_id[id][i] >= 0 && i >= blk_end[id * n_send_chunk + blk_id[id][i]]) {
+                blk_id[id][i] = -1;
+            }
+        }
+    }
+
+    //..........................................................................
+    // go through the rows of the recv chunks and register the send requests reading the memory
+    // the first pass counts the dependencies and the second one stores them
+    const int    ax_in[3] = {send_chunks[0].axis, (send_chunks[0].axis + 1) % 3, (send_chunks[0].axis + 2) % 3};
+    const int    nf       = send_chunks[0].nf;
+    const int    nda      = send_chunks[0].nda;
+    const size_t row_in   = (size_t)nmem_in[ax_in[0]] * nf;
+    int         *stamp    = reinterpret_cast<int *>(m_calloc(n_send_chunk * sizeof(int)));
+
+    auto register_dep = [=](const int pass) {
+        int n_dep = 0;
+        for (int ir = 0; ir < n_send_chunk; ++ir) {
+            stamp[ir] = -1;
+        }
+        for (int ic = 0; ic < n_recv_chunk; ++ic) {
+            const MemChunk *cchunk = recv_chunks + ic;
+            const int       ax0    = cchunk->axis;
+            const int       ax[3]  = {ax0, (ax0 + 1) % 3, (ax0 + 2) % 3};
+            if (pass == 1) copy_dep_idx[0][ic] = n_dep;
+
+            for (int lia = 0; lia < cchunk->nda; ++lia) {
+                for (int i2 = 0; i2 < cchunk->isize[ax[2]]; ++i2) {
+                    for (int i1 = 0; i1 < cchunk->isize[ax[1]]; ++i1) {
+                        // the memory range written by the copy
+                        const size_t start = localIndex(ax0, cchunk->istart[ax[0]], cchunk->istart[ax[1]] + i1, cchunk->istart[ax[2]] + i2, ax0, nmem_out, cchunk->nf, lia);
+                        const size_t end   = start + (size_t)cchunk->isize[ax[0]] * cchunk->nf;
+                        // loop on the rows of the "in" layout
+                        for (size_t row = start / row_in; row * row_in < end; ++row) {
+                            const int j1 = row % nmem_in[ax_in[1]];
+                            const int j2 = (row / nmem_in[ax_in[1]]) % nmem_in[ax_in[2]];
+                            const int l  = (row / nmem_in[ax_in[1]]) / nmem_in[ax_in[2]];
+                            if (l >= nda) break;
+
+                            const int b1 = blk_id[ax_in[1]][j1];
+                            const int b2 = blk_id[ax_in[2]][j2];
+                            if (b1 < 0 || b2 < 0) continue;
+
+                            // get the range of the row in the "in" layout and go through the blocks
+                            const int j0_start = (m_max(start, row * row_in) - row * row_in) / nf;
+                            const int j0_end   = (m_min(end, (row + 1) * row_in) - row * row_in + nf - 1) / nf;
+                            for (int j0 = j0_start; j0 < j0_end;) {
+                                const int b0 = blk_id[ax_in[0]][j0];
+                                if (b0 < 0) {
+                                    ++j0;
+                                    continue;
+                                }
+                                int ib[3];
+                                ib[ax_in[0]]   = b0;
+                                ib[ax_in[1]]   = b1;
+                                ib[ax_in[2]]   = b2;
+                                const int rqst = blk_rqst[ib[0] + nblk[0] * (ib[1] + nblk[1] * ib[2])];
+                                if (stamp[rqst] != ic) {
+                                    stamp[rqst] = ic;
+                                    if (pass == 1) copy_dep[0][n_dep] = rqst;
+                                    ++n_dep;
+                                }
+                                j0 = blk_end[ax_in[0] * n_send_chunk + b0];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return n_dep;
+    };
+
+    if (is_grid) {
+        const int n_dep = register_dep(0);
+        copy_dep_idx[0] = reinterpret_cast<int *>(m_calloc((n_recv_chunk + 1) * sizeof(int)));
+        copy_dep[0]     = reinterpret_cast<int *>(m_calloc(m_max(n_dep, 1) * sizeof(int)));
+        register_dep(1);
+        copy_dep_idx[0][n_recv_chunk] = n_dep;
+        FLUPS_INFO("memory region tracking: %d dependencies for %d recv and %d send chunks", n_dep, n_recv_chunk, n_send_chunk);
+    } else {
+        FLUPS_INFO("the send chunks do not form a grid, no memory region tracking");
+    }
+
+    for (int id = 0; id < 3; ++id) {
+        m_free(blk_id[id]);
+    }
+    m_free(blk_rqst);
+    m_free(blk_end);
+    m_free(stamp);
+    //--------------------------------------------------------------------------
+    END_FUNC;
+    return is_grid;
+}
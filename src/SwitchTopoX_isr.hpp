@@ -7,17 +7,32 @@
 #define SRC_SWITCHTOPOX_ISR_HPP_
 
 #include "SwitchTopoX.hpp"
+#include "SendSchedule.hpp"
+#include "omp.h"
 
 class SwitchTopoX_isr : public SwitchTopoX {
     int* i2o_send_order_ = nullptr;  //!< order in which to perform the send for input to output
     int* o2i_send_order_ = nullptr;  //!< order in which to perform the send for output to input
     int* completed_id_   = nullptr;  //!< array used by the Wait/Test in the non-blocking comms
     int* recv_order_     = nullptr;  //!< array used by the Wait/Test in the non-blocking comms
+    int* send_done_      = nullptr;  //!< completion flag of each send request
+
+    int* i2o_copy_dep_idx_ = nullptr;  //!< for each i2o chunk, first index of its dependencies in i2o_copy_dep_ (nullptr if no region tracking)
+    int* o2i_copy_dep_idx_ = nullptr;  //!< for each o2i chunk, first index of its dependencies in o2i_copy_dep_ (nullptr if no region tracking)
+    int* i2o_copy_dep_     = nullptr;  //!< id of the o2i send requests reading the memory where the i2o chunks are copied
+    int* o2i_copy_dep_     = nullptr;  //!< id of the i2o send requests reading the memory where the o2i chunks are copied
+    int  i2o_recv_box_[6];             //!< box covered by the i2o chunks in the input topo (start and end, 012-indexing)
+    int  o2i_recv_box_[6];             //!< box covered by the o2i chunks in the output topo (start and end, 012-indexing)
 
     MPI_Comm shared_comm_ = MPI_COMM_NULL;  //<! communicators with ranks on the same node
 
-    MPI_Request* send_rqst_;  //<! storage for send requests
-    MPI_Request* recv_rqst_;  //<! storage for recv requests
+    MPI_Request* send_rqst_ = nullptr;  //<! storage for send requests
+    MPI_Request* recv_rqst_ = nullptr;  //<! storage for recv requests
+
+    SendSchedule* i2o_schedule_ = nullptr;  //!< adaptive schedule of the i2o sends
+    SendSchedule* o2i_schedule_ = nullptr;  //!< adaptive schedule of the o2i sends
+
+    bool is_multithread_ = false;  //!< true if all the threads drive the communications (requires MPI_THREAD_MULTIPLE)
 
    public:
     explicit SwitchTopoX_isr(const Topology* topo_in, const Topology* topo_out, const int shift[3], H3LPR::Profiler* prof);
@@ -25,9 +40,10 @@ class SwitchTopoX_isr : public SwitchTopoX {
 
     virtual bool need_send_buf() const override { return false; };
     virtual bool need_recv_buf() const override { return true; };
+    virtual SwitchType switch_type() const override { return SWITCH_ISR; };
 
-    virtual void setup_buffers(opt_double_ptr sendData, opt_double_ptr recvData) override;
-    virtual void execute(opt_double_ptr data, const int sign) const override;
+    virtual void setup_buffers(opt_real_ptr sendData, opt_real_ptr recvData) override;
+    virtual void execute(opt_real_ptr data, const int sign) const override;
     virtual void disp() const override;
 };
 
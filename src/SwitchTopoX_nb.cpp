@@ -7,8 +7,14 @@
 
 void SendRecv(const int n_send_rqst, MPI_Request *send_rqst, MemChunk *send_chunks,
               const int n_recv_rqst, MPI_Request *recv_rqst, MemChunk *recv_chunks,
-              const int *send_order_list, int *completed_id, int *recv_order_list,
-              const Topology *topo_in, const Topology *topo_out, opt_double_ptr mem, H3LPR::Profiler *prof)  ;
+              const int *send_order_list, const int *send_npart, SendSchedule *schedule, int *completed_id, int *recv_order_list, MPI_Request *direct_rqst,
+              const int self_send, const int self_recv,
+              const Topology *topo_in, const Topology *topo_out, opt_real_ptr mem, H3LPR::Profiler *prof);
+void SendRecvThreaded(const int n_send_rqst, MPI_Request *send_rqst, MemChunk *send_chunks,
+                      const int n_recv_rqst, MPI_Request *recv_rqst, MemChunk *recv_chunks,
+                      const int *send_order_list, const int *send_npart, SendSchedule *schedule, int *send_state, int *recv_state,
+                      const int self_send, const int self_recv,
+                      const Topology *topo_in, const Topology *topo_out, opt_real_ptr mem, H3LPR::Profiler *prof);
 
 SwitchTopoX_nb::SwitchTopoX_nb(const Topology *topo_in, const Topology *topo_out, const int shift[3], H3LPR::Profiler *prof)
     : SwitchTopoX(topo_in, topo_out, shift, prof) {
@@ -19,7 +25,7 @@ SwitchTopoX_nb::SwitchTopoX_nb(const Topology *topo_in, const Topology *topo_out
     END_FUNC;
 }
 
-void SwitchTopoX_nb::setup_buffers(opt_double_ptr sendData, opt_double_ptr recvData) {
+void SwitchTopoX_nb::setup_buffers(opt_real_ptr sendData, opt_real_ptr recvData) {
     BEGIN_FUNC;
     FLUPS_CHECK(sendData != nullptr, "The send data must be != to nullptr");
     FLUPS_CHECK(recvData != nullptr, "The recv data must be != to nullptr");
@@ -39,11 +45,53 @@ void SwitchTopoX_nb::setup_buffers(opt_double_ptr sendData, opt_double_ptr recvD
 
     i2o_send_order_ = reinterpret_cast<int *>(m_calloc(i2o_nchunks_ * sizeof(int)));
     o2i_send_order_ = reinterpret_cast<int *>(m_calloc(o2i_nchunks_ * sizeof(int)));
+    i2o_send_npart_ = reinterpret_cast<int *>(m_calloc(i2o_nchunks_ * sizeof(int)));
+    o2i_send_npart_ = reinterpret_cast<int *>(m_calloc(o2i_nchunks_ * sizeof(int)));
 
     // allocate the completed_id array
     const int n_rqst = m_max(i2o_nchunks_, o2i_nchunks_);
     completed_id_    = reinterpret_cast<int *>(m_calloc(n_rqst * sizeof(int)));
     recv_order_    = reinterpret_cast<int *>(m_calloc(n_rqst * sizeof(int)));
+    direct_rqst_     = reinterpret_cast<MPI_Request *>(m_calloc(n_rqst * sizeof(MPI_Request)));
+    for (int ir = 0; ir < n_rqst; ++ir) {
+        direct_rqst_[ir] = MPI_REQUEST_NULL;
+    }
+
+    //..........................................................................
+    // use the threaded engine if asked (see MPI_MULTITHREAD) and if MPI supports it
+#if (FLUPS_MPI_MULTITHREAD)
+    int provided;
+    MPI_Query_thread(&provided);
+    is_multithread_ = (provided == MPI_THREAD_MULTIPLE) && (omp_get_max_threads() > 1);
+#endif
+
+#if (!FLUPS_MPI_PARTITIONED)
+    //..........................................................................
+    // choose the received chunks that are scattered by MPI directly in the memory, the other ones are shuffled
+    // the i2o transfert receives the o2i_chunks and the o2i transfert the i2o_chunks
+    // the threaded engine receives every chunk in the buffer, they all keep the default CHUNK_UNPACK_SHUFFLE
+    int nmem[3];
+    if (!is_multithread_ && o2i_nchunks_ > 0) {
+        ChunkNmem(topo_out_, o2i_chunks_, nmem);
+#if (FLUPS_PACK_TUNING)
+        TuneChunkUnpack(nmem, o2i_nchunks_, o2i_chunks_);
+#else
+        for (int ic = 0; ic < o2i_nchunks_; ++ic) {
+            o2i_chunks_[ic].unpack = (o2i_chunks_[ic].is_identity) ? CHUNK_UNPACK_MPI : CHUNK_UNPACK_SHUFFLE;
+        }
+#endif
+    }
+    if (!is_multithread_ && i2o_nchunks_ > 0) {
+        ChunkNmem(topo_in_, i2o_chunks_, nmem);
+#if (FLUPS_PACK_TUNING)
+        TuneChunkUnpack(nmem, i2o_nchunks_, i2o_chunks_);
+#else
+        for (int ic = 0; ic < i2o_nchunks_; ++ic) {
+            i2o_chunks_[ic].unpack = (i2o_chunks_[ic].is_identity) ? CHUNK_UNPACK_MPI : CHUNK_UNPACK_SHUFFLE;
+        }
+#endif
+    }
+#endif
 
     //..........................................................................
     // get information on shared rank
@@ -69,9 +117,18 @@ void SwitchTopoX_nb::setup_buffers(opt_double_ptr sendData, opt_double_ptr recvD
     MPI_Group shared_group;
     MPI_Comm_group(shared_comm_, &shared_group);
 
-    auto opinit = [=](const int nchunks,
+#if (FLUPS_MPI_PARTITIONED)
+    // the partitions are marked ready by the threads, which requires at least a serialized access to MPI
+    int thread_level;
+    MPI_Query_thread(&thread_level);
+    const int max_npart = (thread_level >= MPI_THREAD_SERIALIZED) ? omp_get_max_threads() : 1;
+#endif
+
+    auto opinit = [=](const int nchunks, const int self_idx,
                       MemChunk *chunks, MPI_Request *send_rqst, MPI_Request *recv_rqst,
-                      int *send_order, int *prior_idx, int *noprior_idx) {
+                      int *send_order, int *send_npart, int *prior_idx, int *noprior_idx) {
+        // switch the chunks to the shared comm when possible
+        ChunksToNewComm(shared_comm_, shared_group, nchunks, chunks);
         //......................................................................
         for (int ir = 0; ir < nchunks; ++ir) {
             // we offset the starting index to avoid congestion
@@ -83,38 +140,76 @@ void SwitchTopoX_nb::setup_buffers(opt_double_ptr sendData, opt_double_ptr recvD
             // get the chunk informations
             MemChunk *cchunk = chunks + ichunk;
 
-            // try to switch the chunk to the shared comm
-            bool is_in_shared;
-            ChunkToNewComm(shared_comm_, shared_group, cchunk, &is_in_shared);
+            const bool is_in_shared = (cchunk->comm == shared_comm_);
 
             // get the send/recv operations
             // get the sending tag as the origin rank
             // the receive tag is always the source one
             int send_tag;
             MPI_Comm_rank(cchunk->comm, &send_tag);
-            opt_double_ptr buf   = cchunk->data;
-            size_t         count = cchunk->size_padded * cchunk->nda;
-
-            FLUPS_CHECK(count < std::numeric_limits<int>::max(), "message is too big: %ld vs %d", count, std::numeric_limits<int>::max());
+            opt_real_ptr buf = cchunk->data;
+
+            // the self communication is directly copied by the backend: it has no request but keeps its place in the send order
+            const bool is_self = (ichunk == self_idx);
+#if (FLUPS_MPI_PARTITIONED)
+            // the send is split in the largest number of partitions dividing the count, up to the number of threads
+            const size_t count  = cchunk->size_padded * cchunk->nda;
+            int          n_part = 1;
+            for (int ip = max_npart; ip > 1 && !is_self; --ip) {
+                if (count % ip == 0) {
+                    n_part = ip;
+                    break;
+                }
+            }
+            send_npart[ichunk] = n_part;
+            // the receive is done in one partition as the shuffle needs the full chunk
+            auto recv_init = [=](MPI_Request *rqst) {
+                MPI_Precv_init(buf, 1, (MPI_Count)(count), FLUPS_MPI_REAL, cchunk->dest_rank, cchunk->dest_rank, cchunk->comm, MPI_INFO_NULL, rqst);
+            };
+            auto send_init_mpi = [=](MPI_Request *rqst) {
+                MPI_Psend_init(buf, n_part, (MPI_Count)(count / n_part), FLUPS_MPI_REAL, cchunk->dest_rank, send_tag, cchunk->comm, MPI_INFO_NULL, rqst);
+            };
+#else
+            // the padding is not sent so that the receiver can either receive the chunk in its buffer or directly in the memory
+            // with a datatype (see TuneChunkUnpack()), the datatype fits any count
+            send_npart[ichunk] = 1;
+            auto recv_init     = [=](MPI_Request *rqst) {
+                MPI_Recv_init(buf, 1, cchunk->dest_dtype, cchunk->dest_rank, cchunk->dest_rank, cchunk->comm, rqst);
+            };
+            auto send_init_mpi = [=](MPI_Request *rqst) {
+                MPI_Send_init(buf, 1, cchunk->dest_dtype, cchunk->dest_rank, send_tag, cchunk->comm, rqst);
+            };
+#endif
+            auto send_init = [=](MPI_Request *rqst) {
+                if (is_self) {
+                    rqst[0] = MPI_REQUEST_NULL;
+                } else {
+                    send_init_mpi(rqst);
+                }
+            };
             // receive requests are stored following the chunk indexes
-            MPI_Recv_init(buf, (int)(count), MPI_DOUBLE, cchunk->dest_rank, cchunk->dest_rank, cchunk->comm, recv_rqst + ichunk);
+            if (is_self) {
+                recv_rqst[ichunk] = MPI_REQUEST_NULL;
+            } else {
+                recv_init(recv_rqst + ichunk);
+            }
 
             // store the id in the send order list together with the send request
 #if (FLUPS_PRIORITYLIST)
             if (!is_in_shared) {
                 send_order[prior_idx[0]] = ichunk;
-                MPI_Send_init(buf, (int)(count), MPI_DOUBLE, cchunk->dest_rank, send_tag, cchunk->comm, send_rqst + prior_idx[0]);
+                send_init(send_rqst + prior_idx[0]);
                 // increment the priority counter
                 (prior_idx[0])++;
             } else {
                 send_order[noprior_idx[0]] = ichunk;
-                MPI_Send_init(buf, (int)(count), MPI_DOUBLE, cchunk->dest_rank, send_tag, cchunk->comm, send_rqst + noprior_idx[0]);
+                send_init(send_rqst + noprior_idx[0]);
                 // increment the non-priority counter
                 (noprior_idx[0])--;
             }
 #else
             send_order[prior_idx[0]] = ichunk;
-            MPI_Send_init(buf, (int)(count), MPI_DOUBLE, cchunk->dest_rank, send_tag, cchunk->comm, send_rqst + prior_idx[0]);
+            send_init(send_rqst + prior_idx[0]);
             // increment the counter
             (prior_idx[0])++;
 #endif 
@@ -129,11 +224,16 @@ void SwitchTopoX_nb::setup_buffers(opt_double_ptr sendData, opt_double_ptr recvD
     // we store the non-priority chunks at the end of the order list
     int i2o_noprior_idx = i2o_nchunks_ - 1;
     int o2i_noprior_idx = o2i_nchunks_ - 1;
-    opinit(i2o_nchunks_, i2o_chunks_, i2o_send_rqst_, o2i_recv_rqst_, i2o_send_order_, &i2o_prior_idx, &i2o_noprior_idx);
-    opinit(o2i_nchunks_, o2i_chunks_, o2i_send_rqst_, i2o_recv_rqst_, o2i_send_order_, &o2i_prior_idx, &o2i_noprior_idx);
+    opinit(i2o_nchunks_, i2o_selfcomm_, i2o_chunks_, i2o_send_rqst_, o2i_recv_rqst_, i2o_send_order_, i2o_send_npart_, &i2o_prior_idx, &i2o_noprior_idx);
+    opinit(o2i_nchunks_, o2i_selfcomm_, o2i_chunks_, o2i_send_rqst_, i2o_recv_rqst_, o2i_send_order_, o2i_send_npart_, &o2i_prior_idx, &o2i_noprior_idx);
 
     // free the groups
     MPI_Group_free(&shared_group);
+
+    // the send order and the throttling are then adapted during the first executions
+    i2o_schedule_ = new SendSchedule(i2o_nchunks_, subcomm_);
+    o2i_schedule_ = new SendSchedule(o2i_nchunks_, subcomm_);
+
     //--------------------------------------------------------------------------
     END_FUNC;
 }
@@ -141,14 +241,18 @@ void SwitchTopoX_nb::setup_buffers(opt_double_ptr sendData, opt_double_ptr recvD
 SwitchTopoX_nb::~SwitchTopoX_nb(){
     BEGIN_FUNC;
     //--------------------------------------------------------------------------
+    // the self communication has no request
+    auto free_rqst = [](MPI_Request *rqst) {
+        if (rqst[0] != MPI_REQUEST_NULL) MPI_Request_free(rqst);
+    };
     for (int ir = 0; ir < i2o_nchunks_; ++ir) {
-        MPI_Request_free(i2o_send_rqst_ + ir);
-        MPI_Request_free(o2i_recv_rqst_ + ir);
+        free_rqst(i2o_send_rqst_ + ir);
+        free_rqst(o2i_recv_rqst_ + ir);
     }
     // here we go for the output topo and the associated chunks
     for (int ir = 0; ir < o2i_nchunks_; ++ir) {
-        MPI_Request_free(i2o_recv_rqst_ + ir);
-        MPI_Request_free(o2i_send_rqst_ + ir);
+        free_rqst(i2o_recv_rqst_ + ir);
+        free_rqst(o2i_send_rqst_ + ir);
     }
 
     // free the request arrays
@@ -159,10 +263,16 @@ SwitchTopoX_nb::~SwitchTopoX_nb(){
 
     m_free(i2o_send_order_);
     m_free(o2i_send_order_);
+    m_free(i2o_send_npart_);
+    m_free(o2i_send_npart_);
     m_free(completed_id_);
     m_free(recv_order_);
+    m_free(direct_rqst_);
+
+    if (i2o_schedule_ != nullptr) delete i2o_schedule_;
+    if (o2i_schedule_ != nullptr) delete o2i_schedule_;
 
-    MPI_Comm_free(&shared_comm_);
+    if (shared_comm_ != MPI_COMM_NULL) MPI_Comm_free(&shared_comm_);
     //--------------------------------------------------------------------------
     END_FUNC;
 }
@@ -173,21 +283,52 @@ SwitchTopoX_nb::~SwitchTopoX_nb(){
  * @param v
  * @param sign
  */
-void SwitchTopoX_nb::execute(opt_double_ptr v, const int sign) const {
+void SwitchTopoX_nb::execute(opt_real_ptr v, const int sign) const {
     BEGIN_FUNC;
     //--------------------------------------------------------------------------
     m_profStarti(prof_, "Switchtopo%d_%s", idswitchtopo_, (FLUPS_FORWARD == sign) ? "forward" : "backward");
-    if (sign == FLUPS_FORWARD) {
+    SendSchedule *schedule = (sign == FLUPS_FORWARD) ? i2o_schedule_ : o2i_schedule_;
+    schedule->start_exec();
+    if (is_multithread_) {
+        // the arrays completed_id_ and recv_order_ store the state of the send and recv requests
+        if (sign == FLUPS_FORWARD) {
+            SendRecvThreaded(i2o_nchunks_, i2o_send_rqst_, i2o_chunks_,
+                             o2i_nchunks_, i2o_recv_rqst_, o2i_chunks_,
+                             i2o_send_order_, i2o_send_npart_, i2o_schedule_, completed_id_, recv_order_,
+                             i2o_selfcomm_, o2i_selfcomm_,
+                             topo_in_, topo_out_, v, prof_);
+        } else {
+            SendRecvThreaded(o2i_nchunks_, o2i_send_rqst_, o2i_chunks_,
+                             i2o_nchunks_, o2i_recv_rqst_, i2o_chunks_,
+                             o2i_send_order_, o2i_send_npart_, o2i_schedule_, completed_id_, recv_order_,
+                             o2i_selfcomm_, i2o_selfcomm_,
+                             topo_out_, topo_in_, v, prof_);
+        }
+    } else if (sign == FLUPS_FORWARD) {
         SendRecv(i2o_nchunks_, i2o_send_rqst_, i2o_chunks_,
                  o2i_nchunks_, i2o_recv_rqst_, o2i_chunks_,
-                 i2o_send_order_, completed_id_, recv_order_,
+                 i2o_send_order_, i2o_send_npart_, i2o_schedule_, completed_id_, recv_order_, direct_rqst_,
+                 i2o_selfcomm_, o2i_selfcomm_,
                  topo_in_, topo_out_, v, prof_);
     } else {
         SendRecv(o2i_nchunks_, o2i_send_rqst_, o2i_chunks_,
                  i2o_nchunks_, o2i_recv_rqst_, i2o_chunks_,
-                 o2i_send_order_, completed_id_, recv_order_,
+                 o2i_send_order_, o2i_send_npart_, o2i_schedule_, completed_id_, recv_order_, direct_rqst_,
+                 o2i_selfcomm_, i2o_selfcomm_,
                  topo_out_, topo_in_, v, prof_);
     }
+    // the send requests are stored following the send order, they follow the adapted one
+    const int    n_send     = (sign == FLUPS_FORWARD) ? i2o_nchunks_ : o2i_nchunks_;
+    int         *send_order = (sign == FLUPS_FORWARD) ? i2o_send_order_ : o2i_send_order_;
+    MPI_Request *send_rqst  = (sign == FLUPS_FORWARD) ? i2o_send_rqst_ : o2i_send_rqst_;
+    if (schedule->end_exec((sign == FLUPS_FORWARD) ? i2o_selfcomm_ : o2i_selfcomm_, send_order, completed_id_)) {
+        MPI_Request *tmp_rqst = reinterpret_cast<MPI_Request *>(m_calloc(n_send * sizeof(MPI_Request)));
+        for (int ir = 0; ir < n_send; ++ir) {
+            tmp_rqst[completed_id_[ir]] = send_rqst[ir];
+        }
+        std::memcpy(send_rqst, tmp_rqst, n_send * sizeof(MPI_Request));
+        m_free(tmp_rqst);
+    }
     m_profStopi(prof_, "Switchtopo%d_%s", idswitchtopo_, (FLUPS_FORWARD == sign) ? "forward" : "backward");
     //--------------------------------------------------------------------------
     END_FUNC;
@@ -209,19 +350,47 @@ void SwitchTopoX_nb::disp() const {
 }
 
 
+/**
+ * @brief Send and receive the persistent requests, overlaping the packing, the shuffle and the copies with the communications
+ *
+ * The received chunks unpacked with MPI (see TuneChunkUnpack()) are received directly in the memory with their transposed datatype
+ * (direct_rqst), which saves the shuffle and the copy. As the memory must then be free before the receives are posted,
+ * all the chunks are packed and the memory is reset first, without waiting for the other ranks.
+ * The self communication does not go through MPI: when its turn comes in the send order, it is copied and shuffled in one pass.
+ */
 void SendRecv(const int n_send_rqst, MPI_Request *send_rqst, MemChunk *send_chunks,
               const int n_recv_rqst, MPI_Request *recv_rqst, MemChunk *recv_chunks,
-              const int *send_order_list, int *completed_id, int *recv_order_list,
-              const Topology *topo_in, const Topology *topo_out, opt_double_ptr mem, H3LPR::Profiler *prof) {
+              const int *send_order_list, const int *send_npart, SendSchedule *schedule, int *completed_id, int *recv_order_list, MPI_Request *direct_rqst,
+              const int self_send, const int self_recv,
+              const Topology *topo_in, const Topology *topo_out, opt_real_ptr mem, H3LPR::Profiler *prof) {
     BEGIN_FUNC;
     //--------------------------------------------------------------------------
     // Get the memory arrangement
     const int nmem_in[3]  = {topo_in->nmem(0), topo_in->nmem(1), topo_in->nmem(2)};
     const int nmem_out[3] = {topo_out->nmem(0), topo_out->nmem(1), topo_out->nmem(2)};
 
+    //..........................................................................
+    // Define the counter needed to perform the send and receive
+    const int send_batch    = schedule->batch();         // number of sends done at the same time
+    const int max_nbsend    = schedule->max_inflight();  // max number of sends in flight
+    int       send_cntr     = 0;                         // counter the number of send done
+    int       recv_cntr     = 0;                         // count the number of recv completed
+    int       copy_cntr     = 0;                         // count the number of processed received
+    int       finished_send = 0;                         // count the number of completed send
+    bool      is_mem_reset  = false;                     // track if the mem has been reset
+    bool      is_packed     = false;                     // true if all the chunks have been packed before the sends
+
+    // the chunks unpacked with MPI are received directly in the memory (not with partitioned communications as the recv must then be persistent)
+    int n_direct = 0;
+#if (!FLUPS_MPI_PARTITIONED)
+    for (int ir = 0; ir < n_recv_rqst; ++ir) {
+        n_direct += (ir != self_recv) && (recv_chunks[ir].unpack == CHUNK_UNPACK_MPI);
+    }
+#endif
+
     //..........................................................................
     // Define the send of a batch of requests
-    auto send_my_batch = [=](const int n_ttl_to_send, int *n_already_send, const int n_batch) {
+    auto send_my_batch = [=, &recv_cntr, &finished_send, &is_packed](const int n_ttl_to_send, int *n_already_send, const int n_batch) {
         // determine how many requests are left to send
         int count_send = m_min(n_ttl_to_send - n_already_send[0], n_batch);
         FLUPS_CHECK(count_send >= 0, "count send = %d cannot be negative", count_send);
@@ -235,29 +404,57 @@ void SendRecv(const int n_send_rqst, MPI_Request *send_rqst, MemChunk *send_chun
             MPI_Request *c_rqst     = send_rqst + (n_already_send[0] + ir);
             MemChunk    *c_chunk    = send_chunks + id_to_send[0];
 
+            // the self communication is copied and shuffled in one pass, it is then ready to be copied back
+            if (id_to_send[0] == self_send) {
+                m_profStart(prof, "copy");
+                if (!is_packed) CopyData2ShuffledChunk(nmem_in, mem, c_chunk, recv_chunks + self_recv);
+                m_profStop(prof, "copy");
+                recv_order_list[recv_cntr] = self_recv;
+                recv_cntr++;
+                finished_send++;
+                continue;
+            }
+
+#if (FLUPS_MPI_PARTITIONED)
+            // start the send, the partitions are then marked ready as soon as they are packed
+            m_profStart(prof, "start");
+            schedule->start_send(n_already_send[0] + ir);
+            MPI_Start(c_rqst);
+            m_profStop(prof, "start");
+
             // copy the memory
             m_profStart(prof, "copy");
-            CopyData2Chunk(nmem_in, mem, c_chunk);
+            const int n_part = send_npart[id_to_send[0]];
+            if (n_part == 1) {
+                CopyData2Chunk(nmem_in, mem, c_chunk);
+                MPI_Pready(0, c_rqst[0]);
+            } else {
+                const size_t part_count = (c_chunk->size_padded * c_chunk->nda) / n_part;
+#pragma omp parallel for schedule(static) proc_bind(close)
+                for (int ip = 0; ip < n_part; ++ip) {
+                    CopyData2ChunkRange(nmem_in, mem, c_chunk, ip * part_count, part_count);
+#pragma omp critical(flups_pready)
+                    MPI_Pready(ip, c_rqst[0]);
+                }
+            }
+            m_profStop(prof, "copy");
+#else
+            // copy the memory
+            m_profStart(prof, "copy");
+            if (!is_packed) CopyData2Chunk(nmem_in, mem, c_chunk);
             m_profStop(prof, "copy");
 
             // start the send
             m_profStart(prof, "start");
+            schedule->start_send(n_already_send[0] + ir);
             MPI_Start(c_rqst);
             m_profStop(prof, "start");
+#endif
         }
         // increment the send counter
         n_already_send[0] += count_send;
     };
 
-    //..........................................................................
-    // Define the counter needed to perform the send and receive
-    const int send_batch    = FLUPS_MPI_BATCH_SEND;  // number of sends done at the same time
-    int       send_cntr     = 0;                     // counter the number of send done
-    int       recv_cntr     = 0;                     // count the number of recv completed
-    int       copy_cntr     = 0;                     // count the number of processed received
-    int       finished_send = 0;                     // count the number of completed send
-    bool      is_mem_reset  = false;                 // track if the mem has been reset
-
     //..........................................................................
     m_profStart(prof, "send/recv");
 
@@ -269,9 +466,46 @@ void SendRecv(const int n_send_rqst, MPI_Request *send_rqst, MemChunk *send_chun
         // so we start all the other request and the self request using the same start.
         FLUPS_INFO("starting %d recv request", n_recv_rqst);
         m_profStart(prof, "start");
-        MPI_Startall(n_recv_rqst, recv_rqst);
+        if (n_direct > 0) {
+            // the self communication has no request and the direct receives are posted once the memory is free
+            for (int ir = 0; ir < n_recv_rqst; ++ir) {
+                if (ir != self_recv && recv_chunks[ir].unpack != CHUNK_UNPACK_MPI) MPI_Start(recv_rqst + ir);
+            }
+        } else if (self_recv < 0) {
+            MPI_Startall(n_recv_rqst, recv_rqst);
+        } else {
+            // the self communication has no request
+            MPI_Startall(self_recv, recv_rqst);
+            MPI_Startall(n_recv_rqst - self_recv - 1, recv_rqst + self_recv + 1);
+        }
         m_profStop(prof, "start");
 
+        if (n_direct > 0) {
+            // all the chunks are packed first so that the memory is free without waiting for the other ranks
+            m_profStart(prof, "copy");
+            for (int ir = 0; ir < n_send_rqst; ++ir) {
+                MemChunk *c_chunk = send_chunks + send_order_list[ir];
+                if (send_order_list[ir] == self_send) {
+                    CopyData2ShuffledChunk(nmem_in, mem, c_chunk, recv_chunks + self_recv);
+                } else {
+                    CopyData2Chunk(nmem_in, mem, c_chunk);
+                }
+            }
+            is_packed = true;
+            std::memset(mem, 0, topo_out->memsize() * sizeof(flups_real));
+            is_mem_reset = true;
+            m_profStop(prof, "copy");
+
+            // the data is scattered by MPI in its final position
+            m_profStart(prof, "start");
+            for (int ir = 0; ir < n_recv_rqst; ++ir) {
+                MemChunk *c_chunk = recv_chunks + ir;
+                if (ir == self_recv || c_chunk->unpack != CHUNK_UNPACK_MPI) continue;
+                MPI_Irecv(mem + c_chunk->offset, 1, c_chunk->trsp_dtype, c_chunk->dest_rank, c_chunk->dest_rank, c_chunk->comm, direct_rqst + ir);
+            }
+            m_profStop(prof, "start");
+        }
+
         // Start a first batch of send request
         send_my_batch(n_send_rqst, &send_cntr, send_batch);
     }
@@ -287,7 +521,9 @@ void SendRecv(const int n_send_rqst, MPI_Request *send_rqst, MemChunk *send_chun
     m_profInitLeave(prof, "start");
     m_profInitLeave(prof, "shuffle");
     // while we have to send msgs to others or recv msg or copy the one we have received
-    while ((send_cntr < n_send_rqst) || (recv_cntr < n_recv_rqst) || (copy_cntr < n_recv_rqst)) {
+    // the sends must also have completed as the buffers are reused by the next switchtopo: with the direct receives,
+    // the memory is reset early and the copies do not wait for them anymore
+    while ((finished_send < n_send_rqst) || (recv_cntr < n_recv_rqst) || (copy_cntr < n_recv_rqst)) {
         FLUPS_INFO("sent %d/%d - recvd %d/%d - copied %d/%d - reset done? %d", send_cntr, n_send_rqst, recv_cntr, n_recv_rqst, copy_cntr, n_recv_rqst, is_mem_reset);
         //FLUPS_WARNING("sent %d/%d - recvd %d/%d - copied %d/%d - reset done? %d", send_cntr, n_send_rqst, recv_cntr, n_recv_rqst, copy_cntr, n_recv_rqst, is_mem_reset);
 
@@ -299,18 +535,23 @@ void SendRecv(const int n_send_rqst, MPI_Request *send_rqst, MemChunk *send_chun
             //  completed id can be reused here as it has been allocated on the max of send and recv
             int n_send_completed = 0;
             MPI_Testsome(send_cntr, send_rqst, &n_send_completed, completed_id, MPI_STATUSES_IGNORE);
+            // the only active request might be the self communication, which has no request
+            n_send_completed = (n_send_completed == MPI_UNDEFINED) ? 0 : n_send_completed;
+            for (int id = 0; id < n_send_completed; ++id) {
+                schedule->end_send(completed_id[id], send_order_list[completed_id[id]]);
+            }
 
             // this is the total number of send that have completed
             finished_send += n_send_completed;
             const int still_ongoing_send = send_cntr - finished_send;
-            const int n_to_resend        = m_min(FLUPS_MPI_MAX_NBSEND - still_ongoing_send, send_batch);
+            const int n_to_resend        = m_min(max_nbsend - still_ongoing_send, send_batch);
             FLUPS_CHECK(n_to_resend >= 0, " You need to send a positive number of request");
             send_my_batch(n_send_rqst, &send_cntr, n_to_resend);
         }
         // if all the send have completed I can reset the memory to 0
         if (!is_mem_reset && (finished_send == n_send_rqst)) {
             const size_t reset_size = topo_out->memsize();
-            std::memset(mem, 0, reset_size * sizeof(double));
+            std::memset(mem, 0, reset_size * sizeof(flups_real));
             is_mem_reset = true;
         }
 
@@ -322,10 +563,23 @@ void SendRecv(const int n_send_rqst, MPI_Request *send_rqst, MemChunk *send_chun
             int n_completed = 0;
 #ifndef NDEBUG
             MPI_Testsome(n_recv_rqst, recv_rqst, &n_completed, completed_id, recv_status);
-            FLUPS_CHECK(n_completed != MPI_UNDEFINED, "having an MPI_UNDEFINED here means no request is active");
+            FLUPS_CHECK(n_completed != MPI_UNDEFINED || self_recv >= 0 || n_direct > 0, "having an MPI_UNDEFINED here means no request is active");
 #else
             MPI_Testsome(n_recv_rqst, recv_rqst, &n_completed, completed_id, MPI_STATUSES_IGNORE);
 #endif
+            // the only recv left might be the self communication, which has no request
+            n_completed = (n_completed == MPI_UNDEFINED) ? 0 : n_completed;
+
+            // the direct receives are in the memory once completed, they are stored with the others but not copied
+            if (n_direct > 0) {
+                int n_direct_completed = 0;
+#ifndef NDEBUG
+                MPI_Testsome(n_recv_rqst, direct_rqst, &n_direct_completed, completed_id + n_completed, recv_status + n_completed);
+#else
+                MPI_Testsome(n_recv_rqst, direct_rqst, &n_direct_completed, completed_id + n_completed, MPI_STATUSES_IGNORE);
+#endif
+                n_completed += (n_direct_completed == MPI_UNDEFINED) ? 0 : n_direct_completed;
+            }
 
             // for each of the completed request save its id for processing later
             for (int id = 0; id < n_completed; ++id) {
@@ -337,9 +591,9 @@ void SendRecv(const int n_send_rqst, MPI_Request *send_rqst, MemChunk *send_chun
                 FLUPS_CHECK(chunk->dest_rank == status.MPI_TAG, "The tag of the message send does not match: %d vs %d", chunk->dest_rank, status.MPI_TAG);
                 FLUPS_CHECK(chunk->dest_rank == status.MPI_SOURCE, "The tag of the message send does not match: %d vs %d", chunk->dest_rank, status.MPI_SOURCE);
 #endif
-                // shuffle the data
+                // shuffle the data, the direct receives are already in place
                 m_profStart(prof, "shuffle");
-                DoShuffleChunk(chunk);
+                if (n_direct == 0 || chunk->unpack != CHUNK_UNPACK_MPI) DoShuffleChunk(chunk);
                 m_profStop(prof, "shuffle");
                 // save the id for copy'ing it later
                 recv_order_list[recv_cntr] = completed_id[id];
@@ -357,9 +611,10 @@ void SendRecv(const int n_send_rqst, MPI_Request *send_rqst, MemChunk *send_chun
                 const int rqst_id = recv_order_list[copy_cntr];
                 FLUPS_INFO("treating recv request %d/%d with id = %d",copy_cntr, n_recv_rqst, rqst_id);
 
-                // copy the data
+                // copy the data, the direct receives are already in place
+                const bool is_direct = (n_direct > 0) && (rqst_id != self_recv) && (recv_chunks[rqst_id].unpack == CHUNK_UNPACK_MPI);
                 m_profStart(prof, "copy");
-                CopyChunk2Data(recv_chunks + rqst_id, nmem_out, mem);
+                if (!is_direct) CopyChunk2Data(recv_chunks + rqst_id, nmem_out, mem);
                 m_profStop(prof, "copy");
 
                 // increment the counter
@@ -378,3 +633,132 @@ void SendRecv(const int n_send_rqst, MPI_Request *send_rqst, MemChunk *send_chun
     //--------------------------------------------------------------------------
     END_FUNC;
 }
+
+/**
+ * @brief Send and receive the non-blocking calls using all the threads
+ *
+ * Every thread owns a subset of the send requests (following the send order) and of the receive requests.
+ * Each thread packs and starts its sends, tests its requests and shuffles its received chunks.
+ * Once all the threads have completed their sends, the memory is reset and each thread copies its chunks.
+ * The self communication is copied and shuffled by the thread owning it in the send order.
+ *
+ * @warning requires MPI_THREAD_MULTIPLE
+ */
+void SendRecvThreaded(const int n_send_rqst, MPI_Request *send_rqst, MemChunk *send_chunks,
+                      const int n_recv_rqst, MPI_Request *recv_rqst, MemChunk *recv_chunks,
+                      const int *send_order_list, const int *send_npart, SendSchedule *schedule, int *send_state, int *recv_state,
+                      const int self_send, const int self_recv,
+                      const Topology *topo_in, const Topology *topo_out, opt_real_ptr mem, H3LPR::Profiler *prof) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    // Get the memory arrangement
+    const int    nmem_in[3]  = {topo_in->nmem(0), topo_in->nmem(1), topo_in->nmem(2)};
+    const int    nmem_out[3] = {topo_out->nmem(0), topo_out->nmem(1), topo_out->nmem(2)};
+    const size_t reset_size  = topo_out->memsize();
+
+    // reset the state of the requests: 0 = ongoing, 1 = completed (send) or shuffled (recv), 2 = copied (recv)
+    std::memset(send_state, 0, n_send_rqst * sizeof(int));
+    std::memset(recv_state, 0, n_recv_rqst * sizeof(int));
+
+    m_profStart(prof, "send/recv");
+#pragma omp parallel proc_bind(close)
+    {
+        const int tid  = omp_get_thread_num();
+        const int nthr = omp_get_num_threads();
+
+        // the requests owned by the thread are the ones with id = tid + k * nthr
+        const int my_n_send  = (n_send_rqst > tid) ? ((n_send_rqst - tid - 1) / nthr + 1) : 0;
+        const int my_n_recv  = (n_recv_rqst > tid) ? ((n_recv_rqst - tid - 1) / nthr + 1) : 0;
+        const int send_batch = schedule->batch();
+        const int max_nbsend = m_max(schedule->max_inflight() / nthr, 1);
+
+        int send_cntr     = 0;  // number of send started by the thread
+        int finished_send = 0;  // number of send completed by the thread
+        int copy_cntr     = 0;  // number of recv copied by the thread
+
+        // start all my receive requests, the self communication has no request
+        for (int ir = tid; ir < n_recv_rqst; ir += nthr) {
+            if (ir != self_recv) MPI_Start(recv_rqst + ir);
+        }
+
+        // test my receive requests and shuffle the completed ones
+        auto test_my_recv = [=]() {
+            for (int ir = tid; ir < n_recv_rqst; ir += nthr) {
+                if (recv_state[ir] == 0 && ir != self_recv) {
+                    int flag;
+                    MPI_Test(recv_rqst + ir, &flag, MPI_STATUS_IGNORE);
+                    if (flag) {
+                        DoShuffleChunk(recv_chunks + ir);
+                        recv_state[ir] = 1;
+                    }
+                }
+            }
+        };
+
+        //......................................................................
+        // [1] pack and start the sends, shuffle the recvs as they arrive
+        while (finished_send < my_n_send) {
+            const int n_to_send = m_min(my_n_send - send_cntr, m_min(send_batch, max_nbsend - (send_cntr - finished_send)));
+            for (int is = 0; is < n_to_send; ++is) {
+                const int    ridx    = tid + send_cntr * nthr;
+                const int    ichunk  = send_order_list[ridx];
+                MemChunk    *c_chunk = send_chunks + ichunk;
+                MPI_Request *c_rqst  = send_rqst + ridx;
+                send_cntr++;
+                // the self communication is copied and shuffled in one pass, the recv is then ready to be copied back after the barrier
+                if (ichunk == self_send) {
+                    CopyData2ShuffledChunk(nmem_in, mem, c_chunk, recv_chunks + self_recv);
+                    recv_state[self_recv] = 1;
+                    send_state[ridx]      = 1;
+                    finished_send++;
+                    continue;
+                }
+#if (FLUPS_MPI_PARTITIONED)
+                schedule->start_send(ridx);
+                MPI_Start(c_rqst);
+                CopyData2Chunk(nmem_in, mem, c_chunk);
+                MPI_Pready_range(0, send_npart[ichunk] - 1, c_rqst[0]);
+#else
+                CopyData2Chunk(nmem_in, mem, c_chunk);
+                schedule->start_send(ridx);
+                MPI_Start(c_rqst);
+#endif
+            }
+            for (int ks = 0; ks < send_cntr; ++ks) {
+                const int ridx = tid + ks * nthr;
+                if (send_state[ridx] == 0) {
+                    int flag;
+                    MPI_Test(send_rqst + ridx, &flag, MPI_STATUS_IGNORE);
+                    if (flag) schedule->end_send(ridx, send_order_list[ridx]);
+                    send_state[ridx] = flag;
+                    finished_send += flag;
+                }
+            }
+            test_my_recv();
+        }
+
+        //......................................................................
+        // [2] once every thread has completed its sends, reset the memory
+#pragma omp barrier
+#pragma omp for schedule(static)
+        for (size_t id = 0; id < reset_size; ++id) {
+            mem[id] = 0.0;
+        }
+
+        //......................................................................
+        // [3] copy the shuffled chunks and wait for the remaining ones
+        while (copy_cntr < my_n_recv) {
+            for (int ir = tid; ir < n_recv_rqst; ir += nthr) {
+                if (recv_state[ir] == 1) {
+                    CopyChunk2Data(recv_chunks + ir, nmem_out, mem);
+                    recv_state[ir] = 2;
+                    copy_cntr++;
+                }
+            }
+            test_my_recv();
+        }
+    }
+    m_profStop(prof, "send/recv");
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
@@ -7,7 +7,19 @@
 #define SRC_SWITCHTOPOX_NB_HPP_
 
 #include "SwitchTopoX.hpp"
+#include "SendSchedule.hpp"
+#include "omp.h"
 
+/**
+ * @brief Non-blocking implementation of the SwitchTopoX
+ *
+ * The chunks are sent with persistent requests (MPI_Send_init/MPI_Recv_init) and each received chunk is shuffled as soon as it arrives.
+ *
+ * With MPI_40 (FLUPS_MPI_PARTITIONED) the sends are partitioned: the threads mark their partition ready with MPI_Pready
+ * as soon as they have packed it. The receives use a single partition and MPI_Parrived is not used: the shuffle needs the
+ * full chunk, so a chunk is only unpacked once all its partitions have arrived.
+ *
+ */
 class SwitchTopoX_nb : public SwitchTopoX {
     int*     completed_id_ = nullptr;        //!< array used by the Wait/Test in the non-blocking comms
     int*     recv_order_   = nullptr;        //!< array used by the Wait/Test in the non-blocking comms
@@ -18,10 +30,19 @@ class SwitchTopoX_nb : public SwitchTopoX {
     int* i2o_send_order_ = nullptr;
     int* o2i_send_order_ = nullptr;
 
+    int* i2o_send_npart_ = nullptr;  //!< number of partitions used to send each i2o chunk (partitioned communications only)
+    int* o2i_send_npart_ = nullptr;  //!< number of partitions used to send each o2i chunk (partitioned communications only)
+
     MPI_Request* i2o_send_rqst_ = NULL;  //!< MPI send requests
     MPI_Request* i2o_recv_rqst_ = NULL;  //!< MPI recv requests
     MPI_Request* o2i_send_rqst_ = NULL;  //!< MPI send requests
     MPI_Request* o2i_recv_rqst_ = NULL;  //!< MPI recv requests
+    MPI_Request* direct_rqst_   = NULL;  //!< MPI recv requests of the chunks received directly in the memory (identity shuffle)
+
+    SendSchedule* i2o_schedule_ = nullptr;  //!< adaptive schedule of the i2o sends
+    SendSchedule* o2i_schedule_ = nullptr;  //!< adaptive schedule of the o2i sends
+
+    bool is_multithread_ = false;  //!< true if all the threads drive the communications (requires MPI_THREAD_MULTIPLE)
 
    public:
     explicit SwitchTopoX_nb(const Topology* topo_in, const Topology* topo_out, const int shift[3], H3LPR::Profiler* prof);
@@ -29,10 +50,11 @@ class SwitchTopoX_nb : public SwitchTopoX {
 
     virtual bool need_send_buf()const override{return true;};
     virtual bool need_recv_buf()const override{return true;};
+    virtual SwitchType switch_type()const override{return SWITCH_NB;};
 
 
-    virtual void setup_buffers(opt_double_ptr sendData, opt_double_ptr recvData) override;
-    virtual void execute(opt_double_ptr data, const int sign) const override;
+    virtual void setup_buffers(opt_real_ptr sendData, opt_real_ptr recvData) override;
+    virtual void execute(opt_real_ptr data, const int sign) const override;
     virtual void disp() const override;
 };
 
@@ -0,0 +1,282 @@
+/**
+ * @file SwitchTopoX_rma.cpp
+ * @copyright Copyright (c) Université catholique de Louvain (UCLouvain), Belgique
+ *      See LICENSE file in top-level directory
+*/
+#include "SwitchTopoX_rma.hpp"
+
+void PutRecv(const int n_send_chunk, MemChunk *send_chunks, const MPI_Aint *target_disp, const MPI_Group send_group,
+             const int n_recv_chunk, MemChunk *recv_chunks, const MPI_Group recv_group,
+             const int *send_order_list, MPI_Win win, const int self_send, const int self_recv,
+             const Topology *topo_in, const Topology *topo_out, opt_real_ptr mem, H3LPR::Profiler *prof);
+
+SwitchTopoX_rma::SwitchTopoX_rma(const Topology *topo_in, const Topology *topo_out, const int shift[3], H3LPR::Profiler *prof)
+    : SwitchTopoX(topo_in, topo_out, shift, prof) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    // nothing special to do here
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+void SwitchTopoX_rma::setup_buffers(opt_real_ptr sendData, opt_real_ptr recvData) {
+    BEGIN_FUNC;
+    FLUPS_CHECK(sendData != nullptr, "The send data must be != to nullptr");
+    FLUPS_CHECK(recvData != nullptr, "The recv data must be != to nullptr");
+    //--------------------------------------------------------------------------
+    // first setup the basic stuffs
+    this->SwitchTopoX::setup_buffers(sendData, recvData);
+    setup_floatTransport_();
+
+    int sub_rank, sub_size;
+    MPI_Comm_rank(subcomm_, &sub_rank);
+    MPI_Comm_size(subcomm_, &sub_size);
+
+    //..........................................................................
+    // create the windows on the buffers, the i2o chunks live in the send buffer, the o2i ones in the recv buffer
+    // we only use PSCW synchronization, so we can tell MPI that no lock will ever be used
+    MPI_Info info;
+    MPI_Info_create(&info);
+    MPI_Info_set(info, "no_locks", "true");
+    const MPI_Aint i2o_win_size = (MPI_Aint)(get_ChunkArraysMemSize(topo_in_->lda(), i2o_nchunks_, i2o_chunks_) * sizeof(flups_real));
+    const MPI_Aint o2i_win_size = (MPI_Aint)(get_ChunkArraysMemSize(topo_out_->lda(), o2i_nchunks_, o2i_chunks_) * sizeof(flups_real));
+    MPI_Win_create(send_buf_, i2o_win_size, sizeof(flups_real), info, subcomm_, &i2o_win_);
+    MPI_Win_create(recv_buf_, o2i_win_size, sizeof(flups_real), info, subcomm_, &o2i_win_);
+    MPI_Info_free(&info);
+
+    //..........................................................................
+    // get the position of the chunks in the windows of the destination ranks
+    // every rank gives the displacement of the chunk it receives from every other rank in the subcomm
+    // the displacements are stored per rank: we rely on having (at most) one chunk per rank in each direction
+    MPI_Aint *i2o_disp_from_rank = reinterpret_cast<MPI_Aint *>(m_calloc(sub_size * sizeof(MPI_Aint)));
+    MPI_Aint *o2i_disp_from_rank = reinterpret_cast<MPI_Aint *>(m_calloc(sub_size * sizeof(MPI_Aint)));
+    MPI_Aint *i2o_disp_to_rank   = reinterpret_cast<MPI_Aint *>(m_calloc(sub_size * sizeof(MPI_Aint)));
+    MPI_Aint *o2i_disp_to_rank   = reinterpret_cast<MPI_Aint *>(m_calloc(sub_size * sizeof(MPI_Aint)));
+    for (int ir = 0; ir < sub_size; ++ir) {
+        i2o_disp_from_rank[ir] = -1;
+        o2i_disp_from_rank[ir] = -1;
+    }
+    for (int ic = 0; ic < i2o_nchunks_; ++ic) {
+        FLUPS_CHECK(i2o_disp_from_rank[i2o_chunks_[ic].dest_rank] < 0, "the RMA switchtopo needs one i2o chunk per rank, rank %d has several", i2o_chunks_[ic].dest_rank);
+        i2o_disp_from_rank[i2o_chunks_[ic].dest_rank] = (MPI_Aint)(i2o_chunks_[ic].data - send_buf_);
+    }
+    for (int ic = 0; ic < o2i_nchunks_; ++ic) {
+        FLUPS_CHECK(o2i_disp_from_rank[o2i_chunks_[ic].dest_rank] < 0, "the RMA switchtopo needs one o2i chunk per rank, rank %d has several", o2i_chunks_[ic].dest_rank);
+        o2i_disp_from_rank[o2i_chunks_[ic].dest_rank] = (MPI_Aint)(o2i_chunks_[ic].data - recv_buf_);
+    }
+    MPI_Alltoall(i2o_disp_from_rank, 1, MPI_AINT, o2i_disp_to_rank, 1, MPI_AINT, subcomm_);
+    MPI_Alltoall(o2i_disp_from_rank, 1, MPI_AINT, i2o_disp_to_rank, 1, MPI_AINT, subcomm_);
+
+    // store the displacement of every chunk and the group of destination ranks
+    int *i2o_ranks   = reinterpret_cast<int *>(m_calloc(i2o_nchunks_ * sizeof(int)));
+    int *o2i_ranks   = reinterpret_cast<int *>(m_calloc(o2i_nchunks_ * sizeof(int)));
+    i2o_target_disp_ = reinterpret_cast<MPI_Aint *>(m_calloc(i2o_nchunks_ * sizeof(MPI_Aint)));
+    o2i_target_disp_ = reinterpret_cast<MPI_Aint *>(m_calloc(o2i_nchunks_ * sizeof(MPI_Aint)));
+    for (int ic = 0; ic < i2o_nchunks_; ++ic) {
+        i2o_ranks[ic]        = i2o_chunks_[ic].dest_rank;
+        i2o_target_disp_[ic] = i2o_disp_to_rank[i2o_ranks[ic]];
+        FLUPS_CHECK(i2o_target_disp_[ic] >= 0, "rank %d does not expect any chunk from me", i2o_ranks[ic]);
+    }
+    for (int ic = 0; ic < o2i_nchunks_; ++ic) {
+        o2i_ranks[ic]        = o2i_chunks_[ic].dest_rank;
+        o2i_target_disp_[ic] = o2i_disp_to_rank[o2i_ranks[ic]];
+        FLUPS_CHECK(o2i_target_disp_[ic] >= 0, "rank %d does not expect any chunk from me", o2i_ranks[ic]);
+    }
+
+    MPI_Group sub_group;
+    MPI_Comm_group(subcomm_, &sub_group);
+    MPI_Group_incl(sub_group, i2o_nchunks_, i2o_ranks, &i2o_group_);
+    MPI_Group_incl(sub_group, o2i_nchunks_, o2i_ranks, &o2i_group_);
+    MPI_Group_free(&sub_group);
+
+    m_free(i2o_ranks);
+    m_free(o2i_ranks);
+    m_free(i2o_disp_from_rank);
+    m_free(o2i_disp_from_rank);
+    m_free(i2o_disp_to_rank);
+    m_free(o2i_disp_to_rank);
+
+    //..........................................................................
+    // setup the order of the puts
+    i2o_send_order_ = reinterpret_cast<int *>(m_calloc(i2o_nchunks_ * sizeof(int)));
+    o2i_send_order_ = reinterpret_cast<int *>(m_calloc(o2i_nchunks_ * sizeof(int)));
+    for (int ir = 0; ir < i2o_nchunks_; ++ir) {
+#if (FLUPS_ROLLING_RANK)
+        i2o_send_order_[ir] = (ir + sub_rank) % i2o_nchunks_;
+#else
+        i2o_send_order_[ir] = ir;
+#endif
+    }
+    for (int ir = 0; ir < o2i_nchunks_; ++ir) {
+#if (FLUPS_ROLLING_RANK)
+        o2i_send_order_[ir] = (ir + sub_rank) % o2i_nchunks_;
+#else
+        o2i_send_order_[ir] = ir;
+#endif
+    }
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+SwitchTopoX_rma::~SwitchTopoX_rma() {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    if (i2o_win_ != MPI_WIN_NULL) MPI_Win_free(&i2o_win_);
+    if (o2i_win_ != MPI_WIN_NULL) MPI_Win_free(&o2i_win_);
+    if (i2o_group_ != MPI_GROUP_NULL) MPI_Group_free(&i2o_group_);
+    if (o2i_group_ != MPI_GROUP_NULL) MPI_Group_free(&o2i_group_);
+
+    m_free(i2o_target_disp_);
+    m_free(o2i_target_disp_);
+    m_free(i2o_send_order_);
+    m_free(o2i_send_order_);
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief Put the chunks in the destination windows, overlaping the packing with the communications
+ *
+ * @param v
+ * @param sign
+ */
+void SwitchTopoX_rma::execute(opt_real_ptr v, const int sign) const {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    m_profStarti(prof_, "Switchtopo%d_%s", idswitchtopo_, (FLUPS_FORWARD == sign) ? "forward" : "backward");
+    if (sign == FLUPS_FORWARD) {
+        PutRecv(i2o_nchunks_, i2o_chunks_, i2o_target_disp_, i2o_group_,
+                o2i_nchunks_, o2i_chunks_, o2i_group_,
+                i2o_send_order_, o2i_win_, i2o_selfcomm_, o2i_selfcomm_,
+                topo_in_, topo_out_, v, prof_);
+    } else {
+        PutRecv(o2i_nchunks_, o2i_chunks_, o2i_target_disp_, o2i_group_,
+                i2o_nchunks_, i2o_chunks_, i2o_group_,
+                o2i_send_order_, i2o_win_, o2i_selfcomm_, i2o_selfcomm_,
+                topo_out_, topo_in_, v, prof_);
+    }
+    m_profStopi(prof_, "Switchtopo%d_%s", idswitchtopo_, (FLUPS_FORWARD == sign) ? "forward" : "backward");
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+void SwitchTopoX_rma::disp() const {
+    BEGIN_FUNC;
+    FLUPS_INFO("------------------------------------------");
+    FLUPS_INFO("## Topo Swticher MPI - RMA");
+    FLUPS_INFO("--- INPUT");
+    FLUPS_INFO("  - input axis = %d", topo_in_->axis());
+    FLUPS_INFO("  - input local = %d %d %d", topo_in_->nloc(0), topo_in_->nloc(1), topo_in_->nloc(2));
+    FLUPS_INFO("  - input global = %d %d %d", topo_in_->nglob(0), topo_in_->nglob(1), topo_in_->nglob(2));
+    FLUPS_INFO("--- OUTPUT");
+    FLUPS_INFO("  - output axis = %d", topo_out_->axis());
+    FLUPS_INFO("  - output local = %d %d %d", topo_out_->nloc(0), topo_out_->nloc(1), topo_out_->nloc(2));
+    FLUPS_INFO("  - output global = %d %d %d", topo_out_->nglob(0), topo_out_->nglob(1), topo_out_->nglob(2));
+    FLUPS_INFO("------------------------------------------");
+}
+
+/**
+ * @brief pack and put the send chunks in the remote windows, then shuffle and copy the chunks received
+ *
+ * The exposure epoch is opened to the ranks that will write in our window and the access epoch to the ranks we write to.
+ * As the whole input is packed before the end of the access epoch, the memory can be reset while the puts are progressing.
+ * The self communication is not put in the window: it is copied and shuffled in one pass and copied back while the puts are progressing.
+ *
+ */
+void PutRecv(const int n_send_chunk, MemChunk *send_chunks, const MPI_Aint *target_disp, const MPI_Group send_group,
+             const int n_recv_chunk, MemChunk *recv_chunks, const MPI_Group recv_group,
+             const int *send_order_list, MPI_Win win, const int self_send, const int self_recv,
+             const Topology *topo_in, const Topology *topo_out, opt_real_ptr mem, H3LPR::Profiler *prof) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    // Get the memory arrangement
+    const int nmem_in[3]  = {topo_in->nmem(0), topo_in->nmem(1), topo_in->nmem(2)};
+    const int nmem_out[3] = {topo_out->nmem(0), topo_out->nmem(1), topo_out->nmem(2)};
+
+    //..........................................................................
+    m_profStart(prof, "send/recv");
+    m_profStart(prof, "pre-send");
+    m_profInitLeave(prof, "start");
+    {
+        // open the exposure epoch for the ranks sending to us and the access epoch on the ones we send to
+        m_profStart(prof, "start");
+        MPI_Win_post(recv_group, 0, win);
+        MPI_Win_start(send_group, 0, win);
+        m_profStop(prof, "start");
+    }
+    m_profStop(prof, "pre-send");
+
+    //..........................................................................
+    m_profStart(prof, "put");
+    m_profInitLeave(prof, "copy");
+    m_profInitLeave(prof, "start");
+    for (int ir = 0; ir < n_send_chunk; ++ir) {
+        const int chunk_idx = send_order_list[ir];
+        MemChunk *c_chunk   = send_chunks + chunk_idx;
+        FLUPS_INFO("putting %d/%d chunk with id = %d", ir, n_send_chunk, chunk_idx);
+
+        if (chunk_idx == self_send) {
+            m_profStart(prof, "copy");
+            CopyData2ShuffledChunk(nmem_in, mem, c_chunk, recv_chunks + self_recv);
+            m_profStop(prof, "copy");
+            continue;
+        }
+
+        // copy the memory
+        m_profStart(prof, "copy");
+        CopyData2Chunk(nmem_in, mem, c_chunk);
+        m_profStop(prof, "copy");
+
+        // put the chunk at its location in the destination window
+        m_profStart(prof, "start");
+#if (FLUPS_MPI_LARGE_COUNT)
+        const MPI_Count count = get_ChunkMsgSize(c_chunk);
+        MPI_Put_c(c_chunk->data, count, FLUPS_MPI_REAL, c_chunk->dest_rank, target_disp[chunk_idx], count, FLUPS_MPI_REAL, win);
+#else
+        MPI_Put(c_chunk->data, c_chunk->msg_count, c_chunk->msg_dtype, c_chunk->dest_rank, target_disp[chunk_idx], c_chunk->msg_count, c_chunk->msg_dtype, win);
+#endif
+        m_profStop(prof, "start");
+    }
+    m_profStop(prof, "put");
+
+    //..........................................................................
+    // everything has been packed, the memory can be reset before waiting for the data
+    {
+        const size_t reset_size = topo_out->memsize();
+        std::memset(mem, 0, reset_size * sizeof(flups_real));
+        FLUPS_INFO("reset mem done ");
+    }
+    if (self_recv >= 0) {
+        m_profStart(prof, "copy");
+        CopyChunk2Data(recv_chunks + self_recv, nmem_out, mem);
+        m_profStop(prof, "copy");
+    }
+
+    //..........................................................................
+    m_profStart(prof, "wait");
+    MPI_Win_complete(win);
+    MPI_Win_wait(win);
+    m_profStop(prof, "wait");
+
+    //..........................................................................
+    m_profStart(prof, "while loop");
+    m_profInitLeave(prof, "copy");
+    m_profInitLeave(prof, "shuffle");
+    for (int ir = 0; ir < n_recv_chunk; ++ir) {
+        if (ir == self_recv) continue;
+        MemChunk *chunk = recv_chunks + ir;
+        FLUPS_INFO("treating recv chunk %d/%d", ir, n_recv_chunk);
+        // shuffle the data
+        m_profStart(prof, "shuffle");
+        DoShuffleChunk(chunk);
+        m_profStop(prof, "shuffle");
+        // copy the data
+        m_profStart(prof, "copy");
+        CopyChunk2Data(chunk, nmem_out, mem);
+        m_profStop(prof, "copy");
+    }
+    m_profStop(prof, "while loop");
+    m_profStop(prof, "send/recv");
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
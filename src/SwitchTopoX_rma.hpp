@@ -0,0 +1,51 @@
+/**
+ * @file SwitchTopoX_rma.hpp
+ * @copyright Copyright (c) Université catholique de Louvain (UCLouvain), Belgique
+ *      See LICENSE file in top-level directory
+*/
+#ifndef SRC_SWITCHTOPOX_RMA_HPP_
+#define SRC_SWITCHTOPOX_RMA_HPP_
+
+#include "SwitchTopoX.hpp"
+
+/**
+ * @brief One-sided implementation of the SwitchTopoX
+ *
+ * Each rank exposes its communication buffers in two MPI windows (one over the send buffer, one over the recv buffer).
+ * The chunks are packed and directly MPI_Put in the buffer of the destination rank, at the position of the matching chunk.
+ * The synchronization relies on a PSCW epoch restricted to the ranks we actually communicate with.
+ * The epoch is closed by MPI_Win_complete and MPI_Win_wait before the first received chunk is shuffled: the chunks are not
+ * processed as they arrive, only the packing and the self copy overlap the puts.
+ * The post of the PSCW epoch is also what tells a rank that the shared recv buffer of its destination is free, a
+ * passive-target synchronization would require a similar handshake on top of the arrival flags.
+ *
+ * The displacements in the remote windows are exchanged per rank: every rank must own at most one chunk per direction.
+ *
+ */
+class SwitchTopoX_rma : public SwitchTopoX {
+    int* i2o_send_order_ = nullptr;  //!< order in which to perform the put for input to output
+    int* o2i_send_order_ = nullptr;  //!< order in which to perform the put for output to input
+
+    MPI_Aint* i2o_target_disp_ = nullptr;  //!< displacement of each i2o chunk in the window of its destination (o2i chunks of the dest)
+    MPI_Aint* o2i_target_disp_ = nullptr;  //!< displacement of each o2i chunk in the window of its destination (i2o chunks of the dest)
+
+    MPI_Group i2o_group_ = MPI_GROUP_NULL;  //!< group of the ranks owning the destination of the i2o chunks
+    MPI_Group o2i_group_ = MPI_GROUP_NULL;  //!< group of the ranks owning the destination of the o2i chunks
+
+    MPI_Win i2o_win_ = MPI_WIN_NULL;  //!< window exposing the memory of the i2o chunks (written during the backward switch)
+    MPI_Win o2i_win_ = MPI_WIN_NULL;  //!< window exposing the memory of the o2i chunks (written during the forward switch)
+
+   public:
+    explicit SwitchTopoX_rma(const Topology* topo_in, const Topology* topo_out, const int shift[3], H3LPR::Profiler* prof);
+    ~SwitchTopoX_rma();
+
+    virtual bool need_send_buf() const override { return true; };
+    virtual bool need_recv_buf() const override { return true; };
+    virtual SwitchType switch_type() const override { return SWITCH_RMA; };
+
+    virtual void setup_buffers(opt_real_ptr sendData, opt_real_ptr recvData) override;
+    virtual void execute(opt_real_ptr data, const int sign) const override;
+    virtual void disp() const override;
+};
+
+#endif
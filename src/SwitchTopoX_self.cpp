@@ -0,0 +1,143 @@
+/**
+ * @file SwitchTopoX_self.cpp
+ * @copyright Copyright (c) Université catholique de Louvain (UCLouvain), Belgique
+ *      See LICENSE file in top-level directory
+*/
+#include "SwitchTopoX_self.hpp"
+
+void SelfTranspose(const MemChunk *src_chunk, MemChunk *trg_chunk, const Topology *topo_in, const Topology *topo_out, opt_real_ptr mem, H3LPR::Profiler *prof);
+
+SwitchTopoX_self::SwitchTopoX_self(const Topology *topo_in, const Topology *topo_out, const int shift[3], H3LPR::Profiler *prof)
+    : SwitchTopoX(topo_in, topo_out, shift, prof) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    // nothing special to do here
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief Setup the chunks without any collective call
+ *
+ * The only partner of the rank is itself, its subcommunicator is a duplicate of MPI_COMM_SELF.
+ *
+ * @param cache not used, the subcommunicator is not shared
+ */
+void SwitchTopoX_self::setup(SubCommCache *cache) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    inComm_  = topo_in_->get_comm();
+    outComm_ = topo_out_->get_comm();
+
+    PopulateChunks_(&i2o_nchunks_, &i2o_chunks_, &o2i_nchunks_, &o2i_chunks_);
+    FLUPS_CHECK(i2o_nchunks_ == 1 && o2i_nchunks_ == 1, "the self switchtopo requires a single chunk in each direction: %d and %d", i2o_nchunks_, o2i_nchunks_);
+
+    // the chunks are sent to ourselves, which is rank 0 of the subcomm
+    MPI_Comm_dup(MPI_COMM_SELF, &subcomm_);
+    i2o_chunks_[0].comm      = subcomm_;
+    i2o_chunks_[0].dest_rank = 0;
+    o2i_chunks_[0].comm      = subcomm_;
+    o2i_chunks_[0].dest_rank = 0;
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief Assign the recv buffer to the chunks
+ *
+ * The transposition goes through the target chunk only, neither the shuffle nor the packing are used.
+ *
+ * @param sendData not used
+ * @param recvData
+ */
+void SwitchTopoX_self::setup_buffers(opt_real_ptr sendData, opt_real_ptr recvData) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    send_buf_ = recvData;
+    recv_buf_ = recvData;
+
+    // both chunks describe the same block, they can share the memory
+    i2o_chunks_[0].data = recv_buf_;
+    o2i_chunks_[0].data = recv_buf_;
+    i2o_selfcomm_       = 0;
+    o2i_selfcomm_       = 0;
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief Transpose the data from one layout to the other without any communication
+ *
+ * @param v
+ * @param sign
+ */
+void SwitchTopoX_self::execute(opt_real_ptr v, const int sign) const {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    m_profStarti(prof_, "Switchtopo%d_%s", idswitchtopo_, (FLUPS_FORWARD == sign) ? "forward" : "backward");
+
+    if (sign == FLUPS_FORWARD) {
+        SelfTranspose(i2o_chunks_, o2i_chunks_, topo_in_, topo_out_, v, prof_);
+    } else {
+        SelfTranspose(o2i_chunks_, i2o_chunks_, topo_out_, topo_in_, v, prof_);
+    }
+
+    m_profStopi(prof_, "Switchtopo%d_%s", idswitchtopo_, (FLUPS_FORWARD == sign) ? "forward" : "backward");
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+void SwitchTopoX_self::disp() const {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    FLUPS_INFO("------------------------------------------");
+    FLUPS_INFO("## Topo Switcher self");
+    FLUPS_INFO("--- INPUT");
+    FLUPS_INFO("  - input axis = %d", topo_in_->axis());
+    FLUPS_INFO("  - input local = %d %d %d", topo_in_->nloc(0), topo_in_->nloc(1), topo_in_->nloc(2));
+    FLUPS_INFO("  - input global = %d %d %d", topo_in_->nglob(0), topo_in_->nglob(1), topo_in_->nglob(2));
+    FLUPS_INFO("--- OUTPUT");
+    FLUPS_INFO("  - output axis = %d", topo_out_->axis());
+    FLUPS_INFO("  - output local = %d %d %d", topo_out_->nloc(0), topo_out_->nloc(1), topo_out_->nloc(2));
+    FLUPS_INFO("  - output global = %d %d %d", topo_out_->nglob(0), topo_out_->nglob(1), topo_out_->nglob(2));
+    FLUPS_INFO("------------------------------------------");
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief transpose the block owned by the rank from topo_in to topo_out
+ *
+ * The block is first transposed in the chunk (which lives in the recv buffer), then the memory outside of the block
+ * is reset and the chunk is copied back to the memory in the layout of topo_out.
+ *
+ * @param src_chunk the chunk in the layout of topo_in
+ * @param trg_chunk the chunk in the layout of topo_out
+ * @param topo_in
+ * @param topo_out
+ * @param mem
+ * @param prof
+ */
+void SelfTranspose(const MemChunk *src_chunk, MemChunk *trg_chunk, const Topology *topo_in, const Topology *topo_out, opt_real_ptr mem, H3LPR::Profiler *prof) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    const int nmem_in[3]  = {topo_in->nmem(0), topo_in->nmem(1), topo_in->nmem(2)};
+    const int nmem_out[3] = {topo_out->nmem(0), topo_out->nmem(1), topo_out->nmem(2)};
+
+    m_profStarti(prof, "self copy");
+    CopyData2ShuffledChunk(nmem_in, mem, src_chunk, trg_chunk);
+    m_profStopi(prof, "self copy");
+
+    // reset the memory to 0.0 as we do inplace computations, the block is overwritten by the copy anyway
+    m_profStarti(prof, "reset memory");
+    const int box[6] = {trg_chunk->istart[0], trg_chunk->istart[1], trg_chunk->istart[2],
+                        trg_chunk->istart[0] + trg_chunk->isize[0], trg_chunk->istart[1] + trg_chunk->isize[1], trg_chunk->istart[2] + trg_chunk->isize[2]};
+    ResetOutsideBox(trg_chunk, box, nmem_out, topo_out->memsize(), mem);
+    m_profStopi(prof, "reset memory");
+
+    m_profStarti(prof, "copy chunk 2 data");
+    CopyChunk2Data(trg_chunk, nmem_out, mem);
+    m_profStopi(prof, "copy chunk 2 data");
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
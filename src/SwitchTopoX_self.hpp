@@ -0,0 +1,34 @@
+/**
+ * @file SwitchTopoX_self.hpp
+ * @copyright Copyright (c) Université catholique de Louvain (UCLouvain), Belgique
+ *      See LICENSE file in top-level directory
+*/
+#ifndef SRC_SWITCHTOPOX_SELF_HPP_
+#define SRC_SWITCHTOPOX_SELF_HPP_
+
+#include "SwitchTopoX.hpp"
+
+/**
+ * @brief Communication-free implementation of the SwitchTopoX, used when the topologies live on a single rank
+ *
+ * The whole block is owned by the rank itself: the switch reduces to a threaded and cache-blocked transposition
+ * from the input layout to the output one, done through a single chunk of the recv buffer. No MPI call is issued and
+ * the setup is local to the rank: there is no split of the communicator and no tuning of the packing.
+ *
+ */
+class SwitchTopoX_self : public SwitchTopoX {
+   public:
+    explicit SwitchTopoX_self(const Topology* topo_in, const Topology* topo_out, const int shift[3], H3LPR::Profiler* prof);
+    ~SwitchTopoX_self(){};
+
+    virtual bool need_send_buf() const override { return false; };
+    virtual bool need_recv_buf() const override { return true; };
+    virtual SwitchType switch_type() const override { return SWITCH_SELF; };
+
+    virtual void setup(SubCommCache *cache = NULL) override;
+    virtual void setup_buffers(opt_real_ptr sendData, opt_real_ptr recvData) override;
+    virtual void execute(opt_real_ptr data, const int sign) const override;
+    virtual void disp() const override;
+};
+
+#endif
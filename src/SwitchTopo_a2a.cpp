@@ -351,20 +351,20 @@ SwitchTopo_a2a::~SwitchTopo_a2a() {
     if (i2o_start_ != NULL) m_free(i2o_start_);
     if (o2i_start_ != NULL) m_free(o2i_start_);
 
-    if (sendBuf_ != NULL) m_free((double*)sendBuf_);
-    if (recvBuf_ != NULL) m_free((double*)recvBuf_);
+    if (sendBuf_ != NULL) m_free((flups_real*)sendBuf_);
+    if (recvBuf_ != NULL) m_free((flups_real*)recvBuf_);
 
     free_blockInfo_();
 
     if (i2o_shuffle_ != NULL) {
         for (int ib = 0; ib < onBlock_; ib++) {
-            fftw_destroy_plan(i2o_shuffle_[ib]);
+            FLUPS_FFTW(destroy_plan)(i2o_shuffle_[ib]);
         }
         m_free(i2o_shuffle_);
     }
     if (o2i_shuffle_ != NULL) {
         for (int ib = 0; ib < inBlock_; ib++) {
-            fftw_destroy_plan(o2i_shuffle_[ib]);
+            FLUPS_FFTW(destroy_plan)(o2i_shuffle_[ib]);
         }
         m_free(o2i_shuffle_);
     }
@@ -383,7 +383,7 @@ SwitchTopo_a2a::~SwitchTopo_a2a() {
  * @param sendData the "raw" communication buffer allocated at least at the size returned by get_bufMemSize 
  * @param recvData the "raw" communication buffer allocated at least at the size returned by get_bufMemSize 
  */
-void SwitchTopo_a2a::setup_buffers(opt_double_ptr sendData, opt_double_ptr recvData) {
+void SwitchTopo_a2a::setup_buffers(opt_real_ptr sendData, opt_real_ptr recvData) {
     BEGIN_FUNC;
 
     // determine the nf: since topo_in may have change, we take the max to have the correct one
@@ -399,15 +399,15 @@ void SwitchTopo_a2a::setup_buffers(opt_double_ptr sendData, opt_double_ptr recvD
     MPI_Comm_size(subcomm_, &subsize);
 
     // allocate the second layer of buffers
-    sendBuf_ = (double**)m_calloc(inBlock_ * sizeof(double*));
-    recvBuf_ = (double**)m_calloc(onBlock_ * sizeof(double*));
+    sendBuf_ = (flups_real**)m_calloc(inBlock_ * sizeof(flups_real*));
+    recvBuf_ = (flups_real**)m_calloc(onBlock_ * sizeof(flups_real*));
 
     // determine if we have to suffle or not
     const bool doShuffle=(topo_in_->axis() != topo_out_->axis());
     // allocate the plan if we have to suffle
     if (doShuffle) {
-        i2o_shuffle_ = (fftw_plan*)m_calloc(onBlock_ * sizeof(fftw_plan));
-        o2i_shuffle_ = (fftw_plan*)m_calloc(inBlock_ * sizeof(fftw_plan));
+        i2o_shuffle_ = (FLUPS_FFTW(plan)*)m_calloc(onBlock_ * sizeof(FLUPS_FFTW(plan)));
+        o2i_shuffle_ = (FLUPS_FFTW(plan)*)m_calloc(inBlock_ * sizeof(FLUPS_FFTW(plan)));
     } else {
         i2o_shuffle_ = NULL;
         o2i_shuffle_ = NULL;
@@ -489,7 +489,7 @@ void SwitchTopo_a2a::setup_buffers(opt_double_ptr sendData, opt_double_ptr recvD
  * -----------------------------------------------
  * We do the following:
  */
-void SwitchTopo_a2a::execute(double* v, const int sign) const {
+void SwitchTopo_a2a::execute(flups_real* v, const int sign) const {
     BEGIN_FUNC;
 
     FLUPS_CHECK(topo_in_->isComplex() == topo_out_->isComplex(), "both topologies have to be complex or real");
@@ -533,12 +533,12 @@ void SwitchTopo_a2a::execute(double* v, const int sign) const {
 
     // const int nByBlock[3] = {nByBlock_[0], nByBlock_[1], nByBlock_[2]};
 
-    fftw_plan* shuffle = NULL;
+    FLUPS_FFTW(plan)* shuffle = NULL;
 
-    opt_double_ptr* sendBuf;
-    opt_double_ptr* recvBuf;
-    opt_double_ptr sendBufG;
-    opt_double_ptr recvBufG;
+    opt_real_ptr* sendBuf;
+    opt_real_ptr* recvBuf;
+    opt_real_ptr sendBufG;
+    opt_real_ptr recvBufG;
 
     if (sign == FLUPS_FORWARD) {
         topo_in  = topo_in_;
@@ -673,7 +673,7 @@ void SwitchTopo_a2a::execute(double* v, const int sign) const {
             // the data is aligned if the starting index is aligned AND if the gap between two entries, inmem[iax0] is a multiple of the alignment
             FLUPS_INFO_3("block %d: Moving the pointer by %d %d %d elements", bid, iBlockiStart[0][bid], iBlockiStart[1][bid], iBlockiStart[2][bid]);
             FLUPS_INFO_3("block %d: Tackling a block of size %d %d %d", bid, iBlockSize[0][bid], iBlockSize[1][bid], iBlockSize[2][bid]);
-            double* my_v = v + localIndex(iax0, iBlockiStart[iax0][bid], iBlockiStart[iax1][bid], iBlockiStart[iax2][bid], iax0, inmem, nf, lia);
+            flups_real* my_v = v + localIndex(iax0, iBlockiStart[iax0][bid], iBlockiStart[iax1][bid], iBlockiStart[iax2][bid], iax0, inmem, nf, lia);
 
             const bool isVectorAligned = FLUPS_ISALIGNED(my_v) && inmem[iax0] % FLUPS_ALIGNMENT == 0;
 
@@ -688,8 +688,8 @@ void SwitchTopo_a2a::execute(double* v, const int sign) const {
                     // get the local starting location for the buffer and the field.
                     //   my_v has already set the address in the right portion of lda, so now,
                     //   only running over the chunks as if lda=1
-                    const opt_double_ptr vloc = my_v + localIndex(iax0, 0, i1, i2, iax0, inmem, nf, 0);
-                    opt_double_ptr dataloc    = sendBuf[bid] + id * nmax + lia * blockSize;
+                    const opt_real_ptr vloc = my_v + localIndex(iax0, 0, i1, i2, iax0, inmem, nf, 0);
+                    opt_real_ptr dataloc    = sendBuf[bid] + id * nmax + lia * blockSize;
                     // set the alignment
                     FLUPS_ASSUME_ALIGNED(vloc, FLUPS_ALIGNMENT);
                     FLUPS_ASSUME_ALIGNED(dataloc, FLUPS_ALIGNMENT);
@@ -708,8 +708,8 @@ void SwitchTopo_a2a::execute(double* v, const int sign) const {
                     // get the local starting location for the buffer and the field
                     //   my_v has already set the address in the right portion of lda, so now,
                     //   only running over the chunks as if lda=1
-                    const double* __restrict vloc = my_v + localIndex(iax0, 0, i1, i2, iax0, inmem, nf, 0);
-                    opt_double_ptr dataloc        = sendBuf[bid] + lia * blockSize + id * nmax ;
+                    const flups_real* __restrict vloc = my_v + localIndex(iax0, 0, i1, i2, iax0, inmem, nf, 0);
+                    opt_real_ptr dataloc        = sendBuf[bid] + lia * blockSize + id * nmax ;
                     // set the alignment
                     FLUPS_ASSUME_ALIGNED(dataloc, FLUPS_ALIGNMENT);
                     // do the copy -> vectorized
@@ -727,8 +727,8 @@ void SwitchTopo_a2a::execute(double* v, const int sign) const {
                     // get the local starting location for the buffer and the field
                     //   my_v has already set the address in the right portion of lda, so now,
                     //   only running over the chunks as if lda=1
-                    const opt_double_ptr vloc  = my_v + localIndex(iax0, 0, i1, i2, iax0, inmem, nf, 0);
-                    double* __restrict dataloc = sendBuf[bid] + lia * blockSize + id * nmax ;
+                    const opt_real_ptr vloc  = my_v + localIndex(iax0, 0, i1, i2, iax0, inmem, nf, 0);
+                    flups_real* __restrict dataloc = sendBuf[bid] + lia * blockSize + id * nmax ;
                     // set the alignment
                     FLUPS_ASSUME_ALIGNED(vloc, FLUPS_ALIGNMENT);
                     // do the copy -> vectorized
@@ -746,8 +746,8 @@ void SwitchTopo_a2a::execute(double* v, const int sign) const {
                     // get the local starting location for the buffer and the field
                     //   my_v has already set the address in the right portion of lda, so now,
                     //   only running over the chunks as if lda=1
-                    const double* __restrict vloc = my_v + localIndex(iax0, 0, i1, i2, iax0, inmem, nf, 0);
-                    double* __restrict dataloc = sendBuf[bid] + lia * blockSize + id * nmax ;
+                    const flups_real* __restrict vloc = my_v + localIndex(iax0, 0, i1, i2, iax0, inmem, nf, 0);
+                    flups_real* __restrict dataloc = sendBuf[bid] + lia * blockSize + id * nmax ;
 
                     // do the copy -> vectorized
                     for (size_t i0 = 0; i0 < nmax; i0++) {
@@ -765,12 +765,12 @@ void SwitchTopo_a2a::execute(double* v, const int sign) const {
     //-------------------------------------------------------------------------
     if (is_all2all_) {
         m_profStarti(prof_,"all_2_all%d",iswitch_);
-        MPI_Alltoall(sendBufG, send_count[0], MPI_DOUBLE, recvBufG, recv_count[0], MPI_DOUBLE, subcomm_);
+        MPI_Alltoall(sendBufG, send_count[0], FLUPS_MPI_REAL, recvBufG, recv_count[0], FLUPS_MPI_REAL, subcomm_);
         m_profStopi(prof_, "all_2_all%d", iswitch_);
 
     } else {
         m_profStarti(prof_,"all_2_all_v%d",iswitch_);
-        MPI_Alltoallv(sendBufG, send_count, send_start, MPI_DOUBLE, recvBufG, recv_count, recv_start, MPI_DOUBLE, subcomm_);
+        MPI_Alltoallv(sendBufG, send_count, send_start, FLUPS_MPI_REAL, recvBufG, recv_count, recv_start, FLUPS_MPI_REAL, subcomm_);
         m_profStopi(prof_, "all_2_all_v%d", iswitch_);
     }
 
@@ -780,7 +780,7 @@ void SwitchTopo_a2a::execute(double* v, const int sign) const {
     // reset the memory to 0
     const size_t nmax = topo_out->memsize();
     if (FLUPS_ISALIGNED(v)) {
-        opt_double_ptr my_v = v;
+        opt_real_ptr my_v = v;
         // tell the compiler about alignment
         FLUPS_ASSUME_ALIGNED(my_v, FLUPS_ALIGNMENT);
 #pragma omp parallel for default(none) proc_bind(close) firstprivate(my_v, nmax)
@@ -788,7 +788,7 @@ void SwitchTopo_a2a::execute(double* v, const int sign) const {
             my_v[id] = 0.0;
         }
     } else {
-        double* __restrict my_v = v;
+        flups_real* __restrict my_v = v;
 #pragma omp parallel for default(none) proc_bind(close) firstprivate(my_v, nmax)
         for (size_t id = 0; id < nmax; id++) {
             my_v[id] = 0.0;
@@ -818,9 +818,9 @@ void SwitchTopo_a2a::execute(double* v, const int sign) const {
                 for (int lia = 0; lia < lda; lia++){
                     // fftw_execute(shuffle[bid]);
                     if( nf == 1){
-                        fftw_execute_r2r(shuffle[bid], recvBuf[bid] + lia * blockSize , recvBuf[bid] + lia * blockSize);
+                        FLUPS_FFTW(execute_r2r)(shuffle[bid], recvBuf[bid] + lia * blockSize , recvBuf[bid] + lia * blockSize);
                     } else {
-                        fftw_execute_dft(shuffle[bid], (opt_complex_ptr) (recvBuf[bid] + lia * blockSize),(opt_complex_ptr)  (recvBuf[bid] + lia * blockSize));
+                        FLUPS_FFTW(execute_dft)(shuffle[bid], (opt_complex_ptr) (recvBuf[bid] + lia * blockSize),(opt_complex_ptr)  (recvBuf[bid] + lia * blockSize));
                     }
                 }
             }
@@ -844,7 +844,7 @@ void SwitchTopo_a2a::execute(double* v, const int sign) const {
             // the buffer is aligned if the starting id is aligned and if nmax is a multiple of the alignement
             const bool isBuffAligned = FLUPS_ISALIGNED(recvBuf[bid] + lia * blockSize) &&  nmax%FLUPS_ALIGNMENT == 0;
             // the data is aligned if the starting index is aligned AND if the gap between two entries, inmem[iax0] is a multiple of the alignment
-            double*    my_v            = v + localIndex(oax0, oBlockiStart[oax0][bid], oBlockiStart[oax1][bid], oBlockiStart[oax2][bid], oax0, onmem, nf, lia);
+            flups_real*    my_v            = v + localIndex(oax0, oBlockiStart[oax0][bid], oBlockiStart[oax1][bid], oBlockiStart[oax2][bid], oax0, onmem, nf, lia);
             const bool isVectorAligned = FLUPS_ISALIGNED(my_v) && onmem[oax0] % FLUPS_ALIGNMENT == 0;
 
             //choose the correct loop to improve the efficiency
@@ -857,8 +857,8 @@ void SwitchTopo_a2a::execute(double* v, const int sign) const {
                     // get the local starting id for the buffer and the data
                     //   my_v has already set the address in the right portion of lda, so now,
                     //   only running over the chunks as if lda=1
-                    opt_double_ptr       vloc    = my_v + localIndex(oax0, 0, i1, i2, oax0, onmem, nf, 0);
-                    const opt_double_ptr dataloc = recvBuf[bid] + lia * blockSize + id * nmax;
+                    opt_real_ptr       vloc    = my_v + localIndex(oax0, 0, i1, i2, oax0, onmem, nf, 0);
+                    const opt_real_ptr dataloc = recvBuf[bid] + lia * blockSize + id * nmax;
                     // tell the compiler about alignment
                     FLUPS_ASSUME_ALIGNED(vloc, FLUPS_ALIGNMENT);
                     FLUPS_ASSUME_ALIGNED(dataloc, FLUPS_ALIGNMENT);
@@ -876,8 +876,8 @@ void SwitchTopo_a2a::execute(double* v, const int sign) const {
                     // get the local starting id for the buffer and the data
                     //   my_v has already set the address in the right portion of lda, so now,
                     //   only running over the chunks as if lda=1
-                    double* __restrict vloc      = my_v + localIndex(oax0, 0, i1, i2, oax0, onmem, nf, 0);
-                    const opt_double_ptr dataloc = recvBuf[bid] + lia * blockSize + id * nmax;
+                    flups_real* __restrict vloc      = my_v + localIndex(oax0, 0, i1, i2, oax0, onmem, nf, 0);
+                    const opt_real_ptr dataloc = recvBuf[bid] + lia * blockSize + id * nmax;
                     // tell the compiler about alignment
                     FLUPS_ASSUME_ALIGNED(dataloc, FLUPS_ALIGNMENT);
                     // do the copy
@@ -894,8 +894,8 @@ void SwitchTopo_a2a::execute(double* v, const int sign) const {
                     // get the local starting id for the buffer and the data
                     //   my_v has already set the address in the right portion of lda, so now,
                     //   only running over the chunks as if lda=1
-                    opt_double_ptr vloc              = my_v + localIndex(oax0, 0, i1, i2, oax0, onmem, nf, 0);
-                    const double* __restrict dataloc = recvBuf[bid] + lia * blockSize + id * nmax;
+                    opt_real_ptr vloc              = my_v + localIndex(oax0, 0, i1, i2, oax0, onmem, nf, 0);
+                    const flups_real* __restrict dataloc = recvBuf[bid] + lia * blockSize + id * nmax;
                     // tell the compiler about alignment
                     FLUPS_ASSUME_ALIGNED(vloc, FLUPS_ALIGNMENT);
                     // do the copy
@@ -912,8 +912,8 @@ void SwitchTopo_a2a::execute(double* v, const int sign) const {
                     // get the local starting id for the buffer and the data
                     //   my_v has already set the address in the right portion of lda, so now,
                     //   only running over the chunks as if lda=1
-                    double* __restrict vloc          = my_v + localIndex(oax0, 0, i1, i2, oax0, onmem, nf, 0);
-                    const double* __restrict dataloc = recvBuf[bid] + lia * blockSize + id * nmax;
+                    flups_real* __restrict vloc          = my_v + localIndex(oax0, 0, i1, i2, oax0, onmem, nf, 0);
+                    const flups_real* __restrict dataloc = recvBuf[bid] + lia * blockSize + id * nmax;
                     // do the copy
                     for (size_t i0 = 0; i0 < nmax; i0++) {
                         vloc[i0] = dataloc[i0];
@@ -983,7 +983,7 @@ void SwitchTopo_a2a_test() {
         topo->disp();
         topobig->disp();
 
-        double* data = (double*)m_calloc(sizeof(double) * std::max(topo->memsize(), topobig->memsize()));
+        flups_real* data = (flups_real*)m_calloc(sizeof(flups_real) * std::max(topo->memsize(), topobig->memsize()));
 
         const int nmem[3] = {topo->nmem(0), topo->nmem(1), topo->nmem(2)};
         for (int i2 = 0; i2 < topo->nloc(2); i2++) {
@@ -991,7 +991,7 @@ void SwitchTopo_a2a_test() {
                 for (int i0 = 0; i0 < topo->nloc(0); i0++) {
                     const size_t id = localIndex(0, i0, i1, i2, 0, nmem, 1, 0);
 
-                    data[id] = (double)id;
+                    data[id] = (flups_real)id;
                 }
             }
         }
@@ -1003,10 +1003,10 @@ void SwitchTopo_a2a_test() {
         SwitchTopo*    switchtopo = new SwitchTopo_a2a(topo, topobig, fieldstart, NULL);
         switchtopo->setup();
         size_t         max_mem    = switchtopo->get_bufMemSize();
-        opt_double_ptr send_buff  = (opt_double_ptr)m_calloc(max_mem * sizeof(double));
-        opt_double_ptr recv_buff  = (opt_double_ptr)m_calloc(max_mem * sizeof(double));
-        std::memset(send_buff, 0, max_mem * sizeof(double));
-        std::memset(recv_buff, 0, max_mem * sizeof(double));
+        opt_real_ptr send_buff  = (opt_real_ptr)m_calloc(max_mem * sizeof(flups_real));
+        opt_real_ptr recv_buff  = (opt_real_ptr)m_calloc(max_mem * sizeof(flups_real));
+        std::memset(send_buff, 0, max_mem * sizeof(flups_real));
+        std::memset(recv_buff, 0, max_mem * sizeof(flups_real));
         // associate the buffer
         switchtopo->setup_buffers(send_buff, recv_buff);
         switchtopo->disp();
@@ -1022,8 +1022,8 @@ void SwitchTopo_a2a_test() {
         MPI_Barrier(MPI_COMM_WORLD);
 
         m_free(data);
-        m_free((double*)send_buff);
-        m_free((double*)recv_buff);
+        m_free((flups_real*)send_buff);
+        m_free((flups_real*)recv_buff);
         delete (switchtopo);
         delete (topo);
         delete (topobig);
@@ -1035,7 +1035,7 @@ void SwitchTopo_a2a_test() {
         Topology* topo    = new Topology(0, 1, nglob, nproc, true, NULL, 1, MPI_COMM_WORLD);
         Topology* topobig = new Topology(1, 1, nglob_big, nproc_big, true, NULL, 1, MPI_COMM_WORLD);
 
-        double* data = (double*)m_calloc(sizeof(double) * std::max(topo->memsize(), topobig->memsize()));
+        flups_real* data = (flups_real*)m_calloc(sizeof(flups_real) * std::max(topo->memsize(), topobig->memsize()));
 
         const int nmem2[3] = {topo->nmem(0), topo->nmem(1), topo->nmem(2)};
         for (int i2 = 0; i2 < topo->nloc(2); i2++) {
@@ -1061,10 +1061,10 @@ void SwitchTopo_a2a_test() {
         switchtopo->setup();
         switchtopo->disp();
         size_t         max_mem   = switchtopo->get_bufMemSize();
-        opt_double_ptr send_buff = (opt_double_ptr)m_calloc(max_mem * sizeof(double));
-        opt_double_ptr recv_buff = (opt_double_ptr)m_calloc(max_mem * sizeof(double));
-        std::memset(send_buff, 0, max_mem * sizeof(double));
-        std::memset(recv_buff, 0, max_mem * sizeof(double));
+        opt_real_ptr send_buff = (opt_real_ptr)m_calloc(max_mem * sizeof(flups_real));
+        opt_real_ptr recv_buff = (opt_real_ptr)m_calloc(max_mem * sizeof(flups_real));
+        std::memset(send_buff, 0, max_mem * sizeof(flups_real));
+        std::memset(recv_buff, 0, max_mem * sizeof(flups_real));
         // associate the buffer
         switchtopo->setup_buffers(send_buff, recv_buff);
 
@@ -1153,7 +1153,7 @@ void SwitchTopo_a2a_test2() {
         topo->disp_rank();
         topobig->disp_rank();
 
-        double* data = (double*)m_calloc(sizeof(double) * std::max(topo->memsize(), topobig->memsize()));       
+        flups_real* data = (flups_real*)m_calloc(sizeof(flups_real) * std::max(topo->memsize(), topobig->memsize()));       
 
         //Filling data (AFTER having assigned topo to a new topo)
         const int nmem[3] = {topo->nmem(0), topo->nmem(1), topo->nmem(2)};
@@ -1166,7 +1166,7 @@ void SwitchTopo_a2a_test2() {
 
                     // data[id] = (double)(i0+istart[0] + i1+istart[1] + i2+istart[2]);
                     // data[id] = (double)((i0+istart[0])/4 + (i1+istart[1])/4 + (i2+istart[2])/4);
-                    data[id] = (double)( (i1+istart[1])/4 + 6*((i2+istart[2])/4));
+                    data[id] = (flups_real)( (i1+istart[1])/4 + 6*((i2+istart[2])/4));
                 }
             }
         }
@@ -1181,10 +1181,10 @@ void SwitchTopo_a2a_test2() {
         // associate the buffer
         switchtopo->setup();
         size_t         max_mem    = switchtopo->get_bufMemSize();
-        opt_double_ptr send_buff  = (opt_double_ptr)m_calloc(max_mem * sizeof(double));
-        opt_double_ptr recv_buff  = (opt_double_ptr)m_calloc(max_mem * sizeof(double));
-        std::memset(send_buff, 0, max_mem * sizeof(double));
-        std::memset(recv_buff, 0, max_mem * sizeof(double));
+        opt_real_ptr send_buff  = (opt_real_ptr)m_calloc(max_mem * sizeof(flups_real));
+        opt_real_ptr recv_buff  = (opt_real_ptr)m_calloc(max_mem * sizeof(flups_real));
+        std::memset(send_buff, 0, max_mem * sizeof(flups_real));
+        std::memset(recv_buff, 0, max_mem * sizeof(flups_real));
         switchtopo->setup_buffers(send_buff, recv_buff);
         switchtopo->disp();
 
@@ -1201,8 +1201,8 @@ void SwitchTopo_a2a_test2() {
         MPI_Barrier(MPI_COMM_WORLD);
 
         m_free(data);
-        m_free((double*)send_buff);
-        m_free((double*)recv_buff);
+        m_free((flups_real*)send_buff);
+        m_free((flups_real*)recv_buff);
         delete (switchtopo);
         delete (topo);
         delete (topobig);
@@ -40,8 +40,8 @@ class SwitchTopo_a2a : public SwitchTopo {
     int *i2o_start_ = NULL; /**<@brief start argument of the all_to_all_v for input to output */
     int *o2i_start_ = NULL; /**<@brief start argument of the all_to_all_v for output to input */
 
-    opt_double_ptr sendBufG_ = NULL; /**<@brief pointer to the globally allocated memory for the send buffers */
-    opt_double_ptr recvBufG_ = NULL; /**<@brief pointer to the globally allocated memory for the recv buffers */
+    opt_real_ptr sendBufG_ = NULL; /**<@brief pointer to the globally allocated memory for the send buffers */
+    opt_real_ptr recvBufG_ = NULL; /**<@brief pointer to the globally allocated memory for the recv buffers */
 
     void init_blockInfo_(const Topology* topo_in, const Topology* topo_out);
     void free_blockInfo_();
@@ -50,8 +50,8 @@ class SwitchTopo_a2a : public SwitchTopo {
     SwitchTopo_a2a(const Topology *topo_input, const Topology *topo_output, const int shift[3], H3LPR::Profiler *prof);
     ~SwitchTopo_a2a();
 
-    void setup_buffers(opt_double_ptr sendBuf, opt_double_ptr recvBuf) ;
-    void execute(double* v, const int sign) const;
+    void setup_buffers(opt_real_ptr sendBuf, opt_real_ptr recvBuf) ;
+    void execute(flups_real* v, const int sign) const;
     void setup();
     void disp() const;
 };
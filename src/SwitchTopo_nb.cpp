@@ -308,7 +308,7 @@ void SwitchTopo_nb::setup(){
     END_FUNC;
 }
 
-void SwitchTopo_nb::setup_buffers(opt_double_ptr sendData,opt_double_ptr recvData){
+void SwitchTopo_nb::setup_buffers(opt_real_ptr sendData,opt_real_ptr recvData){
     BEGIN_FUNC;
 
 
@@ -318,14 +318,14 @@ void SwitchTopo_nb::setup_buffers(opt_double_ptr sendData,opt_double_ptr recvDat
     int newrank;
     MPI_Comm_rank(subcomm_, &newrank);
     // allocate the second layer of buffers
-    sendBuf_ = (double**)m_calloc(inBlock_ * sizeof(double*));
-    recvBuf_ = (double**)m_calloc(onBlock_ * sizeof(double*));
+    sendBuf_ = (flups_real**)m_calloc(inBlock_ * sizeof(flups_real*));
+    recvBuf_ = (flups_real**)m_calloc(onBlock_ * sizeof(flups_real*));
 
     const bool doShuffle=(topo_in_->axis() != topo_out_->axis());
     
     if (doShuffle) {
-        i2o_shuffle_ = (fftw_plan*)m_calloc(onBlock_ * sizeof(fftw_plan));
-        o2i_shuffle_ = (fftw_plan*)m_calloc(inBlock_ * sizeof(fftw_plan));
+        i2o_shuffle_ = (FLUPS_FFTW(plan)*)m_calloc(onBlock_ * sizeof(FLUPS_FFTW(plan)));
+        o2i_shuffle_ = (FLUPS_FFTW(plan)*)m_calloc(inBlock_ * sizeof(FLUPS_FFTW(plan)));
     } else {
         i2o_shuffle_ = NULL;
         o2i_shuffle_ = NULL;
@@ -355,9 +355,9 @@ void SwitchTopo_nb::setup_buffers(opt_double_ptr sendData,opt_double_ptr recvDat
             selfcount++;
         } else {
             // get the send size without padding
-            MPI_Send_init(sendBuf_[bid], sendSize, MPI_DOUBLE, i2o_destRank_[bid], i2o_destTag_[bid], subcomm_, &(i2o_sendRequest_[bid]));
+            MPI_Send_init(sendBuf_[bid], sendSize, FLUPS_MPI_REAL, i2o_destRank_[bid], i2o_destTag_[bid], subcomm_, &(i2o_sendRequest_[bid]));
             // for the send when doing output 2 input: send to rank o2i with tag o2i
-            MPI_Recv_init(sendBuf_[bid], sendSize, MPI_DOUBLE, i2o_destRank_[bid], bid, subcomm_, &(o2i_recvRequest_[bid]));
+            MPI_Recv_init(sendBuf_[bid], sendSize, FLUPS_MPI_REAL, i2o_destRank_[bid], bid, subcomm_, &(o2i_recvRequest_[bid]));
         }
 
         // setup the suffle plan for the out 2 in transformation if needed
@@ -388,9 +388,9 @@ void SwitchTopo_nb::setup_buffers(opt_double_ptr sendData,opt_double_ptr recvDat
             selfcount++;
         } else {
             // for the reception when doing input 2 output: receive from the rank o2i with tag bid
-            MPI_Recv_init(recvBuf_[bid], recvSize, MPI_DOUBLE, o2i_destRank_[bid], bid, subcomm_, &(i2o_recvRequest_[bid]));
+            MPI_Recv_init(recvBuf_[bid], recvSize, FLUPS_MPI_REAL, o2i_destRank_[bid], bid, subcomm_, &(i2o_recvRequest_[bid]));
             // for the send when doing output 2 input: send to rank o2i with tag o2i
-            MPI_Send_init(recvBuf_[bid], recvSize, MPI_DOUBLE, o2i_destRank_[bid], o2i_destTag_[bid], subcomm_, &(o2i_sendRequest_[bid]));
+            MPI_Send_init(recvBuf_[bid], recvSize, FLUPS_MPI_REAL, o2i_destRank_[bid], o2i_destTag_[bid], subcomm_, &(o2i_sendRequest_[bid]));
         }
 
         // setup the suffle plan for the in 2 out transformation
@@ -437,19 +437,19 @@ SwitchTopo_nb::~SwitchTopo_nb() {
 
     if (i2o_shuffle_ != NULL) {
         for (int ib = 0; ib < onBlock_; ib++) {
-            fftw_destroy_plan(i2o_shuffle_[ib]);
+            FLUPS_FFTW(destroy_plan)(i2o_shuffle_[ib]);
         }
         m_free(i2o_shuffle_);
     }
     if (o2i_shuffle_ != NULL) {
         for (int ib = 0; ib < inBlock_; ib++) {
-            fftw_destroy_plan(o2i_shuffle_[ib]);
+            FLUPS_FFTW(destroy_plan)(o2i_shuffle_[ib]);
         }
         m_free(o2i_shuffle_);
     }
 
-    m_free((double*)sendBuf_);
-    m_free((double*)recvBuf_);
+    m_free((flups_real*)sendBuf_);
+    m_free((flups_real*)recvBuf_);
     END_FUNC;
 }
 
@@ -481,7 +481,7 @@ SwitchTopo_nb::~SwitchTopo_nb() {
  * -----------------------------------------------
  * We do the following:
  */
-void SwitchTopo_nb::execute(double* v, const int sign) const {
+void SwitchTopo_nb::execute(flups_real* v, const int sign) const {
     BEGIN_FUNC;
 
     FLUPS_CHECK(topo_in_->isComplex() == topo_out_->isComplex(),"both topologies have to be complex or real");
@@ -519,10 +519,10 @@ void SwitchTopo_nb::execute(double* v, const int sign) const {
 
     // const int nByBlock[3] = {nByBlock_[0],nByBlock_[1],nByBlock_[2]};
 
-    opt_double_ptr* sendBuf;
-    opt_double_ptr* recvBuf;
+    opt_real_ptr* sendBuf;
+    opt_real_ptr* recvBuf;
 
-    fftw_plan* shuffle = NULL;
+    FLUPS_FFTW(plan)* shuffle = NULL;
 
     if (sign == FLUPS_FORWARD) {
         topo_in     = topo_in_;
@@ -648,7 +648,7 @@ void SwitchTopo_nb::execute(double* v, const int sign) const {
             const size_t blockSize = iBlockSize[iax0][bid] * iBlockSize[iax1][bid] * iBlockSize[iax2][bid] * nf;
 
             // get the buffer data for this block
-            double* data;
+            flups_real* data;
             if(sendRequest[bid] == MPI_REQUEST_NULL){
                 // if we are doing a self block the data is the recv buff
                 // the new block ID is given by destTag[bid]
@@ -665,7 +665,7 @@ void SwitchTopo_nb::execute(double* v, const int sign) const {
             // the buffer is aligned if the starting id is aligned and if nmax is a multiple of the alignement
             const bool isBuffAligned = FLUPS_ISALIGNED(data) &&  nmax%FLUPS_ALIGNMENT == 0;
             // the data is aligned if the starting index is aligned AND if the gap between two entries, inmem[iax0] is a multiple of the alignment
-            double*    my_v            = v + localIndex(iax0, iBlockiStart[iax0][bid], iBlockiStart[iax1][bid], iBlockiStart[iax2][bid], iax0, inmem, nf, lia);
+            flups_real*    my_v            = v + localIndex(iax0, iBlockiStart[iax0][bid], iBlockiStart[iax1][bid], iBlockiStart[iax2][bid], iax0, inmem, nf, lia);
             const bool isVectorAligned = FLUPS_ISALIGNED(my_v) && inmem[iax0] % FLUPS_ALIGNMENT == 0;
 
             // we choose the best loop depending on the alignement
@@ -679,8 +679,8 @@ void SwitchTopo_nb::execute(double* v, const int sign) const {
                     // get the local starting location for the buffer and the field
                     //   my_v has already set the address in the right portion of lda, so now,
                     //   only running over the chunks as if lda=1
-                    const opt_double_ptr vloc = my_v + localIndex(iax0, 0, i1, i2, iax0, inmem, nf, 0);
-                    opt_double_ptr dataloc    = data + id * nmax;
+                    const opt_real_ptr vloc = my_v + localIndex(iax0, 0, i1, i2, iax0, inmem, nf, 0);
+                    opt_real_ptr dataloc    = data + id * nmax;
                     FLUPS_ASSUME_ALIGNED(vloc,FLUPS_ALIGNMENT);
                     FLUPS_ASSUME_ALIGNED(dataloc,FLUPS_ALIGNMENT);
                     // do the copy -> vectorized
@@ -698,8 +698,8 @@ void SwitchTopo_nb::execute(double* v, const int sign) const {
                     // get the local starting location for the buffer and the field
                     //   my_v has already set the address in the right portion of lda, so now,
                     //   only running over the chunks as if lda=1
-                    const double* __restrict vloc = my_v + localIndex(iax0, 0, i1, i2, iax0, inmem, nf, 0);
-                    opt_double_ptr dataloc        = data + id * nmax;
+                    const flups_real* __restrict vloc = my_v + localIndex(iax0, 0, i1, i2, iax0, inmem, nf, 0);
+                    opt_real_ptr dataloc        = data + id * nmax;
                     FLUPS_ASSUME_ALIGNED(dataloc,FLUPS_ALIGNMENT);
                     // do the copy -> vectorized
                     for (size_t i0 = 0; i0 < nmax; i0++) {
@@ -716,8 +716,8 @@ void SwitchTopo_nb::execute(double* v, const int sign) const {
                     // get the local starting location for the buffer and the field
                     //   my_v has already set the address in the right portion of lda, so now,
                     //   only running over the chunks as if lda=1
-                    const opt_double_ptr vloc  = my_v + localIndex(iax0, 0, i1, i2, iax0, inmem, nf, 0);
-                    double* __restrict dataloc = data + id * nmax;
+                    const opt_real_ptr vloc  = my_v + localIndex(iax0, 0, i1, i2, iax0, inmem, nf, 0);
+                    flups_real* __restrict dataloc = data + id * nmax;
                     FLUPS_ASSUME_ALIGNED(vloc,FLUPS_ALIGNMENT);
                     // do the copy -> vectorized
                     for (size_t i0 = 0; i0 < nmax; i0++) {
@@ -734,8 +734,8 @@ void SwitchTopo_nb::execute(double* v, const int sign) const {
                     // get the local starting location for the buffer and the field
                     //   my_v has already set the address in the right portion of lda, so now,
                     //   only running over the chunks as if lda=1
-                    const double* __restrict vloc  = my_v + localIndex(iax0, 0, i1, i2, iax0, inmem, nf, 0);
-                    double* __restrict dataloc = data + id * nmax;
+                    const flups_real* __restrict vloc  = my_v + localIndex(iax0, 0, i1, i2, iax0, inmem, nf, 0);
+                    flups_real* __restrict dataloc = data + id * nmax;
 
                     // do the copy -> vectorized
                     for (size_t i0 = 0; i0 < nmax; i0++) {
@@ -762,14 +762,14 @@ void SwitchTopo_nb::execute(double* v, const int sign) const {
     // reset the memory to 0
     const size_t nmax = topo_out->memsize();
     if (FLUPS_ISALIGNED(v)) {
-        opt_double_ptr my_v = v;
+        opt_real_ptr my_v = v;
         FLUPS_ASSUME_ALIGNED(my_v,FLUPS_ALIGNMENT);
 #pragma omp parallel for default(none) proc_bind(close) firstprivate(my_v, nmax)
         for (size_t id = 0; id < nmax; id++) {
             my_v[id] = 0.0;
         }
     } else {
-        double* __restrict my_v = v;
+        flups_real* __restrict my_v = v;
 #pragma omp parallel for default(none) proc_bind(close) firstprivate(my_v, nmax)
         for (size_t id = 0; id < nmax; id++) {
             my_v[id] = 0.0;
@@ -804,9 +804,9 @@ void SwitchTopo_nb::execute(double* v, const int sign) const {
                     for (int lia = 0; lia < lda; lia++){
                         // fftw_execute(shuffle[bid]);
                         if( nf == 1){
-                            fftw_execute_r2r(shuffle[bid], recvBuf[bid] + lia * blockSize, recvBuf[bid] + lia * blockSize );
+                            FLUPS_FFTW(execute_r2r)(shuffle[bid], recvBuf[bid] + lia * blockSize, recvBuf[bid] + lia * blockSize );
                         } else {
-                            fftw_execute_dft(shuffle[bid], (opt_complex_ptr) (recvBuf[bid] + lia * blockSize), (opt_complex_ptr) (recvBuf[bid] + lia * blockSize) );
+                            FLUPS_FFTW(execute_dft)(shuffle[bid], (opt_complex_ptr) (recvBuf[bid] + lia * blockSize), (opt_complex_ptr) (recvBuf[bid] + lia * blockSize) );
                         }
                     }
                 }
@@ -831,9 +831,9 @@ void SwitchTopo_nb::execute(double* v, const int sign) const {
                     for (int lia = 0; lia < lda; lia++){
                         // fftw_execute(shuffle[bid]);
                         if( nf == 1){
-                            fftw_execute_r2r(shuffle[bid], recvBuf[bid] + lia * blockSize, recvBuf[bid] + lia * blockSize );
+                            FLUPS_FFTW(execute_r2r)(shuffle[bid], recvBuf[bid] + lia * blockSize, recvBuf[bid] + lia * blockSize );
                         } else {
-                            fftw_execute_dft(shuffle[bid], (opt_complex_ptr) (recvBuf[bid] + lia * blockSize), (opt_complex_ptr) (recvBuf[bid] + lia * blockSize));
+                            FLUPS_FFTW(execute_dft)(shuffle[bid], (opt_complex_ptr) (recvBuf[bid] + lia * blockSize), (opt_complex_ptr) (recvBuf[bid] + lia * blockSize));
                         }
                     }
                 }
@@ -876,7 +876,7 @@ void SwitchTopo_nb::execute(double* v, const int sign) const {
             const bool isBuffAligned = FLUPS_ISALIGNED(recvBuf[bid] + lia * blockSize) &&  nmax%FLUPS_ALIGNMENT == 0;
             // the data is aligned if the starting index is aligned AND if the gap between two entries, inmem[iax0] is a multiple of the alignment
             // double*    my_v            = v + localIndex(oax0, oBlockiStart[0][bid], oBlockiStart[1][bid], oBlockiStart[2][bid], oax0, onmem, nf);
-            double*    my_v            = v + localIndex(oax0, oBlockiStart[oax0][bid], oBlockiStart[oax1][bid], oBlockiStart[oax2][bid], oax0, onmem, nf, lia);
+            flups_real*    my_v            = v + localIndex(oax0, oBlockiStart[oax0][bid], oBlockiStart[oax1][bid], oBlockiStart[oax2][bid], oax0, onmem, nf, lia);
             const bool isVectorAligned = FLUPS_ISALIGNED(my_v) && onmem[oax0] % FLUPS_ALIGNMENT == 0;
 
             //choose the correct loop to improve the efficiency
@@ -890,8 +890,8 @@ void SwitchTopo_nb::execute(double* v, const int sign) const {
                     // get the local starting id for the buffer and the data
                     //   my_v has already set the address in the right portion of lda, so now,
                     //   only running over the chunks as if lda=1
-                    opt_double_ptr       vloc    = my_v + localIndex(oax0, 0, i1, i2, oax0, onmem, nf, 0);
-                    const opt_double_ptr dataloc = recvBuf[bid] + lia * blockSize + id * nmax;
+                    opt_real_ptr       vloc    = my_v + localIndex(oax0, 0, i1, i2, oax0, onmem, nf, 0);
+                    const opt_real_ptr dataloc = recvBuf[bid] + lia * blockSize + id * nmax;
                     FLUPS_ASSUME_ALIGNED(vloc,FLUPS_ALIGNMENT);
                     FLUPS_ASSUME_ALIGNED(dataloc,FLUPS_ALIGNMENT);
                     // do the copy
@@ -909,8 +909,8 @@ void SwitchTopo_nb::execute(double* v, const int sign) const {
                     // get the local starting id for the buffer and the data
                     //   my_v has already set the address in the right portion of lda, so now,
                     //   only running over the chunks as if lda=1
-                    double* __restrict vloc      = my_v + localIndex(oax0, 0, i1, i2, oax0, onmem, nf, 0);
-                    const opt_double_ptr dataloc = recvBuf[bid] + lia * blockSize + id * nmax;
+                    flups_real* __restrict vloc      = my_v + localIndex(oax0, 0, i1, i2, oax0, onmem, nf, 0);
+                    const opt_real_ptr dataloc = recvBuf[bid] + lia * blockSize + id * nmax;
                     FLUPS_ASSUME_ALIGNED(dataloc,FLUPS_ALIGNMENT);
                     // do the copy
                     for (size_t i0 = 0; i0 < nmax; i0++) {
@@ -927,8 +927,8 @@ void SwitchTopo_nb::execute(double* v, const int sign) const {
                     // get the local starting id for the buffer and the data
                     //   my_v has already set the address in the right portion of lda, so now,
                     //   only running over the chunks as if lda=1
-                    opt_double_ptr vloc              = my_v + localIndex(oax0, 0, i1, i2, oax0, onmem, nf, 0);
-                    const double* __restrict dataloc = recvBuf[bid] + lia * blockSize + id * nmax;
+                    opt_real_ptr vloc              = my_v + localIndex(oax0, 0, i1, i2, oax0, onmem, nf, 0);
+                    const flups_real* __restrict dataloc = recvBuf[bid] + lia * blockSize + id * nmax;
                     FLUPS_ASSUME_ALIGNED(vloc,FLUPS_ALIGNMENT);
                     // do the copy
                     for (size_t i0 = 0; i0 < nmax; i0++) {
@@ -945,8 +945,8 @@ void SwitchTopo_nb::execute(double* v, const int sign) const {
                     // get the local starting id for the buffer and the data
                     //   my_v has already set the address in the right portion of lda, so now,
                     //   only running over the chunks as if lda=1
-                    double* __restrict vloc          = my_v + localIndex(oax0, 0, i1, i2, oax0, onmem, nf, 0);
-                    const double* __restrict dataloc = recvBuf[bid] + lia * blockSize + id * nmax;
+                    flups_real* __restrict vloc          = my_v + localIndex(oax0, 0, i1, i2, oax0, onmem, nf, 0);
+                    const flups_real* __restrict dataloc = recvBuf[bid] + lia * blockSize + id * nmax;
                     // do the copy
                     for (size_t i0 = 0; i0 < nmax; i0++) {
                         vloc[i0] = dataloc[i0];
@@ -1009,7 +1009,7 @@ void SwitchTopo_nb_test() {
     Topology* topo    = new Topology(0, 1, nglob, nproc, false,NULL,1, MPI_COMM_WORLD);
     Topology* topobig = new Topology(0, 1, nglob_big, nproc_big, false,NULL,1, MPI_COMM_WORLD);
 
-    double* data = (double*)m_calloc(sizeof(double*) * std::max(topo->memsize(), topobig->memsize()));
+    flups_real* data = (flups_real*)m_calloc(sizeof(flups_real*) * std::max(topo->memsize(), topobig->memsize()));
 
     const int nmem[3] = {topo->nmem(0),topo->nmem(1),topo->nmem(2)};
     for (int i2 = 0; i2 < topo->nloc(2); i2++) {
@@ -1030,10 +1030,10 @@ void SwitchTopo_nb_test() {
     switchtopo->disp();
 
     size_t         max_mem    = switchtopo->get_bufMemSize();
-    opt_double_ptr send_buff  = (opt_double_ptr)m_calloc(max_mem * sizeof(double));
-    opt_double_ptr recv_buff  = (opt_double_ptr)m_calloc(max_mem * sizeof(double));
-    std::memset(send_buff, 0, max_mem * sizeof(double));
-    std::memset(recv_buff, 0, max_mem * sizeof(double));
+    opt_real_ptr send_buff  = (opt_real_ptr)m_calloc(max_mem * sizeof(flups_real));
+    opt_real_ptr recv_buff  = (opt_real_ptr)m_calloc(max_mem * sizeof(flups_real));
+    std::memset(send_buff, 0, max_mem * sizeof(flups_real));
+    std::memset(recv_buff, 0, max_mem * sizeof(flups_real));
     // associate the buffer
     
     switchtopo->setup_buffers(send_buff, recv_buff);
@@ -1057,7 +1057,7 @@ void SwitchTopo_nb_test() {
     topo    = new Topology(0, 1, nglob, nproc, true,NULL,1, MPI_COMM_WORLD);
     topobig = new Topology(2, 1, nglob_big, nproc_big, true,NULL,1, MPI_COMM_WORLD);
 
-    data = (double*)m_calloc(sizeof(double*) * topobig->memsize());
+    data = (flups_real*)m_calloc(sizeof(flups_real*) * topobig->memsize());
 
     for (int i2 = 0; i2 < topo->nloc(2); i2++) {
         for (int i1 = 0; i1 < topo->nloc(1); i1++) {
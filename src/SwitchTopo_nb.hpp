@@ -51,8 +51,8 @@ protected:
     SwitchTopo_nb(const Topology *topo_input, const Topology *topo_output, const int shift[3],H3LPR::Profiler* prof);
     ~SwitchTopo_nb();
 
-    void setup_buffers(opt_double_ptr sendBuf_,opt_double_ptr recvBuf_);
-    void execute(double* v, const int sign) const;
+    void setup_buffers(opt_real_ptr sendBuf_,opt_real_ptr recvBuf_);
+    void execute(flups_real* v, const int sign) const;
     void setup() ;
     void disp() const;
 };
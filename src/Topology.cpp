@@ -20,11 +20,14 @@
  * @param axproc gives the order of the rank decomposition (eg. (0,2,1) to start decomposing in X then Z then Y). If NULL is passed, use by default (0,1,2).
  * @param alignment the number of bytes on which we want the topology to be aligned along the #axis only
  * @param comm the communicator associated to the topology.
+ * @param allow_idle if true, the communicator might have more ranks than nproc[0]*nproc[1]*nproc[2] (only for the topologies built by the solver)
  * 
  * If the MPI comm is associated with a MPI_CART topology, axproc is ignored and we use the MPI routines to determine the 3D rank from the global rank (and vice versa).
  * 
+ * Otherwise, if allow_idle is true, the ranks beyond nproc[0]*nproc[1]*nproc[2] are idle and own no unknowns (see is_idle()).
+ * 
  */
-Topology::Topology(const int axis, const int lda, const int nglob[3], const int nproc[3], const bool isComplex, const int axproc[3], const int alignment, MPI_Comm comm):alignment_(alignment) {
+Topology::Topology(const int axis, const int lda, const int nglob[3], const int nproc[3], const bool isComplex, const int axproc[3], const int alignment, MPI_Comm comm, const bool allow_idle):alignment_(alignment) {
     BEGIN_FUNC;
 
     comm_ = comm;
@@ -34,7 +37,9 @@ Topology::Topology(const int axis, const int lda, const int nglob[3], const int
     MPI_Comm_size(comm_,&comm_size);
     MPI_Comm_rank(comm_,&rank);
 
-    FLUPS_CHECK(nproc[0]*nproc[1]*nproc[2] == comm_size,"the total number of procs (=%d) have to be = to the comm size (=%d)",nproc[0]*nproc[1]*nproc[2], comm_size);
+    int mpi_topo_type;
+    MPI_Topo_test(comm_, &mpi_topo_type);
+    FLUPS_CHECK(nproc[0]*nproc[1]*nproc[2] == comm_size || (allow_idle && nproc[0]*nproc[1]*nproc[2] < comm_size && mpi_topo_type != MPI_CART),"the total number of procs (=%d) have to be = to the comm size (=%d)",nproc[0]*nproc[1]*nproc[2], comm_size);
 
     //-------------------------------------------------------------------------
     /** - get memory axis and complex information  */
@@ -82,15 +87,15 @@ void Topology::cmpt_sizes() {
     BEGIN_FUNC;
     for (int id = 0; id < 3; id++) {
         // we get the max between the nglob and
-        nloc_[id] = cmpt_nbyproc(id);
+        nloc_[id] = is_idle() ? 0 : cmpt_nbyproc(id);
         nmem_[id] = nloc_[id];
         // if we are in the axis and the last proc, we pad to ensure that every pencil is ok with alignment
         // if (id == axis_ && rankd_[id] == (nproc_[id] - 1)) {
         if (id == axis_) {
             // compute by how many we are not aligned: the global size in double = nglob * nf
-            const int modulo = (nloc_[id] * nf_ * sizeof(double)) % alignment_;
+            const int modulo = (nloc_[id] * nf_ * sizeof(flups_real)) % alignment_;
             // compute the number of points to add (in double indexing)
-            const int delta = (alignment_ - modulo) / sizeof(double);
+            const int delta = (alignment_ - modulo) / sizeof(flups_real);
             nmem_[id] += (modulo == 0) ? 0 : delta / nf_;
         }
     }
@@ -188,7 +193,7 @@ void Topology::disp_rank() {
     BEGIN_FUNC;
 #ifdef DUMP_DBG
     // we only focus on the real size = local size
-    double* rankdata = (double*)m_calloc(sizeof(double) * this->locsize() * 2);
+    flups_real* rankdata = (flups_real*)m_calloc(sizeof(flups_real) * this->locsize() * 2);
     int     rank, rank_new;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_rank(comm_, &rank_new);
@@ -45,7 +45,7 @@ class Topology {
     //      need to depend on the number of points (N, N+2 if we prepare a symmetric transform, etc.)
 
    public:
-    Topology(const int axis, const int lda, const int nglob[3], const int nproc[3], const bool isComplex, const int axproc[3], const int alignment, MPI_Comm comm);
+    Topology(const int axis, const int lda, const int nglob[3], const int nproc[3], const bool isComplex, const int axproc[3], const int alignment, MPI_Comm comm, const bool allow_idle = false);
     ~Topology();
 
     /**
@@ -74,6 +74,10 @@ class Topology {
     // inline int nbyproc(const int dim) const { return nbyproc_[dim]; }
     inline int      axproc(const int dim) const { return axproc_[dim]; }
     inline MPI_Comm get_comm() const { return comm_; }
+    /**
+     * @brief returns true if the rank is beyond the procs of the topology: it then owns no unknowns
+     */
+    inline bool is_idle() const { return rankd_[0] >= nproc_[0]; }
 
     /**
      * @brief compute the scalar number of unknowns on each proc, i.e. the number of unkowns for one component
@@ -184,7 +188,7 @@ class Topology {
      * @{
      */
     void cmpt_sizes();
-    void memshift(const int sign,const int lia, double* data);
+    void memshift(const int sign,const int lia, flups_real* data);
 
     /**
      * @brief returns the scalar local size on this proc, i.e. the number of unknowns for one component
@@ -267,6 +271,7 @@ class Topology {
  * @brief split the rank into rank per dimensions
  * 
  * axproc is not used if comm is of type MPI_CART.
+ * The ranks beyond nproc[0]*nproc[1]*nproc[2] are idle and get rankd = nproc.
  * 
  * @param rank the rank of the proc (from MPI, in the current communicator of the topo)
  * @param nproc the number of procs along each direction
@@ -282,6 +287,11 @@ inline static void ranksplit(const int rank, const int axproc[3], const int npro
     MPI_Topo_test(comm, &mpi_topo_type);
     if (mpi_topo_type == MPI_CART) {
         MPI_Cart_coords(comm, rank, 3, rankd);
+    } else if (rank >= nproc[0] * nproc[1] * nproc[2]) {
+        // the rank is idle, it is placed after the last rank in every direction
+        rankd[0] = nproc[0];
+        rankd[1] = nproc[1];
+        rankd[2] = nproc[2];
     } else {
         rankd[ax0] = rank % nproc[ax0];
         rankd[ax1] = (rank % (nproc[ax0] * nproc[ax1])) / nproc[ax0];
@@ -6,6 +6,38 @@
 
 #include "chunk_tools.hpp"
 
+#include <array>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+
+// the non-temporal stores are available with SSE2 and AVX
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#define FLUPS_STREAM_PACK 1
+#else
+#define FLUPS_STREAM_PACK 0
+#endif
+
+/**
+ * @brief the MPI datatypes of a chunk, shared by all the chunks with the same shape and memory strides
+ *
+ * The datatypes are relative to the offset of the chunk: at large rank counts, most of the chunks of the switchtopos of
+ * a solver have the same few shapes and creating their datatypes once reduces the setup time and the number of MPI handles.
+ */
+struct ChunkDataTypes {
+    MPI_Datatype dtype;
+    MPI_Datatype comp_dtype;
+    MPI_Datatype trsp_dtype;
+    MPI_Datatype dest_dtype;
+    MPI_Datatype msg_dtype;
+    int          msg_count;
+    int          n_ref;  //!< number of chunks using the datatypes
+};
+static std::map<ChunkDataTypesKey, ChunkDataTypes> chunk_dtypes;
+
 /**
  * @brief Decomposes topo_in into chunks, each of them belonging to a different rank in topo_out
  *
@@ -48,6 +80,16 @@ void PopulateChunk(const int shift[3], const Topology* topo_in, const Topology*
                topo_out->nglob(1),
                topo_out->nglob(2));
 
+    //--------------------------------------------------------------------------
+    /** - an idle rank of topo_in has nothing to send */
+    //--------------------------------------------------------------------------
+    if (topo_in->is_idle()) {
+        n_chunks[0] = 0;
+        *chunks     = reinterpret_cast<MemChunk*>(m_calloc(0));
+        END_FUNC;
+        return;
+    }
+
     //--------------------------------------------------------------------------
     /** - get the number of chunks to build */
     //--------------------------------------------------------------------------
@@ -133,10 +175,30 @@ void PopulateChunk(const int shift[3], const Topology* topo_in, const Topology*
                 cchunk->axis      = topo_in->axis();
                 cchunk->dest_axis = topo_out->axis();
 
+                // the memcpy packing is the default one, see TuneChunkPack()
+                cchunk->pack = CHUNK_PACK_MEMCPY;
+                // the received chunks are shuffled by default, see TuneChunkUnpack()
+                cchunk->unpack = CHUNK_UNPACK_SHUFFLE;
+
+                // the received data follows the axis of the sender, the shuffle only reorders it if the non-unit dimensions are permuted
+                int n_in = 0, n_out = 0;
+                int order_in[3], order_out[3];
+                for (int id = 0; id < 3; ++id) {
+                    const int ax_in  = (cchunk->dest_axis + id) % 3;
+                    const int ax_out = (cchunk->axis + id) % 3;
+                    if (cchunk->isize[ax_in] > 1) order_in[n_in++] = ax_in;
+                    if (cchunk->isize[ax_out] > 1) order_out[n_out++] = ax_out;
+                }
+                cchunk->is_identity = true;
+                cchunk->is_float    = false;
+                cchunk->float_err   = 0.0;
+                for (int id = 0; id < n_in; ++id) {
+                    cchunk->is_identity = cchunk->is_identity && (order_in[id] == order_out[id]);
+                }
+
                 // setup the offset and the MPI datatype
                 const int nmem_in[3] = {topo_in->nmem(0), topo_in->nmem(1), topo_in->nmem(2)};
-                ChunkToMPIDataType(nmem_in, cchunk);
-                ChunkToDestMPIDataType(cchunk);
+                ChunkToSharedMPIDataType(nmem_in, cchunk);
 
                 FLUPS_CHECK(topo_in->nf() == topo_out->nf(), "the 2 topo must have matching nfs: %d vs %d", topo_in->nf(), topo_out->nf());
                 FLUPS_INFO("chunks going from %d %d %d with size %d %d %d and destination rank %d", cchunk->istart[0], cchunk->istart[1], cchunk->istart[2], cchunk->isize[0], cchunk->isize[1], cchunk->isize[2], cchunk->dest_rank);
@@ -154,7 +216,81 @@ void PopulateChunk(const int shift[3], const Topology* topo_in, const Topology*
 }
 
 /**
- * @brief sets the dtype argument of a chunk, the datatype in the home topology of the chunk
+ * @brief frees the MPI datatypes of a chunk, the destructor of the chunks is never called as they are allocated with m_calloc
+ *
+ * The datatypes shared with other chunks (see ChunkToSharedMPIDataType()) are only freed by the last chunk using them.
+ *
+ * @param chunk the memory chunk
+ */
+void FreeChunkMPIDataType(MemChunk* chunk) {
+    //--------------------------------------------------------------------------
+    std::map<ChunkDataTypesKey, ChunkDataTypes>::iterator it = chunk_dtypes.find(chunk->dtype_key);
+    if (it != chunk_dtypes.end() && it->second.dtype == chunk->dtype) {
+        if (--(it->second.n_ref) == 0) {
+            MPI_Type_free(&it->second.dtype);
+            MPI_Type_free(&it->second.comp_dtype);
+            MPI_Type_free(&it->second.trsp_dtype);
+            MPI_Type_free(&it->second.dest_dtype);
+            if (it->second.msg_dtype != FLUPS_MPI_REAL) MPI_Type_free(&it->second.msg_dtype);
+            chunk_dtypes.erase(it);
+        }
+        return;
+    }
+    MPI_Type_free(&chunk->dtype);
+    MPI_Type_free(&chunk->comp_dtype);
+    MPI_Type_free(&chunk->trsp_dtype);
+    MPI_Type_free(&chunk->dest_dtype);
+    if (chunk->msg_dtype != FLUPS_MPI_REAL) MPI_Type_free(&chunk->msg_dtype);
+    //--------------------------------------------------------------------------
+}
+
+/**
+ * @brief sets the offset and the MPI datatypes of a chunk, the datatypes being shared with the chunks of same shape and memory strides
+ *
+ * The datatypes are only created for the first chunk of a given shape, see ChunkToMPIDataType(), ChunkToTrspMPIDataType(),
+ * ChunkToDestMPIDataType() and ChunkToMsgMPIDataType(). They must be freed with FreeChunkMPIDataType().
+ *
+ * @param nmem the memory strides associated to the chunk topo_in
+ * @param chunk the memory chunk
+ */
+void ChunkToSharedMPIDataType(const int nmem[3], MemChunk* chunk) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    const int nf         = chunk->nf;
+    const int ax0        = chunk->axis;
+    const int ax[3]      = {ax0, (ax0 + 1) % 3, (ax0 + 2) % 3};
+    const int listart[3] = {chunk->istart[ax[0]], chunk->istart[ax[1]], chunk->istart[ax[2]]};
+
+    chunk->offset           = localIndex(ax[0], listart[0], listart[1], listart[2], ax[0], nmem, nf, 0);
+    const size_t offset_dim = localIndex(ax[0], listart[0], listart[1], listart[2], ax[0], nmem, nf, 1) - chunk->offset;
+
+    const ChunkDataTypesKey key = {{(size_t)chunk->nf, (size_t)chunk->axis, (size_t)chunk->dest_axis,
+                                    (size_t)chunk->isize[0], (size_t)chunk->isize[1], (size_t)chunk->isize[2],
+                                    (size_t)nmem[0], (size_t)nmem[1], (size_t)nmem[2], (size_t)chunk->nda, offset_dim}};
+
+    std::map<ChunkDataTypesKey, ChunkDataTypes>::iterator it = chunk_dtypes.find(key);
+    if (it == chunk_dtypes.end()) {
+        ChunkToMPIDataType(nmem, chunk);
+        ChunkToTrspMPIDataType(nmem, chunk);
+        ChunkToDestMPIDataType(chunk);
+        ChunkToMsgMPIDataType(chunk);
+        const ChunkDataTypes types = {chunk->dtype, chunk->comp_dtype, chunk->trsp_dtype, chunk->dest_dtype, chunk->msg_dtype, chunk->msg_count, 0};
+        it = chunk_dtypes.insert(std::make_pair(key, types)).first;
+    }
+    it->second.n_ref += 1;
+    chunk->dtype_key  = key;
+    chunk->dtype      = it->second.dtype;
+    chunk->comp_dtype = it->second.comp_dtype;
+    chunk->trsp_dtype = it->second.trsp_dtype;
+    chunk->dest_dtype = it->second.dest_dtype;
+    chunk->msg_dtype  = it->second.msg_dtype;
+    chunk->msg_count  = it->second.msg_count;
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief sets the dtype and comp_dtype arguments of a chunk, the datatypes in the home topology of the chunk
  *
  * @param nmem the memory strides associated to the chunk topo_in
  * @param chunk the memory chunk
@@ -188,19 +324,19 @@ void ChunkToMPIDataType(const int nmem[3], MemChunk* chunk) {
     //..........................................................................
     FLUPS_INFO("nmem = %d %d %d", nmem[ax[0]], nmem[ax[1]], nmem[ax[2]]);
     const int    size[4]        = {chunk->isize[ax[0]] * nf, chunk->isize[ax[1]], chunk->isize[ax[2]], chunk->nda};
-    const size_t stride_byte[4] = {sizeof(double),
-                                   sizeof(double) * nf * nmem[ax[0]],
-                                   sizeof(double) * nf * nmem[ax[0]] * nmem[ax[1]],
-                                   sizeof(double) * offset_dim};
+    const size_t stride_byte[4] = {sizeof(flups_real),
+                                   sizeof(flups_real) * nf * nmem[ax[0]],
+                                   sizeof(flups_real) * nf * nmem[ax[0]] * nmem[ax[1]],
+                                   sizeof(flups_real) * offset_dim};
     // create the 3D datatype
     // MPI_Datatype type_x, type_xy, type_xyz;
     MPI_Datatype type_xy, type_xyz;
     // stride in x = 1, count = chunk size
-    // MPI_Type_create_hvector(size[0], 1, stride_byte[0], MPI_DOUBLE, &type_x);
+    // MPI_Type_create_hvector(size[0], 1, stride_byte[0], FLUPS_MPI_REAL, &type_x);
     FLUPS_INFO("puting %d %d-doubles together with strides = %zu", size[0], nf, stride_byte[0]);
     // stride in y = nmem[0]a, count = chunk sie
     // MPI_Type_create_hvector(size[1], 1, stride_byte[1], type_x, &type_xy);
-    MPI_Type_create_hvector(size[1], size[0], stride_byte[1], MPI_DOUBLE, &type_xy);
+    MPI_Type_create_hvector(size[1], size[0], stride_byte[1], FLUPS_MPI_REAL, &type_xy);
     FLUPS_INFO("puting %d type_x together with strides = %zu", size[1], stride_byte[1]);
     // stride in z = nmem[0]*nmem[1], count = chunk size
     MPI_Type_create_hvector(size[2], 1, stride_byte[2], type_xy, &type_xyz);
@@ -216,11 +352,61 @@ void ChunkToMPIDataType(const int nmem[3], MemChunk* chunk) {
     //..........................................................................
     // commit the new type
     MPI_Type_commit(&(chunk->dtype));
+    // the type of one component is kept for the packing
+    chunk->comp_dtype = type_xyz;
+    MPI_Type_commit(&(chunk->comp_dtype));
 
     // free the now useless types
     // MPI_Type_free(&type_x);
     MPI_Type_free(&type_xy);
-    MPI_Type_free(&type_xyz);
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief sets the trsp_dtype argument of a chunk: the datatype in the home topology of the chunk that scatters the received data in place
+ *
+ * The received data follows the axis of the sender, i.e. the dest_axis of the chunk comes first, the datatype therefore
+ * transposes the data while it is written in the memory, as the shuffle followed by CopyChunk2Data() would do.
+ * Like dtype, the datatype is relative to the offset of the chunk.
+ *
+ * @param nmem the memory strides associated to the chunk topo_in
+ * @param chunk the memory chunk
+ */
+void ChunkToTrspMPIDataType(const int nmem[3], MemChunk* chunk) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    const int nf         = chunk->nf;
+    const int ax0        = chunk->axis;
+    const int ax[3]      = {ax0, (ax0 + 1) % 3, (ax0 + 2) % 3};
+    const int listart[3] = {chunk->istart[ax[0]], chunk->istart[ax[1]], chunk->istart[ax[2]]};
+
+    // the strides in the memory of the home topology
+    size_t stride_byte[3];
+    stride_byte[ax[0]]      = sizeof(flups_real) * nf;
+    stride_byte[ax[1]]      = sizeof(flups_real) * nf * nmem[ax[0]];
+    stride_byte[ax[2]]      = sizeof(flups_real) * nf * nmem[ax[0]] * nmem[ax[1]];
+    const size_t offset_dim = localIndex(ax[0], listart[0], listart[1], listart[2], ax[0], nmem, nf, 1) - chunk->offset;
+
+    //..........................................................................
+    // one data point, then the dimensions in the order of the received data
+    MPI_Datatype type_in;
+    MPI_Type_contiguous(nf, FLUPS_MPI_REAL, &type_in);
+    for (int id = 0; id < 3; ++id) {
+        const int    iax = (chunk->dest_axis + id) % 3;
+        MPI_Datatype type_out;
+        MPI_Type_create_hvector(chunk->isize[iax], 1, stride_byte[iax], type_in, &type_out);
+        MPI_Type_free(&type_in);
+        type_in = type_out;
+    }
+    // finally get the different dimensions together
+    if (chunk->nda > 1) {
+        MPI_Type_create_hvector(chunk->nda, 1, sizeof(flups_real) * offset_dim, type_in, &(chunk->trsp_dtype));
+    } else {
+        MPI_Type_dup(type_in, &(chunk->trsp_dtype));
+    }
+    MPI_Type_commit(&(chunk->trsp_dtype));
+    MPI_Type_free(&type_in);
     //--------------------------------------------------------------------------
     END_FUNC;
 }
@@ -235,10 +421,15 @@ void ChunkToMPIDataType(const int nmem[3], MemChunk* chunk) {
 void ChunkToDestMPIDataType(MemChunk* chunk) {
     BEGIN_FUNC;
     //--------------------------------------------------------------------------
-    int      count        = chunk->nda;                                                       // number of blocks
-    int      block_length = chunk->isize[0] * chunk->isize[1] * chunk->isize[2] * chunk->nf;  // Number of element per block
-    MPI_Aint stride       = chunk->size_padded;                                               // number of bytes between start of each block
-    MPI_Type_vector(count, block_length, stride, MPI_DOUBLE, &(chunk->dest_dtype));
+    int      count        = chunk->nda;                                                               // number of blocks
+    size_t   block_length = (size_t)chunk->isize[0] * chunk->isize[1] * chunk->isize[2] * chunk->nf;  // Number of element per block
+    MPI_Aint stride       = chunk->size_padded * sizeof(flups_real);                                  // number of bytes between start of each block
+
+    // the block might not fit in an int count
+    MPI_Datatype block;
+    LargeContiguousType(block_length, &block);
+    MPI_Type_create_hvector(count, 1, stride, block, &(chunk->dest_dtype));
+    MPI_Type_free(&block);
 
     // commit the new type
     MPI_Type_commit(&(chunk->dest_dtype));
@@ -247,38 +438,186 @@ void ChunkToDestMPIDataType(MemChunk* chunk) {
 }
 
 /**
- * @brief update the dest_rank and the comm member variable fo the chunk if it belongs to the given comm
+ * @brief sets the msg_count and msg_dtype arguments of a chunk, used to send the chunk buffer as a whole
+ *
+ * if the number of doubles in the buffer does not exceed FLUPS_MPI_MAX_COUNT, the message is simply msg_count doubles.
+ * Otherwise the message is one element of a derived datatype.
+ *
+ * @param chunk
+ */
+void ChunkToMsgMPIDataType(MemChunk* chunk) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    const size_t count = chunk->size_padded * chunk->nda;
+    if (count <= (size_t)FLUPS_MPI_MAX_COUNT) {
+        chunk->msg_count = (int)count;
+        chunk->msg_dtype = FLUPS_MPI_REAL;
+    } else {
+        FLUPS_INFO("the chunk of %zu doubles is sent as a derived datatype", count);
+        chunk->msg_count = 1;
+        LargeContiguousType(count, &(chunk->msg_dtype));
+    }
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief sends the chunk buffer as floats: the message is halved, see get_ChunkMsgSize()
+ *
+ * Only a chunk sent as a plain count of flups_real is converted. As the decision only depends on the size of the chunk,
+ * the sending and the receiving ranks take the same one.
+ *
+ * @param chunk
+ */
+void ChunkToFloatTransport(MemChunk* chunk) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    if (chunk->msg_dtype == FLUPS_MPI_REAL) {
+        chunk->is_float  = true;
+        chunk->msg_count = (int)get_ChunkMsgSize(chunk);
+    }
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief converts the received chunk buffer back to flups_real, in place, with all the threads
+ *
+ * The float transport is only used in double precision (see SwitchTopoX::setup_floatTransport_()).
+ * The i-th flups_real overwrites the floats 2i and 2i+1. The values of the upper half [(n+1)/2, n[ only overwrite floats which
+ * are beyond the n floats of the buffer: they are converted together, then the same holds for the upper half of the
+ * remaining ones, etc.
+ *
+ * @param chunk
+ */
+static void ChunkFloat2Double(MemChunk* chunk) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    const size_t count = chunk->size_padded * chunk->nda;
+    char*        buf   = reinterpret_cast<char*>(chunk->data);
+#pragma omp parallel proc_bind(close)
+    {
+        size_t end = count;
+        while (end > 0) {
+            const size_t start = (end > 1) ? (end + 1) / 2 : 0;
+#pragma omp for schedule(static)
+            for (size_t i = start; i < end; ++i) {
+                float fval;
+                std::memcpy(&fval, buf + i * sizeof(float), sizeof(float));
+                const flups_real val = (flups_real)fval;
+                std::memcpy(buf + i * sizeof(flups_real), &val, sizeof(flups_real));
+            }
+            end = start;
+        }
+    }
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief creates a committed datatype made of count contiguous doubles, count being possibly larger than what an int can hold
+ *
+ * The type is made of blocks of FLUPS_MPI_MAX_COUNT doubles followed by the remainder.
+ *
+ * @param count the number of doubles
+ * @param dtype the new datatype, to be freed by the user
+ */
+void LargeContiguousType(const size_t count, MPI_Datatype* dtype) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    const size_t max_count = FLUPS_MPI_MAX_COUNT;
+    const size_t n_block   = count / max_count;
+    const size_t remainder = count % max_count;
+    FLUPS_CHECK(n_block <= (size_t)INT_MAX, "the number of blocks %zu does not fit in an int", n_block);
+
+    if (n_block == 0) {
+        MPI_Type_contiguous((int)remainder, FLUPS_MPI_REAL, dtype);
+    } else {
+        MPI_Datatype block, blocks;
+        MPI_Type_contiguous((int)max_count, FLUPS_MPI_REAL, &block);
+        MPI_Type_contiguous((int)n_block, block, &blocks);
+        if (remainder == 0) {
+            MPI_Type_dup(blocks, dtype);
+        } else {
+            int          length[2] = {1, (int)remainder};
+            MPI_Aint     disp[2]   = {0, (MPI_Aint)(n_block * max_count * sizeof(flups_real))};
+            MPI_Datatype types[2]  = {blocks, FLUPS_MPI_REAL};
+            MPI_Type_create_struct(2, length, disp, types, dtype);
+        }
+        MPI_Type_free(&block);
+        MPI_Type_free(&blocks);
+    }
+    MPI_Type_commit(dtype);
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief translates the dest_rank of the chunks in the given group, MPI_UNDEFINED if the destination is not in the group
+ *
+ * The ranks are translated at once for every run of consecutive chunks sharing the same communicator.
+ *
+ * @param group the group in which the ranks are translated
+ * @param n_chunks the number of chunks
+ * @param chunks the chunks
+ * @param dest_rank the dest_rank of every chunk in the group (size n_chunks)
+ */
+void ChunksDestRankInGroup(const MPI_Group group, const int n_chunks, const MemChunk* chunks, int* dest_rank) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    int* ranks = reinterpret_cast<int*>(m_calloc(m_max(n_chunks, 1) * sizeof(int)));
+    int  ic    = 0;
+    while (ic < n_chunks) {
+        // the chunks [ic, jc[ share the same communicator
+        int jc = ic + 1;
+        while (jc < n_chunks && chunks[jc].comm == chunks[ic].comm) ++jc;
+        for (int kc = ic; kc < jc; ++kc) {
+            ranks[kc - ic] = chunks[kc].dest_rank;
+        }
+        MPI_Group chunk_group;
+        MPI_Comm_group(chunks[ic].comm, &chunk_group);
+        MPI_Group_translate_ranks(chunk_group, jc - ic, ranks, group, dest_rank + ic);
+        MPI_Group_free(&chunk_group);
+        ic = jc;
+    }
+    m_free(ranks);
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief update the dest_rank and the comm member variables of the chunks which belong to the given comm
  *
  * @param new_comm the new communicator
  * @param new_group the new group associated ot new_comm
- * @param chunk the chunk to update
- * @return true if the chunk belongs to the new group and has been updated
- * @return false if the chunk does not belong to the new comm
+ * @param n_chunks the number of chunks
+ * @param chunks the chunks to update, the comm of a chunk is new_comm once it has been updated
+ * @return the number of chunks which belong to the new comm and have been updated
  */
-void ChunkToNewComm(const MPI_Comm new_comm, const MPI_Group new_group, MemChunk* chunk, bool* is_in_comm) {
+int ChunksToNewComm(const MPI_Comm new_comm, const MPI_Group new_group, const int n_chunks, MemChunk* chunks) {
     BEGIN_FUNC;
     //--------------------------------------------------------------------------
-    // get the group associated with the chunk
-    MPI_Group chunk_group;
-    MPI_Comm_group(chunk->comm, &chunk_group);
-
-    // get the dest_rank of the chunk in the new group
-    int new_dest_rank;
-    MPI_Group_translate_ranks(chunk_group, 1, &(chunk->dest_rank), new_group, &new_dest_rank);
-    is_in_comm[0] = (MPI_UNDEFINED != new_dest_rank);
-    if (is_in_comm[0]) {
-        chunk->comm      = new_comm;
-        chunk->dest_rank = new_dest_rank;
+    int* new_dest_rank = reinterpret_cast<int*>(m_calloc(m_max(n_chunks, 1) * sizeof(int)));
+    ChunksDestRankInGroup(new_group, n_chunks, chunks, new_dest_rank);
+    int n_in_comm = 0;
+    for (int ic = 0; ic < n_chunks; ++ic) {
+        if (MPI_UNDEFINED != new_dest_rank[ic]) {
+            chunks[ic].comm      = new_comm;
+            chunks[ic].dest_rank = new_dest_rank[ic];
+            ++n_in_comm;
+        }
     }
-    MPI_Group_free(&chunk_group);
+    m_free(new_dest_rank);
     //--------------------------------------------------------------------------
     END_FUNC;
+    return n_in_comm;
 }
 
 /**
  * @brief Prepare the plan for the shuffle for each chunk
  *
  * initilizing mutliple plans will rely on the wisdom of FFTW as soon as no fftw_cleanup is called
+ * no plan is created if the shuffle is the identity (see PopulateChunk()), DoShuffleChunk() is then a no-op
  *
  * @param iscomplex indicate if the input topo or the output topo is complex
  * @param chunk the chunk that will store the plan
@@ -286,10 +625,17 @@ void ChunkToNewComm(const MPI_Comm new_comm, const MPI_Group new_group, MemChunk
 void PlanShuffleChunk(const bool iscomplex, MemChunk* chunk) {
     BEGIN_FUNC;
     //--------------------------------------------------------------------------
+    // the data is received in its final layout, nothing to plan
+    if (chunk->is_identity) {
+        FLUPS_INFO("shuffle: the shuffle from %d to %d is the identity", chunk->axis, chunk->dest_axis);
+        chunk->shuffle = NULL;
+        END_FUNC;
+        return;
+    }
     // enable the multithreading for this plan
-    fftw_plan_with_nthreads(omp_get_max_threads());
+    FLUPS_FFTW(plan_with_nthreads)(omp_get_max_threads());
 
-    fftw_iodim dims[2];
+    FLUPS_FFTW(iodim) dims[2];
     // dim[0] = dimension of the targeted FRI (FFTW-convention)
     dims[0].n  = 1;
     dims[0].is = 1;
@@ -335,10 +681,10 @@ void PlanShuffleChunk(const bool iscomplex, MemChunk* chunk) {
     // plan the real or complex plan
     // the nf is driven by the OUT topology ALWAYS
     if (!iscomplex) {
-        chunk->shuffle = fftw_plan_guru_r2r(0, NULL, 2, dims, chunk->data, chunk->data, NULL, FLUPS_FFTW_FLAG);
+        chunk->shuffle = FLUPS_FFTW(plan_guru_r2r)(0, NULL, 2, dims, chunk->data, chunk->data, NULL, FLUPS_FFTW_FLAG);
         // FLUPS_CHECK(chunk->shuffle != NULL, "Plan has not been setup");
     } else {
-        chunk->shuffle = fftw_plan_guru_dft(0, NULL, 2, dims, (fftw_complex*)chunk->data, (fftw_complex*)chunk->data, FLUPS_FORWARD, FLUPS_FFTW_FLAG);
+        chunk->shuffle = FLUPS_FFTW(plan_guru_dft)(0, NULL, 2, dims, (FLUPS_FFTW(complex)*)chunk->data, (FLUPS_FFTW(complex)*)chunk->data, FLUPS_FORWARD, FLUPS_FFTW_FLAG);
         // FLUPS_CHECK(chunk->shuffle != NULL, "Plan has not been setup");
     }
     //--------------------------------------------------------------------------
@@ -348,19 +694,30 @@ void PlanShuffleChunk(const bool iscomplex, MemChunk* chunk) {
 /**
  * @brief executes the shuffle planed by PlanShuffleChunk() 
  * 
+ * A chunk received as floats (see ChunkToFloatTransport()) is converted back to flups_real before the shuffle.
+ * Without shuffle, the chunk stays in floats and the conversion is done by CopyChunk2Data().
+ *
  * @param chunk 
  */
 void DoShuffleChunk(MemChunk* chunk) {
     BEGIN_FUNC;
     //--------------------------------------------------------------------------
+    if (chunk->is_identity) {
+        END_FUNC;
+        return;
+    }
+    // the chunk received as floats goes back to flups_real first
+    if (chunk->is_float) {
+        ChunkFloat2Double(chunk);
+    }
     // only the master call the fftw_execute which is executed in multithreading
     for (int ida = 0; ida < chunk->nda; ++ida) {
-        opt_double_ptr data_ptr = chunk->data + ida * chunk->size_padded;
+        opt_real_ptr data_ptr = chunk->data + ida * chunk->size_padded;
         if (chunk->nf == 1) {
             // we execute it on the different directions of the field but the memory has the same properties (alignement, lenght, etc)
-            fftw_execute_r2r(chunk->shuffle, data_ptr, data_ptr);
+            FLUPS_FFTW(execute_r2r)(chunk->shuffle, data_ptr, data_ptr);
         } else {
-            fftw_execute_dft(chunk->shuffle, (opt_complex_ptr)(data_ptr), (opt_complex_ptr)(data_ptr));
+            FLUPS_FFTW(execute_dft)(chunk->shuffle, (opt_complex_ptr)(data_ptr), (opt_complex_ptr)(data_ptr));
         }
     }
     //--------------------------------------------------------------------------
@@ -376,11 +733,13 @@ void DoShuffleChunk(MemChunk* chunk) {
  *
  * the alignement is automatically performed and exploited, there is not need to do it by hand
  *
+ * A chunk received as floats and not shuffled (see DoShuffleChunk()) is converted back to flups_real during the copy.
+ *
  * @param topo the topology in which the chunk and the data are located, must be the input topo of the chunk
  * @param chunk the chunk of memory to copy
  * @param data the vector of data corresponding to the current memory
  */
-void CopyChunk2Data(const MemChunk* chunk, const int nmem[3], opt_double_ptr data) {
+void CopyChunk2Data(const MemChunk* chunk, const int nmem[3], opt_real_ptr data) {
     BEGIN_FUNC;
     //--------------------------------------------------------------------------
     // get the current ax as the topo_in one (otherwise the copy doesn't make sense)
@@ -391,15 +750,19 @@ void CopyChunk2Data(const MemChunk* chunk, const int nmem[3], opt_double_ptr dat
 
     // get the indexes to copy
     const size_t n_loop    = chunk->isize[ax[1]] * chunk->isize[ax[2]];
-    const size_t nmax_byte = chunk->isize[ax[0]] * nf * sizeof(double);
+    const size_t nmax_byte = chunk->isize[ax[0]] * nf * sizeof(flups_real);
 
     FLUPS_INFO("copying data at %d %d %d", chunk->istart[0], chunk->istart[1], chunk->istart[2]);
 
+    // the shuffled chunks are already back in flups_real
+    const bool   is_float = chunk->is_float && chunk->is_identity;
+    const size_t n_row    = nmax_byte / sizeof(flups_real);
+
 #pragma omp parallel proc_bind(close)
     for (int lia = 0; lia < chunk->nda; ++lia) {
         // get the starting address for the chunk, taking into account the padding
-        opt_double_ptr src_data = chunk->data + chunk->size_padded * lia;
-        opt_double_ptr trg_data = data + localIndex(ax[0], listart[0], listart[1], listart[2], ax[0], nmem, nf, lia);
+        opt_real_ptr src_data = chunk->data + chunk->size_padded * lia;
+        opt_real_ptr trg_data = data + localIndex(ax[0], listart[0], listart[1], listart[2], ax[0], nmem, nf, lia);
 
         // the chunk must be aligned all the time
         FLUPS_CHECK(m_isaligned(src_data,FLUPS_ALIGNMENT), "The chunk memory should be aligned");
@@ -409,17 +772,83 @@ void CopyChunk2Data(const MemChunk* chunk, const int nmem[3], opt_double_ptr dat
             // get the local indexes (we cannot used the collaspedIndex one!!!)
             const int i2 = il / (chunk->isize[ax[1]]);
             const int i1 = il % (chunk->isize[ax[1]]);
-            // get the starting adddress for the memcpy
-            const double* __restrict vsrc = src_data + localIndex(ax0, 0, i1, i2, ax0, chunk->isize, nf, 0);
-            double* __restrict vtrg       = trg_data + localIndex(ax0, 0, i1, i2, ax0, nmem, nf, 0);
-            memcpy(vtrg, vsrc, nmax_byte);
+            const size_t src_id = localIndex(ax0, 0, i1, i2, ax0, chunk->isize, nf, 0);
+            flups_real* __restrict vtrg = trg_data + localIndex(ax0, 0, i1, i2, ax0, nmem, nf, 0);
+            if (is_float) {
+                // the i-th float of the buffer is the i-th value of the chunk
+                const char* __restrict fsrc = reinterpret_cast<const char*>(chunk->data) + (chunk->size_padded * lia + src_id) * sizeof(float);
+                for (size_t i = 0; i < n_row; ++i) {
+                    float fval;
+                    std::memcpy(&fval, fsrc + i * sizeof(float), sizeof(float));
+                    vtrg[i] = (flups_real)fval;
+                }
+            } else {
+                std::memcpy(vtrg, src_data + src_id, nmax_byte);
+            }
         }
     }
     //--------------------------------------------------------------------------
     END_FUNC;
 }
 
-void CopyData2Chunk(const int nmem[3], const opt_double_ptr data, MemChunk* chunk) {
+/**
+ * @brief copies n reals using non-temporal stores, the target is not brought into the cache
+ *
+ * The stores are weakly ordered, a store fence is needed once all the copies are done.
+ * If the non-temporal stores are not available the copy is a plain one.
+ *
+ * @param trg the target memory
+ * @param src the source memory
+ * @param n the number of reals to copy
+ */
+static inline void StreamCopy(flups_real* __restrict trg, const flups_real* __restrict src, const size_t n) {
+    size_t i = 0;
+#if defined(__AVX__)
+    const size_t width = 32 / sizeof(flups_real);
+    for (; i < n && !m_isaligned(trg + i, 32); ++i) {
+        trg[i] = src[i];
+    }
+    for (; i + width <= n; i += width) {
+#if (FLUPS_SINGLE_PREC)
+        _mm256_stream_ps(trg + i, _mm256_loadu_ps(src + i));
+#else
+        _mm256_stream_pd(trg + i, _mm256_loadu_pd(src + i));
+#endif
+    }
+#elif defined(__SSE2__)
+    const size_t width = 16 / sizeof(flups_real);
+    for (; i < n && !m_isaligned(trg + i, 16); ++i) {
+        trg[i] = src[i];
+    }
+    for (; i + width <= n; i += width) {
+#if (FLUPS_SINGLE_PREC)
+        _mm_stream_ps(trg + i, _mm_loadu_ps(src + i));
+#else
+        _mm_stream_pd(trg + i, _mm_loadu_pd(src + i));
+#endif
+    }
+#endif
+    for (; i < n; ++i) {
+        trg[i] = src[i];
+    }
+}
+
+/**
+ * @brief Copy the memory from the data pointer to the chunk
+ *
+ * The copy follows the strategy stored in the chunk (see TuneChunkPack()):
+ * - CHUNK_PACK_MEMCPY: one memcpy per contiguous row (see CopyChunk2Data())
+ * - CHUNK_PACK_MPI: MPI_Pack of each component with the derived datatype comp_dtype
+ * - CHUNK_PACK_STREAM: vectorized copy of each row with non-temporal stores
+ *
+ * A chunk sent as floats (see ChunkToFloatTransport()) is converted during the copy of the rows, whatever the strategy, and the max
+ * relative error of the conversion is stored in the chunk.
+ *
+ * @param nmem the memory size of the data, in the topology of the chunk
+ * @param data the vector of data corresponding to the current memory
+ * @param chunk the chunk of memory to fill
+ */
+void CopyData2Chunk(const int nmem[3], const opt_real_ptr data, MemChunk* chunk) {
     BEGIN_FUNC;
     //--------------------------------------------------------------------------
     // get the current ax as the topo_in one (otherwise the copy doesn't make sense)
@@ -430,36 +859,524 @@ void CopyData2Chunk(const int nmem[3], const opt_double_ptr data, MemChunk* chun
 
     // get the indexes to copy
     const size_t n_loop    = chunk->isize[ax[1]] * chunk->isize[ax[2]];
-    const size_t nmax_byte = chunk->isize[ax[0]] * nf * sizeof(double);
+    const size_t nmax_byte = chunk->isize[ax[0]] * nf * sizeof(flups_real);
 
     FLUPS_CHECK((chunk->istart[0] + chunk->isize[0]) <= nmem[0], "istart = %d + size = %d must be smaller than the local size %d", chunk->istart[0], chunk->isize[0], nmem[0]);
     FLUPS_CHECK((chunk->istart[1] + chunk->isize[1]) <= nmem[1], "istart = %d + size = %d must be smaller than the local size %d", chunk->istart[1], chunk->isize[1], nmem[1]);
     FLUPS_CHECK((chunk->istart[2] + chunk->isize[2]) <= nmem[2], "istart = %d + size = %d must be smaller than the local size %d", chunk->istart[2], chunk->isize[2], nmem[2]);
 
-#pragma omp parallel proc_bind(close)
-    for (int lia = 0; lia < chunk->nda; ++lia) {
-        // get the starting address for the chunk, taking into account the padding
-        opt_double_ptr trg_data = chunk->data + chunk->size_padded * lia;
-        opt_double_ptr src_data = data + localIndex(ax[0], listart[0], listart[1], listart[2], ax[0], nmem, nf, lia);
+    //..........................................................................
+    if (chunk->pack == CHUNK_PACK_MPI && !chunk->is_float) {
+        // the datatype of one component gives the layout of the data, MPI packs it contiguously
+        const int n_comp_byte = (int)(n_loop * nmax_byte);
+        for (int lia = 0; lia < chunk->nda; ++lia) {
+            opt_real_ptr trg_data = chunk->data + chunk->size_padded * lia;
+            opt_real_ptr src_data = data + localIndex(ax[0], listart[0], listart[1], listart[2], ax[0], nmem, nf, lia);
+            int            position = 0;
+            MPI_Pack(src_data, 1, chunk->comp_dtype, trg_data, n_comp_byte, &position, MPI_COMM_SELF);
+            FLUPS_CHECK(position == n_comp_byte, "MPI_Pack has packed %d bytes instead of %d", position, n_comp_byte);
+        }
+        END_FUNC;
+        return;
+    }
 
-        // we alwas know that the chunk memory is aligned
-        FLUPS_CHECK(m_isaligned(trg_data,FLUPS_ALIGNMENT), "The chunk memory should be aligned, size_padded = %ld", chunk->size_padded);
-        FLUPS_INFO("pointers are %p and %p", trg_data, src_data);
-        FLUPS_INFO("copy %d %d %d from data to chunk", chunk->isize[0], chunk->isize[1], chunk->isize[2]);
-        FLUPS_INFO("copy %zu bytes in %zu loops", nmax_byte, n_loop);
-        FLUPS_INFO("local memory is %d %d %d, listart is %d %d %d", nmem[0], nmem[1], nmem[2], chunk->istart[0], chunk->istart[1], chunk->istart[2]);
+    //..........................................................................
+    const bool   is_float  = chunk->is_float;
+    const bool   is_stream = (chunk->pack == CHUNK_PACK_STREAM) && !is_float;
+    const size_t n_row     = nmax_byte / sizeof(flups_real);
+    double       max_val   = 0.0;
+    double       max_err   = 0.0;
+#pragma omp parallel proc_bind(close) reduction(max : max_val, max_err)
+    {
+        for (int lia = 0; lia < chunk->nda; ++lia) {
+            // get the starting address for the chunk, taking into account the padding
+            opt_real_ptr trg_data = chunk->data + chunk->size_padded * lia;
+            opt_real_ptr src_data = data + localIndex(ax[0], listart[0], listart[1], listart[2], ax[0], nmem, nf, lia);
+
+            // we alwas know that the chunk memory is aligned
+            FLUPS_CHECK(m_isaligned(trg_data,FLUPS_ALIGNMENT), "The chunk memory should be aligned, size_padded = %ld", chunk->size_padded);
+            FLUPS_INFO("pointers are %p and %p", trg_data, src_data);
+            FLUPS_INFO("copy %d %d %d from data to chunk", chunk->isize[0], chunk->isize[1], chunk->isize[2]);
+            FLUPS_INFO("copy %zu bytes in %zu loops", nmax_byte, n_loop);
+            FLUPS_INFO("local memory is %d %d %d, listart is %d %d %d", nmem[0], nmem[1], nmem[2], chunk->istart[0], chunk->istart[1], chunk->istart[2]);
 
 #pragma omp for schedule(static)
-        for (int il = 0; il < n_loop; ++il) {
-            // get the local indexes (we cannot used the collaspedIndex one!!!)
-            const int i2 = il / (chunk->isize[ax[1]]);
-            const int i1 = il % (chunk->isize[ax[1]]);
-            // get the starting adddress for the memcpy
-            const double* __restrict vsrc = src_data + localIndex(ax0, 0, i1, i2, ax0, nmem, nf, 0);
-            double* __restrict vtrg       = trg_data + localIndex(ax0, 0, i1, i2, ax0, chunk->isize, nf, 0);
-            std::memcpy(vtrg, vsrc, nmax_byte);
+            for (int il = 0; il < n_loop; ++il) {
+                // get the local indexes (we cannot used the collaspedIndex one!!!)
+                const int i2 = il / (chunk->isize[ax[1]]);
+                const int i1 = il % (chunk->isize[ax[1]]);
+                // get the starting adddress for the memcpy
+                const flups_real* __restrict vsrc = src_data + localIndex(ax0, 0, i1, i2, ax0, nmem, nf, 0);
+                const size_t trg_id               = localIndex(ax0, 0, i1, i2, ax0, chunk->isize, nf, 0);
+                if (is_float) {
+                    // the i-th value of the chunk is stored as the i-th float of the buffer
+                    char* __restrict ftrg = reinterpret_cast<char*>(chunk->data) + (chunk->size_padded * lia + trg_id) * sizeof(float);
+                    for (size_t i = 0; i < n_row; ++i) {
+                        const double val  = (double)vsrc[i];
+                        const float  fval = (float)val;
+                        std::memcpy(ftrg + i * sizeof(float), &fval, sizeof(float));
+                        max_val = m_max(max_val, std::fabs(val));
+                        max_err = m_max(max_err, std::fabs(val - (double)fval));
+                    }
+                } else if (is_stream) {
+                    StreamCopy(trg_data + trg_id, vsrc, n_row);
+                } else {
+                    std::memcpy(trg_data + trg_id, vsrc, nmax_byte);
+                }
+            }
+        }
+#if (FLUPS_STREAM_PACK)
+        // the non-temporal stores of each thread must be visible before the chunk is used
+        if (is_stream) _mm_sfence();
+#endif
+    }
+    if (is_float) {
+        chunk->float_err = (max_val > 0.0) ? (max_err / max_val) : 0.0;
+    }
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief Copy a range of the chunk memory from the data pointer
+ *
+ * The range [start, start + count[ is given in number of doubles in the chunk memory, i.e. including the padding between the components.
+ * The padding is skipped. The function is NOT multithreaded as it is meant to be called by one thread on its own range.
+ *
+ * @param nmem the memory size of the data
+ * @param data the vector of data corresponding to the current memory
+ * @param chunk the chunk of memory to fill
+ * @param start the first double to fill in the chunk memory
+ * @param count the number of doubles to fill in the chunk memory
+ */
+void CopyData2ChunkRange(const int nmem[3], const opt_real_ptr data, MemChunk* chunk, const size_t start, const size_t count) {
+    BEGIN_FUNC;
+    FLUPS_CHECK((start + count) <= chunk->size_padded * chunk->nda, "the range %zu + %zu must be smaller than the chunk size %zu", start, count, chunk->size_padded * chunk->nda);
+    //--------------------------------------------------------------------------
+    // get the current ax as the topo_in one (otherwise the copy doesn't make sense)
+    const int nf         = chunk->nf;
+    const int ax0        = chunk->axis;
+    const int ax[3]      = {ax0, (ax0 + 1) % 3, (ax0 + 2) % 3};
+    const int listart[3] = {chunk->istart[ax[0]], chunk->istart[ax[1]], chunk->istart[ax[2]]};
+
+    // the number of doubles in one line and in one component (without the padding)
+    const size_t n_row  = (size_t)chunk->isize[ax[0]] * nf;
+    const size_t n_comp = n_row * (size_t)chunk->isize[ax[1]] * (size_t)chunk->isize[ax[2]];
+
+    size_t       id  = start;
+    const size_t end = start + count;
+    while (id < end) {
+        const int    lia = id / chunk->size_padded;
+        const size_t loc = id % chunk->size_padded;
+        // if we are in the padding, go to the next component
+        if (loc >= n_comp) {
+            id += chunk->size_padded - loc;
+            continue;
         }
+        // get the local indexes of the line and the position inside it
+        const size_t il = loc / n_row;
+        const size_t ir = loc % n_row;
+        const int    i2 = il / (chunk->isize[ax[1]]);
+        const int    i1 = il % (chunk->isize[ax[1]]);
+        const size_t n  = m_min(n_row - ir, end - id);
+        // get the starting adddress for the memcpy
+        const flups_real* __restrict vsrc = data + localIndex(ax[0], listart[0], listart[1], listart[2], ax[0], nmem, nf, lia) + localIndex(ax0, 0, i1, i2, ax0, nmem, nf, 0) + ir;
+        flups_real* __restrict vtrg       = chunk->data + id;
+        std::memcpy(vtrg, vsrc, n * sizeof(flups_real));
+        id += n;
     }
     //--------------------------------------------------------------------------
     END_FUNC;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Copy the memory described by a chunk directly in the shuffled layout of the matching chunk in the other topology
+ *
+ * This is used for the self communication: the data never goes through MPI and the pack and the shuffle are fused in one pass.
+ * Once done, the target chunk is in the same state as a received chunk after DoShuffleChunk() and can be copied with CopyChunk2Data().
+ * The transposition is done by tiles so that both the reads and the writes stay in cache.
+ *
+ * @param nmem the memory size of the data, in the topology of src_chunk
+ * @param data the vector of data corresponding to the current memory
+ * @param src_chunk the chunk describing the memory to copy, in the topology of the data
+ * @param trg_chunk the chunk describing the same block in the other topology, its memory is filled
+ */
+void CopyData2ShuffledChunk(const int nmem[3], const opt_real_ptr data, const MemChunk* src_chunk, MemChunk* trg_chunk) {
+    BEGIN_FUNC;
+    FLUPS_CHECK(src_chunk->nf == trg_chunk->nf && src_chunk->nda == trg_chunk->nda, "the two chunks must have the same nf (%d vs %d) and nda (%d vs %d)", src_chunk->nf, trg_chunk->nf, src_chunk->nda, trg_chunk->nda);
+    FLUPS_CHECK(src_chunk->isize[0] == trg_chunk->isize[0] && src_chunk->isize[1] == trg_chunk->isize[1] && src_chunk->isize[2] == trg_chunk->isize[2], "the two chunks must describe the same block");
+    //--------------------------------------------------------------------------
+    // size of the tiles used for the transposition
+    const int block = 32;
+
+    const int nf         = src_chunk->nf;
+    const int src_ax0    = src_chunk->axis;
+    const int src_ax[3]  = {src_ax0, (src_ax0 + 1) % 3, (src_ax0 + 2) % 3};
+    const int listart[3] = {src_chunk->istart[src_ax[0]], src_chunk->istart[src_ax[1]], src_chunk->istart[src_ax[2]]};
+    // the indexes follow the target layout
+    const int ax0   = trg_chunk->axis;
+    const int ax[3] = {ax0, (ax0 + 1) % 3, (ax0 + 2) % 3};
+    const int n[3]  = {trg_chunk->isize[ax[0]], trg_chunk->isize[ax[1]], trg_chunk->isize[ax[2]]};
+    // strides of the target indexes in the source and in the target memory
+    const size_t src_stride[3] = {localIndex(ax0, 1, 0, 0, src_ax0, nmem, nf, 0), localIndex(ax0, 0, 1, 0, src_ax0, nmem, nf, 0), localIndex(ax0, 0, 0, 1, src_ax0, nmem, nf, 0)};
+    const size_t trg_stride[3] = {(size_t)nf, (size_t)nf * n[0], (size_t)nf * n[0] * n[1]};
+    // the target index which is contiguous in the source memory and the remaining one
+    const int id_cont  = (src_ax0 == ax[0]) ? 0 : ((src_ax0 == ax[1]) ? 1 : 2);
+    const int id_other = 3 - id_cont;
+
+#pragma omp parallel proc_bind(close)
+    for (int lia = 0; lia < src_chunk->nda; ++lia) {
+        const opt_real_ptr src_data = data + localIndex(src_ax0, listart[0], listart[1], listart[2], src_ax0, nmem, nf, lia);
+        opt_real_ptr       trg_data = trg_chunk->data + trg_chunk->size_padded * lia;
+
+        if (id_cont == 0) {
+            // the two layouts share the same fastest axis, this is a copy of the rows
+            const size_t n_loop    = (size_t)n[1] * n[2];
+            const size_t nmax_byte = (size_t)n[0] * nf * sizeof(flups_real);
+#pragma omp for schedule(static)
+            for (size_t il = 0; il < n_loop; ++il) {
+                const int i2 = il / n[1];
+                const int i1 = il % n[1];
+                std::memcpy(trg_data + i1 * trg_stride[1] + i2 * trg_stride[2], src_data + i1 * src_stride[1] + i2 * src_stride[2], nmax_byte);
+            }
+        } else {
+            // transpose the tiles made of the target fastest index and the source fastest one
+            const int    nb0     = (n[0] + block - 1) / block;
+            const int    nbc     = (n[id_cont] + block - 1) / block;
+            const size_t n_tiles = (size_t)nb0 * nbc * n[id_other];
+#pragma omp for schedule(static)
+            for (size_t it = 0; it < n_tiles; ++it) {
+                const int    io     = it / ((size_t)nb0 * nbc);
+                const int    ibc    = (it / nb0) % nbc;
+                const int    ib0    = it % nb0;
+                const int    ic_end = m_min((ibc + 1) * block, n[id_cont]);
+                const int    i0_end = m_min((ib0 + 1) * block, n[0]);
+                const flups_real* __restrict vsrc = src_data + io * src_stride[id_other];
+                flups_real* __restrict vtrg       = trg_data + io * trg_stride[id_other];
+                for (int ic = ibc * block; ic < ic_end; ++ic) {
+                    for (int i0 = ib0 * block; i0 < i0_end; ++i0) {
+                        for (int i = 0; i < nf; ++i) {
+                            vtrg[i0 * trg_stride[0] + ic * trg_stride[id_cont] + i] = vsrc[i0 * src_stride[0] + ic * src_stride[id_cont] + i];
+                        }
+                    }
+                }
+            }
+        }
+    }
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief reset the memory outside of a box, the box being left untouched
+ *
+ * @param chunk a chunk in the layout of the memory (gives the axis, nf and nda)
+ * @param box the box to preserve (start and end, 012-indexing)
+ * @param nmem the memory size of the layout
+ * @param reset_size the total size of the memory to reset
+ * @param mem the memory
+ */
+void ResetOutsideBox(const MemChunk *chunk, const int box[6], const int nmem[3], const size_t reset_size, opt_real_ptr mem) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    const int    nf    = chunk->nf;
+    const int    ax0   = chunk->axis;
+    const int    ax[3] = {ax0, (ax0 + 1) % 3, (ax0 + 2) % 3};
+    const size_t row   = (size_t)nmem[ax[0]] * nf;
+    const size_t n_row = (size_t)nmem[ax[1]] * nmem[ax[2]] * chunk->nda;
+
+#pragma omp parallel for schedule(static) proc_bind(close)
+    for (size_t ir = 0; ir < n_row; ++ir) {
+        const int      i1       = ir % nmem[ax[1]];
+        const int      i2       = (ir / nmem[ax[1]]) % nmem[ax[2]];
+        opt_real_ptr row_data = mem + ir * row;
+        if (box[ax[1]] <= i1 && i1 < box[3 + ax[1]] && box[ax[2]] <= i2 && i2 < box[3 + ax[2]]) {
+            std::memset(row_data, 0, (size_t)box[ax[0]] * nf * sizeof(flups_real));
+            std::memset(row_data + (size_t)box[3 + ax[0]] * nf, 0, (row - (size_t)box[3 + ax[0]] * nf) * sizeof(flups_real));
+        } else {
+            std::memset(row_data, 0, row * sizeof(flups_real));
+        }
+    }
+    // reset the end of the memory if any
+    if (reset_size > n_row * row) {
+        std::memset(mem + n_row * row, 0, (reset_size - n_row * row) * sizeof(flups_real));
+    }
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief gets the memory size of a topology in the real/complex state of the chunks defined in it
+ *
+ * The topology might have been switched to real or complex since the creation of the chunks.
+ *
+ * @param topo the topology in which the chunks are defined
+ * @param chunk one of the chunks
+ * @param nmem the memory size matching the chunk
+ */
+void ChunkNmem(const Topology* topo, const MemChunk* chunk, int nmem[3]) {
+    //--------------------------------------------------------------------------
+    for (int id = 0; id < 3; ++id) {
+        nmem[id] = topo->nmem(id);
+    }
+    if (chunk->nf > topo->nf()) {
+        nmem[topo->axis()] /= 2;
+    } else if (chunk->nf < topo->nf()) {
+        nmem[topo->axis()] *= 2;
+    }
+    //--------------------------------------------------------------------------
+}
+
+/**
+ * @brief returns the name of a packing strategy
+ */
+const char* ChunkPackName(const ChunkPackType pack) {
+    switch (pack) {
+        case CHUNK_PACK_MEMCPY:
+            return "memcpy";
+        case CHUNK_PACK_MPI:
+            return "MPI datatype";
+        case CHUNK_PACK_STREAM:
+            return "streaming";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief chooses the fastest packing strategy of every chunk, see CopyData2Chunk()
+ *
+ * The strategies are timed once per distinct chunk shape (axis, size and nf) and the fastest one is stored in all the chunks of that shape.
+ * To limit the setup cost, the benchmark uses one component and keeps the rows of the chunk (length and stride) but the number of rows
+ * is limited so that the source memory stays below 32MB.
+ * A strategy that does not reproduce the memcpy packing is discarded.
+ *
+ * @param nmem the memory size of the data, in the topology of the chunks
+ * @param n_chunks the number of chunks
+ * @param chunks the chunks
+ */
+void TuneChunkPack(const int nmem[3], const int n_chunks, MemChunk* chunks) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    const size_t max_bench_byte = ((size_t)32) << 20;
+    const int    n_rep          = 3;
+
+    bool* is_tuned = reinterpret_cast<bool*>(m_calloc(m_max(n_chunks, 1) * sizeof(bool)));
+    std::memset(is_tuned, 0, m_max(n_chunks, 1) * sizeof(bool));
+
+    for (int ic = 0; ic < n_chunks; ++ic) {
+        if (is_tuned[ic]) continue;
+        const MemChunk* chunk = chunks + ic;
+        const int       nf    = chunk->nf;
+        const int       ax0   = chunk->axis;
+        const int       ax[3] = {ax0, (ax0 + 1) % 3, (ax0 + 2) % 3};
+
+        //......................................................................
+        // the benchmark chunk has the rows of the chunk, in a memory which is just large enough
+        MemChunk* bench         = reinterpret_cast<MemChunk*>(m_calloc(sizeof(MemChunk)));
+        const size_t row_byte   = (size_t)nmem[ax[0]] * nf * sizeof(flups_real);
+        const size_t max_row    = m_max(max_bench_byte / row_byte, (size_t)1);
+        bench->axis             = ax0;
+        bench->is_float         = false;
+        bench->nf               = nf;
+        bench->nda              = 1;
+        bench->istart[ax[0]]    = chunk->istart[ax[0]];
+        bench->istart[ax[1]]    = 0;
+        bench->istart[ax[2]]    = 0;
+        bench->isize[ax[0]]     = chunk->isize[ax[0]];
+        bench->isize[ax[1]]     = (int)m_min((size_t)chunk->isize[ax[1]], max_row);
+        bench->isize[ax[2]]     = (int)m_min((size_t)chunk->isize[ax[2]], m_max(max_row / bench->isize[ax[1]], (size_t)1));
+        bench->size_padded      = get_ChunkPaddedSize(nf, bench);
+        int bench_nmem[3];
+        bench_nmem[ax[0]] = nmem[ax[0]];
+        bench_nmem[ax[1]] = bench->isize[ax[1]];
+        bench_nmem[ax[2]] = bench->isize[ax[2]];
+        ChunkToMPIDataType(bench_nmem, bench);
+
+        const size_t   n_src  = (size_t)bench_nmem[0] * bench_nmem[1] * bench_nmem[2] * nf;
+        const size_t   n_comp = (size_t)bench->isize[0] * bench->isize[1] * bench->isize[2] * nf;
+        opt_real_ptr src    = reinterpret_cast<flups_real*>(m_calloc(n_src * sizeof(flups_real)));
+        opt_real_ptr ref    = reinterpret_cast<flups_real*>(m_calloc(bench->size_padded * sizeof(flups_real)));
+        opt_real_ptr trial  = reinterpret_cast<flups_real*>(m_calloc(bench->size_padded * sizeof(flups_real)));
+        for (size_t id = 0; id < n_src; ++id) {
+            src[id] = (flups_real)id;
+        }
+        // the memcpy packing is the reference
+        bench->data = ref;
+        bench->pack = CHUNK_PACK_MEMCPY;
+        CopyData2Chunk(bench_nmem, src, bench);
+
+        //......................................................................
+        double time[n_chunk_pack];
+        bench->data = trial;
+        for (int ip = 0; ip < n_chunk_pack; ++ip) {
+            time[ip]    = std::numeric_limits<double>::max();
+            bench->pack = static_cast<ChunkPackType>(ip);
+            if (bench->pack == CHUNK_PACK_STREAM && !FLUPS_STREAM_PACK) continue;
+
+            std::memset(trial, 0, n_comp * sizeof(flups_real));
+            // the first copy is a warm-up
+            for (int irep = 0; irep <= n_rep; ++irep) {
+                const double t0 = MPI_Wtime();
+                CopyData2Chunk(bench_nmem, src, bench);
+                const double t1 = MPI_Wtime();
+                if (irep > 0) time[ip] = m_min(time[ip], t1 - t0);
+            }
+            if (std::memcmp(trial, ref, n_comp * sizeof(flups_real)) != 0) {
+                FLUPS_WARNING("the %s packing does not match the memcpy one, it is discarded", ChunkPackName(bench->pack));
+                time[ip] = std::numeric_limits<double>::max();
+            }
+        }
+        int best = CHUNK_PACK_MEMCPY;
+        for (int ip = 0; ip < n_chunk_pack; ++ip) {
+            best = (time[ip] < time[best]) ? ip : best;
+        }
+        FLUPS_INFO("packing of the chunks of size %d %d %d: memcpy = %e, MPI datatype = %e, streaming = %e -> %s", chunk->isize[0], chunk->isize[1], chunk->isize[2],
+                   time[CHUNK_PACK_MEMCPY], time[CHUNK_PACK_MPI], time[CHUNK_PACK_STREAM], ChunkPackName(static_cast<ChunkPackType>(best)));
+
+        //......................................................................
+        // all the chunks with the same shape use the winner
+        for (int jc = ic; jc < n_chunks; ++jc) {
+            MemChunk* cchunk = chunks + jc;
+            if (is_tuned[jc] || cchunk->axis != ax0 || cchunk->nf != nf ||
+                cchunk->isize[0] != chunk->isize[0] || cchunk->isize[1] != chunk->isize[1] || cchunk->isize[2] != chunk->isize[2]) continue;
+            // MPI_Pack takes the size of a component as an int
+            const size_t comp_byte = (size_t)cchunk->isize[0] * cchunk->isize[1] * cchunk->isize[2] * nf * sizeof(flups_real);
+            cchunk->pack           = (best == CHUNK_PACK_MPI && comp_byte > (size_t)INT_MAX) ? CHUNK_PACK_MEMCPY : static_cast<ChunkPackType>(best);
+            is_tuned[jc]           = true;
+        }
+
+        MPI_Type_free(&bench->dtype);
+        MPI_Type_free(&bench->comp_dtype);
+        m_free(src);
+        m_free(ref);
+        m_free(trial);
+        m_free(bench);
+    }
+    m_free(is_tuned);
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
+
+/**
+ * @brief chooses the fastest way to unpack every received chunk: in its buffer followed by the shuffle and the copy to the data,
+ * or directly in the data with its transposed datatype trsp_dtype, see ChunkToTrspMPIDataType()
+ *
+ * The chunks without shuffle are always received in the data. For the other ones, both paths are timed once per distinct chunk shape
+ * (axes, size and nf) on a benchmark chunk built as in TuneChunkPack(). The datatype path is measured with MPI_Unpack, which performs the
+ * same scattering as the reception of the message. A datatype that does not reproduce the shuffle is discarded.
+ *
+ * @param nmem the memory size of the data, in the topology of the chunks
+ * @param n_chunks the number of chunks
+ * @param chunks the chunks
+ */
+void TuneChunkUnpack(const int nmem[3], const int n_chunks, MemChunk* chunks) {
+    BEGIN_FUNC;
+    //--------------------------------------------------------------------------
+    const size_t max_bench_byte = ((size_t)32) << 20;
+    const int    n_rep          = 3;
+
+    bool* is_tuned = reinterpret_cast<bool*>(m_calloc(m_max(n_chunks, 1) * sizeof(bool)));
+    std::memset(is_tuned, 0, m_max(n_chunks, 1) * sizeof(bool));
+
+    for (int ic = 0; ic < n_chunks; ++ic) {
+        if (is_tuned[ic]) continue;
+        MemChunk* chunk = chunks + ic;
+        // without shuffle, the received data is simply scattered in the memory
+        if (chunk->is_identity) {
+            chunk->unpack = CHUNK_UNPACK_MPI;
+            is_tuned[ic]  = true;
+            continue;
+        }
+        const int nf    = chunk->nf;
+        const int ax0   = chunk->axis;
+        const int ax[3] = {ax0, (ax0 + 1) % 3, (ax0 + 2) % 3};
+
+        //......................................................................
+        // the benchmark chunk has the rows of the chunk, in a memory which is just large enough
+        MemChunk* bench       = reinterpret_cast<MemChunk*>(m_calloc(sizeof(MemChunk)));
+        const size_t row_byte = (size_t)nmem[ax[0]] * nf * sizeof(flups_real);
+        const size_t max_row  = m_max(max_bench_byte / row_byte, (size_t)1);
+        bench->axis           = ax0;
+        bench->dest_axis      = chunk->dest_axis;
+        bench->is_identity    = false;
+        bench->is_float       = false;
+        bench->nf             = nf;
+        bench->nda            = 1;
+        bench->istart[ax[0]]  = chunk->istart[ax[0]];
+        bench->istart[ax[1]]  = 0;
+        bench->istart[ax[2]]  = 0;
+        bench->isize[ax[0]]   = chunk->isize[ax[0]];
+        bench->isize[ax[1]]   = (int)m_min((size_t)chunk->isize[ax[1]], max_row);
+        bench->isize[ax[2]]   = (int)m_min((size_t)chunk->isize[ax[2]], m_max(max_row / bench->isize[ax[1]], (size_t)1));
+        bench->size_padded    = get_ChunkPaddedSize(nf, bench);
+        int bench_nmem[3];
+        bench_nmem[ax[0]] = nmem[ax[0]];
+        bench_nmem[ax[1]] = bench->isize[ax[1]];
+        bench_nmem[ax[2]] = bench->isize[ax[2]];
+        ChunkToMPIDataType(bench_nmem, bench);
+        ChunkToTrspMPIDataType(bench_nmem, bench);
+
+        const size_t   n_mem    = (size_t)bench_nmem[0] * bench_nmem[1] * bench_nmem[2] * nf;
+        const size_t   n_comp   = (size_t)bench->isize[0] * bench->isize[1] * bench->isize[2] * nf;
+        opt_real_ptr stream   = reinterpret_cast<flups_real*>(m_calloc(n_comp * sizeof(flups_real)));
+        opt_real_ptr mem_shfl = reinterpret_cast<flups_real*>(m_calloc(n_mem * sizeof(flups_real)));
+        opt_real_ptr mem_mpi  = reinterpret_cast<flups_real*>(m_calloc(n_mem * sizeof(flups_real)));
+        bench->data             = reinterpret_cast<flups_real*>(m_calloc(bench->size_padded * sizeof(flups_real)));
+        // the planning might overwrite the buffer
+        PlanShuffleChunk(nf == 2, bench);
+        for (size_t id = 0; id < n_comp; ++id) {
+            stream[id] = (flups_real)id;
+        }
+        std::memset(mem_shfl, 0, n_mem * sizeof(flups_real));
+        std::memset(mem_mpi, 0, n_mem * sizeof(flups_real));
+
+        //......................................................................
+        // the first unpacking is a warm-up
+        double time[2] = {std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+        for (int irep = 0; irep <= n_rep; ++irep) {
+            std::memcpy(bench->data, stream, n_comp * sizeof(flups_real));
+            const double t0 = MPI_Wtime();
+            DoShuffleChunk(bench);
+            CopyChunk2Data(bench, bench_nmem, mem_shfl);
+            const double t1 = MPI_Wtime();
+            if (irep > 0) time[CHUNK_UNPACK_SHUFFLE] = m_min(time[CHUNK_UNPACK_SHUFFLE], t1 - t0);
+        }
+        for (int irep = 0; irep <= n_rep; ++irep) {
+            int          position = 0;
+            const double t0       = MPI_Wtime();
+            MPI_Unpack(stream, (int)(n_comp * sizeof(flups_real)), &position, mem_mpi + bench->offset, 1, bench->trsp_dtype, MPI_COMM_SELF);
+            const double t1 = MPI_Wtime();
+            if (irep > 0) time[CHUNK_UNPACK_MPI] = m_min(time[CHUNK_UNPACK_MPI], t1 - t0);
+        }
+        if (std::memcmp(mem_shfl, mem_mpi, n_mem * sizeof(flups_real)) != 0) {
+            FLUPS_WARNING("the MPI datatype unpacking does not match the shuffle from %d to %d, it is discarded", chunk->dest_axis, chunk->axis);
+            time[CHUNK_UNPACK_MPI] = std::numeric_limits<double>::max();
+        }
+        const ChunkUnpackType best = (time[CHUNK_UNPACK_MPI] < time[CHUNK_UNPACK_SHUFFLE]) ? CHUNK_UNPACK_MPI : CHUNK_UNPACK_SHUFFLE;
+        FLUPS_INFO("unpacking of the chunks of size %d %d %d from axis %d: shuffle = %e, MPI datatype = %e -> %d", chunk->isize[0], chunk->isize[1], chunk->isize[2],
+                   chunk->dest_axis, time[CHUNK_UNPACK_SHUFFLE], time[CHUNK_UNPACK_MPI], best);
+
+        //......................................................................
+        // all the chunks with the same shape use the winner
+        for (int jc = ic; jc < n_chunks; ++jc) {
+            MemChunk* cchunk = chunks + jc;
+            if (is_tuned[jc] || cchunk->is_identity || cchunk->axis != ax0 || cchunk->dest_axis != chunk->dest_axis || cchunk->nf != nf ||
+                cchunk->isize[0] != chunk->isize[0] || cchunk->isize[1] != chunk->isize[1] || cchunk->isize[2] != chunk->isize[2]) continue;
+            cchunk->unpack = best;
+            is_tuned[jc]   = true;
+        }
+
+        FLUPS_FFTW(destroy_plan)(bench->shuffle);
+        MPI_Type_free(&bench->dtype);
+        MPI_Type_free(&bench->comp_dtype);
+        MPI_Type_free(&bench->trsp_dtype);
+        m_free(bench->data);
+        m_free(stream);
+        m_free(mem_shfl);
+        m_free(mem_mpi);
+        m_free(bench);
+    }
+    m_free(is_tuned);
+    //--------------------------------------------------------------------------
+    END_FUNC;
+}
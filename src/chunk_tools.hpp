@@ -7,12 +7,39 @@
 #ifndef CHUNKTOOLS_HPP_
 #define CHUNKTOOLS_HPP_
 
+#include <array>
+
 #include "Topology.hpp"
 #include "defines.hpp"
 
+/**
+ * @brief the strategies to pack a chunk from the data to its buffer, see CopyData2Chunk()
+ *
+ */
+enum ChunkPackType {
+    CHUNK_PACK_MEMCPY = 0,  //!< one memcpy per contiguous row
+    CHUNK_PACK_MPI    = 1,  //!< MPI_Pack with the derived datatype of one component
+    CHUNK_PACK_STREAM = 2   //!< vectorized copy of the rows with non-temporal stores
+};
+static const int n_chunk_pack = 3;
+
+/**
+ * @brief the strategies to unpack a received chunk in the data, see TuneChunkUnpack()
+ *
+ */
+enum ChunkUnpackType {
+    CHUNK_UNPACK_SHUFFLE = 0,  //!< received in the buffer, shuffled and copied to the data
+    CHUNK_UNPACK_MPI     = 1   //!< received directly in the data with the transposed datatype trsp_dtype
+};
+
+//! the key of the shared MPI datatypes of a chunk: nf, axis, dest_axis, isize[3], nmem[3], nda and the offset between the components
+typedef std::array<size_t, 11> ChunkDataTypesKey;
+
 /**
  * @brief A "chunk" is a memory block belonging to an input topology. The block is sent over to the output topology and shuffled
  *
+ * The chunks are allocated with m_calloc and have no destructor: their MPI datatypes, which may be shared with other chunks,
+ * are freed with FreeChunkMPIDataType().
  */
 struct MemChunk
 {
@@ -24,35 +51,60 @@ struct MemChunk
     int      dest_axis;  //!< the principal axis in the destination topology
     MPI_Comm comm;       //!< the communicator to be used for the communication, also dictates the dest_rank id
 
-    fftw_plan shuffle;  //!< the shuffle plan used by FFTW to reorder data
+    FLUPS_FFTW(plan) shuffle;      //!< the shuffle plan used by FFTW to reorder data (NULL if the shuffle is the identity)
+    bool      is_identity;  //!< true if the shuffle is the identity: the received data is already in the layout of the chunk
 
     size_t       offset;  //!< offset in memory in the "input" topology
     MPI_Datatype dtype;   //!< datatype in the "input" topology
 
+    MPI_Datatype  comp_dtype;  //!< datatype of one component in the "input" topology (relative to the start of the component)
+    ChunkPackType pack;        //!< the strategy used to pack the chunk in its buffer
+
+    MPI_Datatype    trsp_dtype;  //!< datatype in the "input" topology following the layout of the received data (the axis of the "output" topology first)
+    ChunkUnpackType unpack;      //!< the strategy used to unpack the chunk once received
+
     MPI_Datatype dest_dtype;   //!< datatype in the "output" topology
 
+    ChunkDataTypesKey dtype_key;  //!< the key of the datatypes if they are shared, see ChunkToSharedMPIDataType()
+
+    int          msg_count;  //!< count of the message made of the chunk buffer (1 if it does not fit in an int)
+    MPI_Datatype msg_dtype;  //!< datatype of the message made of the chunk buffer (FLUPS_MPI_REAL if the count fits in an int)
+
+    bool   is_float;   //!< true if the chunk buffer is sent as floats: it is converted during the packing and back before the shuffle or during the copy
+    double float_err;  //!< max relative error due to the conversion to float during the last packing of the chunk
+
     int            nda;          //!< the number of data array (1 if scalar, 3 if vector)
     int            nf;           //!< the number of double per data (1 if real, 2 if complex)
     size_t         size_padded;  //!< padded size for the data ptr
-    opt_double_ptr data;         //!< the pointer to the data in the buffer
-
-    ~MemChunk(){
-        MPI_Type_free(&dtype);
-        MPI_Type_free(&dest_dtype);
-    }
+    opt_real_ptr data;         //!< the pointer to the data in the buffer
 };
 
 void PopulateChunk(const int shift[3], const Topology* topo_in, const Topology* topo_out, int* n_chunks, MemChunk** chunks);
 
-void ChunkToNewComm(const MPI_Comm new_comm, const MPI_Group new_group, MemChunk* chunk, bool* is_in_comm);
+void FreeChunkMPIDataType(MemChunk* chunk);
+void ChunksDestRankInGroup(const MPI_Group group, const int n_chunks, const MemChunk* chunks, int* dest_rank);
+int  ChunksToNewComm(const MPI_Comm new_comm, const MPI_Group new_group, const int n_chunks, MemChunk* chunks);
 void PlanShuffleChunk(const bool iscomplex, MemChunk* chunk);
 void DoShuffleChunk(MemChunk* chunk);
 
-void CopyChunk2Data(const MemChunk* chunk, const int nmem[3], opt_double_ptr data);
-void CopyData2Chunk(const int nmem[3], const opt_double_ptr data, MemChunk* chunk);
+void CopyChunk2Data(const MemChunk* chunk, const int nmem[3], opt_real_ptr data);
+void CopyData2Chunk(const int nmem[3], const opt_real_ptr data, MemChunk* chunk);
+void CopyData2ChunkRange(const int nmem[3], const opt_real_ptr data, MemChunk* chunk, const size_t start, const size_t count);
+void CopyData2ShuffledChunk(const int nmem[3], const opt_real_ptr data, const MemChunk* src_chunk, MemChunk* trg_chunk);
+void ResetOutsideBox(const MemChunk* chunk, const int box[6], const int nmem[3], const size_t reset_size, opt_real_ptr mem);
 
+void ChunkNmem(const Topology* topo, const MemChunk* chunk, int nmem[3]);
+const char* ChunkPackName(const ChunkPackType pack);
+void TuneChunkPack(const int nmem[3], const int n_chunks, MemChunk* chunks);
+void TuneChunkUnpack(const int nmem[3], const int n_chunks, MemChunk* chunks);
+
+void ChunkToSharedMPIDataType(const int nmem[3], MemChunk* chunk);
 void ChunkToMPIDataType(const int nmem[3], MemChunk* chunk);//, size_t* offset, MPI_Datatype* type_xyzd);
+void ChunkToTrspMPIDataType(const int nmem[3], MemChunk* chunk);
 void ChunkToDestMPIDataType(MemChunk* chunk);
+void ChunkToMsgMPIDataType(MemChunk* chunk);
+void ChunkToFloatTransport(MemChunk* chunk);
+void LargeContiguousType(const size_t count, MPI_Datatype* dtype);
 
 /**
  * @brief returns the memory size (padded to a multiple of alignment) of a MemChunk
@@ -65,14 +117,24 @@ void ChunkToDestMPIDataType(MemChunk* chunk);
  * @return size_t
  */
 inline size_t get_ChunkPaddedSize(const size_t nf, const MemChunk* chunk) {
-    FLUPS_CHECK(FLUPS_ALIGNMENT % sizeof(double) == 0, "The alignement %d must be a multiple of %zu", FLUPS_ALIGNMENT, sizeof(double));
+    FLUPS_CHECK(FLUPS_ALIGNMENT % sizeof(flups_real) == 0, "The alignement %d must be a multiple of %zu", FLUPS_ALIGNMENT, sizeof(flups_real));
     //----------------------------------------------------------------------
     const size_t total     = (size_t)(chunk->isize[0]) * (size_t)(chunk->isize[1]) * (size_t)(chunk->isize[2]) * nf;
-    const size_t align     = FLUPS_ALIGNMENT / sizeof(double);
+    const size_t align     = FLUPS_ALIGNMENT / sizeof(flups_real);
     const size_t total_ext = total + (align - 1);
 
     return total_ext - (total_ext % align);
     //----------------------------------------------------------------------
 }
 
+/**
+ * @brief returns the number of flups_real sent on the wire for the chunk buffer, which is halved if the chunk is sent as floats
+ *
+ * @param chunk
+ */
+inline size_t get_ChunkMsgSize(const MemChunk* chunk) {
+    const size_t count = chunk->size_padded * chunk->nda;
+    return (chunk->is_float) ? (count + 1) / 2 : count;
+}
+
 #endif
\ No newline at end of file
@@ -42,6 +42,21 @@
 #define FLUPS_MPI_AGGRESSIVE 0
 #endif
 
+/**
+ * @brief single precision library: the data, the FFTs and the communications are in float (see flups_real)
+ *
+ * The Green's functions are computed in double and stored in float.
+ */
+#ifdef SINGLE_PREC
+#define FLUPS_SINGLE_PREC 1
+#define FLUPS_MPI_REAL MPI_FLOAT
+#define FLUPS_FFTW(name) fftwf_##name
+#else
+#define FLUPS_SINGLE_PREC 0
+#define FLUPS_MPI_REAL MPI_DOUBLE
+#define FLUPS_FFTW(name) fftw_##name
+#endif
+
 /**
  * @brief enables the more evenly distributed balancing between ranks
  *
@@ -106,6 +121,108 @@
 #define FLUPS_OLD_MPI 0
 #endif
 
+/**
+ * @brief use the MPI-4.0 partitioned communications in the non-blocking implementation
+ *
+ * the send of a chunk is split into partitions that are marked ready by the threads as soon as they are packed
+ */
+#if (0 == FLUPS_OLD_MPI) && !defined(MPI_NO_PARTITIONED)
+#define FLUPS_MPI_PARTITIONED 1
+#else
+#define FLUPS_MPI_PARTITIONED 0
+#endif
+
+/**
+ * @brief use the MPI-4.0 large-count variants (`_c` suffix) for the messages of the chunks
+ *
+ * without them, a message larger than FLUPS_MPI_MAX_COUNT doubles is sent with a derived datatype made of blocks of FLUPS_MPI_MAX_COUNT doubles
+ */
+#if (0 == FLUPS_OLD_MPI)
+#define FLUPS_MPI_LARGE_COUNT 1
+#else
+#define FLUPS_MPI_LARGE_COUNT 0
+#endif
+
+/**
+ * @brief max number of doubles sent with an int count, larger messages are split in blocks (see FLUPS_MPI_LARGE_COUNT)
+ *
+ */
+#ifndef MPI_MAX_COUNT
+#define FLUPS_MPI_MAX_COUNT INT_MAX
+#else
+#define FLUPS_MPI_MAX_COUNT MPI_MAX_COUNT
+#endif
+
+/**
+ * @brief use all the threads to drive the non-blocking communications if MPI provides MPI_THREAD_MULTIPLE
+ *
+ * each thread owns a subset of the chunks and posts, tests and processes its own requests.
+ * The threaded engine has neither the early copies of the isr backend nor the direct receptions of the nb backend.
+ * If MPI_THREAD_MULTIPLE is not provided, the master thread drives the communications
+ */
+#ifdef MPI_MULTITHREAD
+#define FLUPS_MPI_MULTITHREAD 1
+#else
+#define FLUPS_MPI_MULTITHREAD 0
+#endif
+
+/**
+ * @brief the communication backend used by default, the other ones are available at runtime
+ *
+ */
+#if defined(COMM_NONBLOCK)
+#define FLUPS_DEFAULT_COMM SWITCH_NB
+#elif defined(COMM_ISR)
+#define FLUPS_DEFAULT_COMM SWITCH_ISR
+#elif defined(COMM_RMA)
+#define FLUPS_DEFAULT_COMM SWITCH_RMA
+#else
+#define FLUPS_DEFAULT_COMM SWITCH_A2A
+#endif
+
+/**
+ * @brief number of forward/backward executions used to time each backend with SWITCH_AUTO
+ *
+ */
+#ifndef MPI_AUTOTUNE_NITER
+#define FLUPS_MPI_AUTOTUNE_NITER 3
+#else
+#define FLUPS_MPI_AUTOTUNE_NITER MPI_AUTOTUNE_NITER
+#endif
+
+/**
+ * @brief spawn a dedicated thread that drives the MPI progress during the switchtopos
+ *
+ * the thread is pinned on a spare core (if any) and sleeps outside of the communications.
+ * It requires MPI_THREAD_MULTIPLE, otherwise it is not created
+ */
+#ifdef MPI_PROGRESS_THREAD
+#define FLUPS_MPI_PROGRESS 1
+#else
+#define FLUPS_MPI_PROGRESS 0
+#endif
+
+/**
+ * @brief target size (in bytes) sent by a rank in one round of the all to all implementation
+ *
+ * the all to all is split in rounds over subsets of the ranks, a round being packed while the previous ones are in flight
+ */
+#ifndef MPI_A2A_ROUND_SIZE
+#define FLUPS_MPI_A2A_ROUND_SIZE 16777216
+#else
+#define FLUPS_MPI_A2A_ROUND_SIZE MPI_A2A_ROUND_SIZE
+#endif
+
+/**
+ * @brief max number of rounds of the all to all implementation
+ *
+ */
+#ifndef MPI_A2A_MAX_ROUND
+#define FLUPS_MPI_A2A_MAX_ROUND 8
+#else
+#define FLUPS_MPI_A2A_MAX_ROUND MPI_A2A_MAX_ROUND
+#endif
+
 #ifndef MPI_BATCH_SEND
 #define FLUPS_MPI_BATCH_SEND 1
 #else
@@ -118,6 +235,76 @@
 #define FLUPS_MPI_MAX_NBSEND MPI_MAX_NBSEND
 #endif
 
+/**
+ * @brief adapt the order and the throttling of the sends of the non-blocking implementations during their first executions
+ *
+ */
+#ifndef MPI_NO_ADAPT_SEND
+#define FLUPS_MPI_ADAPT_SEND 1
+#else
+#define FLUPS_MPI_ADAPT_SEND 0
+#endif
+
+/**
+ * @brief time the packing strategies of the chunks during the setup and keep the fastest one (memcpy otherwise)
+ *
+ */
+#ifndef NO_PACK_TUNING
+#define FLUPS_PACK_TUNING 1
+#else
+#define FLUPS_PACK_TUNING 0
+#endif
+
+/**
+ * @brief default choice for the reordering of the ranks based on the communication graph, which can be changed at runtime
+ *
+ */
+#ifdef REORDER_RANKS
+#define FLUPS_REORDER_RANKS 1
+#else
+#define FLUPS_REORDER_RANKS 0
+#endif
+
+/**
+ * @brief default choice for the node-aware pencil decomposition, which can be changed at runtime
+ *
+ */
+#ifdef NODE_AWARE
+#define FLUPS_NODE_AWARE 1
+#else
+#define FLUPS_NODE_AWARE 0
+#endif
+
+/**
+ * @brief choose the slab decomposition instead of the pencils when the cost model predicts it is faster, which can be changed at runtime
+ *
+ */
+#ifndef NO_SLAB
+#define FLUPS_SLAB_AUTO 1
+#else
+#define FLUPS_SLAB_AUTO 0
+#endif
+
+/**
+ * @brief do the transforms on the subset of the ranks chosen by the cost model, which can be changed at runtime
+ *
+ */
+#ifdef SUBSET_AUTO
+#define FLUPS_SUBSET_AUTO 1
+#else
+#define FLUPS_SUBSET_AUTO 0
+#endif
+
+/**
+ * @brief send the chunks of the field as floats in the packing backends, which can be changed at runtime
+ *
+ */
+#ifdef FLOAT_TRANSPORT
+#define FLUPS_FLOAT_TRANSPORT 1
+#else
+#define FLUPS_FLOAT_TRANSPORT 0
+#endif
+
 #ifndef MPI_DEFAULT_ORDER
 #define FLUPS_PRIORITYLIST 1
 #else
@@ -141,9 +328,9 @@
 
 #if (FLUPS_MPI_AGGRESSIVE)
 #if (FLUPS_MPI_ALLOC)
-using m_ptr_t = H3LPR::m_ptr<H3LPR::H3LPR_ALLOC_MPI, double*, FLUPS_ALIGNMENT>;
+using m_ptr_t = H3LPR::m_ptr<H3LPR::H3LPR_ALLOC_MPI, flups_real*, FLUPS_ALIGNMENT>;
 #else
-using m_ptr_t = H3LPR::m_ptr<H3LPR::H3LPR_ALLOC_POSIX, double*, FLUPS_ALIGNMENT>;
+using m_ptr_t = H3LPR::m_ptr<H3LPR::H3LPR_ALLOC_POSIX, flups_real*, FLUPS_ALIGNMENT>;
 #endif
 #endif
 
@@ -193,7 +380,7 @@ using m_ptr_t = H3LPR::m_ptr<H3LPR::H3LPR_ALLOC_POSIX, double*, FLUPS_ALIGNMENT>
             if (nf == 1) {                                                                                                                                                      \
                 for (int id = 0; id < onmax; id++) {                                                                                                                            \
                     const size_t   io     = id % ondim;                                                                                                                         \
-                    opt_double_ptr argloc = data + lia * memdim + collapsedIndex(ax0, 0, io, nmem, nf);                                                                         \
+                    opt_real_ptr argloc = data + lia * memdim + collapsedIndex(ax0, 0, io, nmem, nf);                                                                         \
                     if (id % topo->nloc(ax1) == 0) printf("\n");                                                                                                                \
                     for (size_t ii = 0; ii < inmax; ii++) {                                                                                                                     \
                         printf("%e \t ", argloc[ii]);                                                                                                                           \
@@ -203,7 +390,7 @@ using m_ptr_t = H3LPR::m_ptr<H3LPR::H3LPR_ALLOC_POSIX, double*, FLUPS_ALIGNMENT>
             } else {                                                                                                                                                            \
                 for (int id = 0; id < onmax; id++) {                                                                                                                            \
                     const size_t   io     = id % ondim;                                                                                                                         \
-                    opt_double_ptr argloc = data + lia * memdim + collapsedIndex(ax0, 0, io, nmem, nf);                                                                         \
+                    opt_real_ptr argloc = data + lia * memdim + collapsedIndex(ax0, 0, io, nmem, nf);                                                                         \
                     if (id % topo->nloc(ax1) == 0) printf("\n");                                                                                                                \
                     for (size_t ii = 0; ii < inmax; ii++) {                                                                                                                     \
                         printf("(%e, %e) \t", argloc[2 * ii], argloc[2 * ii + 1]);                                                                                              \
@@ -293,8 +480,8 @@ static inline int FLUPS_CMPT_ALIGNMENT(T a) {
 }
 
 typedef int* __restrict __attribute__((aligned(FLUPS_ALIGNMENT))) opt_int_ptr;
-typedef double* __restrict __attribute__((aligned(FLUPS_ALIGNMENT))) opt_double_ptr;
-typedef fftw_complex* __restrict __attribute__((aligned(FLUPS_ALIGNMENT))) opt_complex_ptr;
+typedef flups_real* __restrict __attribute__((aligned(FLUPS_ALIGNMENT))) opt_real_ptr;
+typedef FLUPS_FFTW(complex)* __restrict __attribute__((aligned(FLUPS_ALIGNMENT))) opt_complex_ptr;
 
 #define m_profStarti(prof, name, ...)                                    \
     ({                                                                   \
@@ -11,49 +11,49 @@
  * @brief perform the convolution for real to real cases - spectral diff
  * 
  */
-void Solver::dothemagic_rot_real_o1(double *data,const double koffset[3],const double kfact[3][3][2], const double symstart[3]){
+void Solver::dothemagic_rot_real_o1(flups_real *data,const double koffset[3],const double kfact[3][3][2], const double symstart[3]){
 #elif (KIND == 11)
 /**
  * @brief perform the convolution for complex to complex cases - spectral diff
  * 
  */
-void Solver::dothemagic_rot_complex_o1(double *data,const double koffset[3],const double kfact[3][3][2], const double symstart[3]){
+void Solver::dothemagic_rot_complex_o1(flups_real *data,const double koffset[3],const double kfact[3][3][2], const double symstart[3]){
 #elif (KIND == 02)
 /**
  * @brief perform the convolution for real to real cases - spectral diff
  * 
  */
-void Solver::dothemagic_rot_real_o2(double *data,const double koffset[3],const double kfact[3][3][2], const double symstart[3],const double hgrid[3]){
+void Solver::dothemagic_rot_real_o2(flups_real *data,const double koffset[3],const double kfact[3][3][2], const double symstart[3],const double hgrid[3]){
 #elif (KIND == 12)
 /**
  * @brief perform the convolution for complex to complex cases - spectral diff
  * 
  */
-void Solver::dothemagic_rot_complex_o2(double *data,const double koffset[3],const double kfact[3][3][2], const double symstart[3],const double hgrid[3]){
+void Solver::dothemagic_rot_complex_o2(flups_real *data,const double koffset[3],const double kfact[3][3][2], const double symstart[3],const double hgrid[3]){
 #elif (KIND == 04)
 /**
  * @brief perform the convolution for real to real cases - spectral diff
  * 
  */
-void Solver::dothemagic_rot_real_o4(double *data,const double koffset[3],const double kfact[3][3][2], const double symstart[3],const double hgrid[3]){
+void Solver::dothemagic_rot_real_o4(flups_real *data,const double koffset[3],const double kfact[3][3][2], const double symstart[3],const double hgrid[3]){
 #elif (KIND == 14)
 /**
  * @brief perform the convolution for complex to complex cases - spectral diff
  * 
  */
-void Solver::dothemagic_rot_complex_o4(double *data,const double koffset[3],const double kfact[3][3][2], const double symstart[3],const double hgrid[3]){
+void Solver::dothemagic_rot_complex_o4(flups_real *data,const double koffset[3],const double kfact[3][3][2], const double symstart[3],const double hgrid[3]){
 #elif (KIND == 06)
 /**
  * @brief perform the convolution for real to real cases - spectral diff
  * 
  */
-void Solver::dothemagic_rot_real_o6(double *data,const double koffset[3],const double kfact[3][3][2], const double symstart[3],const double hgrid[3]){
+void Solver::dothemagic_rot_real_o6(flups_real *data,const double koffset[3],const double kfact[3][3][2], const double symstart[3],const double hgrid[3]){
 #elif (KIND == 16)
 /**
  * @brief perform the convolution for complex to complex cases - spectral diff
  * 
  */
-void Solver::dothemagic_rot_complex_o6(double *data,const double koffset[3],const double kfact[3][3][2], const double symstart[3],const double hgrid[3]){
+void Solver::dothemagic_rot_complex_o6(flups_real *data,const double koffset[3],const double kfact[3][3][2], const double symstart[3],const double hgrid[3]){
 #endif
     BEGIN_FUNC;
     int cdim = ndim_ - 1;  // get current dim
@@ -76,8 +76,8 @@ void Solver::dothemagic_rot_complex_o6(double *data,const double koffset[3],cons
     topo_hat_[cdim]->get_istart_glob(istart);
 
     // get the adresses
-    opt_double_ptr       mydata   = data;
-    const opt_double_ptr mygreen  = green_;
+    opt_real_ptr       mydata   = data;
+    const opt_real_ptr mygreen  = green_;
 
     // get the number of pencils for the field and green
     const size_t ondim = topo_hat_[cdim]->nloc(ax1) * topo_hat_[cdim]->nloc(ax2);
@@ -88,8 +88,8 @@ void Solver::dothemagic_rot_complex_o6(double *data,const double koffset[3],cons
     const size_t nloc_ax1 = topo_hat_[cdim]->nloc(ax1);
 
     // check the alignment
-    FLUPS_CHECK(FLUPS_ISALIGNED(mygreen) && (nmem[ax0] * topo_hat_[cdim]->nf() * sizeof(double)) % FLUPS_ALIGNMENT == 0, "please use FLUPS_ALIGNMENT to align the memory");
-    FLUPS_CHECK(FLUPS_ISALIGNED(mydata) && (nmem[ax0] * topo_hat_[cdim]->nf() * sizeof(double)) % FLUPS_ALIGNMENT == 0, "please use FLUPS_ALIGNMENT to align the memory");
+    FLUPS_CHECK(FLUPS_ISALIGNED(mygreen) && (nmem[ax0] * topo_hat_[cdim]->nf() * sizeof(flups_real)) % FLUPS_ALIGNMENT == 0, "please use FLUPS_ALIGNMENT to align the memory");
+    FLUPS_CHECK(FLUPS_ISALIGNED(mydata) && (nmem[ax0] * topo_hat_[cdim]->nf() * sizeof(flups_real)) % FLUPS_ALIGNMENT == 0, "please use FLUPS_ALIGNMENT to align the memory");
     FLUPS_ASSUME_ALIGNED(mydata, FLUPS_ALIGNMENT);
     FLUPS_ASSUME_ALIGNED(mygreen, FLUPS_ALIGNMENT);
     
@@ -101,10 +101,10 @@ void Solver::dothemagic_rot_complex_o6(double *data,const double koffset[3],cons
 #endif
     for (size_t io = 0; io < ondim; io++) {
         // get the starting pointer
-        opt_double_ptr greenloc = mygreen + collapsedIndex(ax0, 0, io, nmem, nf);  //lda of Green is only 1
-        opt_double_ptr dataloc0 = mydata + 0 * memdim + collapsedIndex(ax0, 0, io, nmem, nf);
-        opt_double_ptr dataloc1 = mydata + 1 * memdim + collapsedIndex(ax0, 0, io, nmem, nf);
-        opt_double_ptr dataloc2 = mydata + 2 * memdim + collapsedIndex(ax0, 0, io, nmem, nf);
+        opt_real_ptr greenloc = mygreen + collapsedIndex(ax0, 0, io, nmem, nf);  //lda of Green is only 1
+        opt_real_ptr dataloc0 = mydata + 0 * memdim + collapsedIndex(ax0, 0, io, nmem, nf);
+        opt_real_ptr dataloc1 = mydata + 1 * memdim + collapsedIndex(ax0, 0, io, nmem, nf);
+        opt_real_ptr dataloc2 = mydata + 2 * memdim + collapsedIndex(ax0, 0, io, nmem, nf);
 
         FLUPS_ASSUME_ALIGNED(greenloc, FLUPS_ALIGNMENT);
         FLUPS_ASSUME_ALIGNED(dataloc0, FLUPS_ALIGNMENT);
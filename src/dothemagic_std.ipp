@@ -9,13 +9,13 @@
  * @brief perform the convolution for real to real cases
  * 
  */
-void Solver::dothemagic_std_real(double *data) {
+void Solver::dothemagic_std_real(flups_real *data) {
 #elif (KIND == 1)
 /**
  * @brief perform the convolution for complex to complex cases
  * 
  */
-void Solver::dothemagic_std_complex(double *data) {
+void Solver::dothemagic_std_complex(flups_real *data) {
 #endif
 
     BEGIN_FUNC;
@@ -32,11 +32,11 @@ void Solver::dothemagic_std_complex(double *data) {
     const int ax2 = (ax0 + 2) % 3;
     
     // get the norm factor
-    const double         normfact = normfact_;
+    const flups_real     normfact = normfact_;
 
     // get the adresses
-    opt_double_ptr       mydata   = data;
-    const opt_double_ptr mygreen  = green_;
+    opt_real_ptr       mydata   = data;
+    const opt_real_ptr mygreen  = green_;
 
     // get the number of pencils for the field and green
     const size_t onmax = topo_hat_[cdim]->nloc(ax1) * topo_hat_[cdim]->nloc(ax2) * topo_hat_[cdim]->lda();
@@ -47,8 +47,8 @@ void Solver::dothemagic_std_complex(double *data) {
     const int    nmem[3] = {topo_hat_[cdim]->nmem(0), topo_hat_[cdim]->nmem(1), topo_hat_[cdim]->nmem(2)};
 
     // check the alignment
-    FLUPS_CHECK(FLUPS_ISALIGNED(mygreen) && (nmem[ax0] * topo_hat_[cdim]->nf() * sizeof(double)) % FLUPS_ALIGNMENT == 0, "please use FLUPS_ALIGNMENT to align the memory");
-    FLUPS_CHECK(FLUPS_ISALIGNED(mydata) && (nmem[ax0] * topo_hat_[cdim]->nf() * sizeof(double)) % FLUPS_ALIGNMENT == 0, "please use FLUPS_ALIGNMENT to align the memory");
+    FLUPS_CHECK(FLUPS_ISALIGNED(mygreen) && (nmem[ax0] * topo_hat_[cdim]->nf() * sizeof(flups_real)) % FLUPS_ALIGNMENT == 0, "please use FLUPS_ALIGNMENT to align the memory");
+    FLUPS_CHECK(FLUPS_ISALIGNED(mydata) && (nmem[ax0] * topo_hat_[cdim]->nf() * sizeof(flups_real)) % FLUPS_ALIGNMENT == 0, "please use FLUPS_ALIGNMENT to align the memory");
     FLUPS_ASSUME_ALIGNED(mydata, FLUPS_ALIGNMENT);
     FLUPS_ASSUME_ALIGNED(mygreen, FLUPS_ALIGNMENT);
     
@@ -60,8 +60,8 @@ void Solver::dothemagic_std_complex(double *data) {
         const size_t io  = id % ondim;
 
         // get the starting pointer
-        opt_double_ptr greenloc = mygreen + collapsedIndex(ax0, 0, io, nmem, nf);  //lda of Green is only 1
-        opt_double_ptr dataloc  = mydata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, nf);
+        opt_real_ptr greenloc = mygreen + collapsedIndex(ax0, 0, io, nmem, nf);  //lda of Green is only 1
+        opt_real_ptr dataloc  = mydata + lia * memdim + collapsedIndex(ax0, 0, io, nmem, nf);
 
         FLUPS_ASSUME_ALIGNED(dataloc, FLUPS_ALIGNMENT);
         FLUPS_ASSUME_ALIGNED(greenloc, FLUPS_ALIGNMENT);
@@ -71,10 +71,10 @@ void Solver::dothemagic_std_complex(double *data) {
 #if (KIND == 0)
             dataloc[ii] *= normfact * greenloc[ii];
 #elif (KIND == 1)
-            const double a = dataloc[ii * 2 + 0];
-            const double b = dataloc[ii * 2 + 1];
-            const double c = greenloc[ii * 2 + 0];
-            const double d = greenloc[ii * 2 + 1];
+            const flups_real a = dataloc[ii * 2 + 0];
+            const flups_real b = dataloc[ii * 2 + 1];
+            const flups_real c = greenloc[ii * 2 + 0];
+            const flups_real d = greenloc[ii * 2 + 1];
             // update the values
             dataloc[ii * 2 + 0] = normfact * (a * c - b * d);
             dataloc[ii * 2 + 1] = normfact * (a * d + b * c);
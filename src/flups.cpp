@@ -124,7 +124,7 @@ void flups_setup(Solver* s, const bool changeComm) {
 }
 
 // solve
-void flups_solve(Solver* s, double* field, double* rhs, const SolverType type) {
+void flups_solve(Solver* s, flups_real* field, flups_real* rhs, const SolverType type) {
     s->solve(field, rhs, type);
 }
 
@@ -142,7 +142,19 @@ void flups_set_alpha(Solver* s, const double alpha) {
     s->set_alpha(alpha);
 }
 
-double* flups_get_innerBuffer(FLUPS_Solver* s){
+void flups_set_switchType(Solver* s, const int istp, const SwitchType type) {
+    s->set_SwitchType(istp, type);
+}
+
+void flups_set_reorderRanks(Solver* s, const bool reorder) {
+    s->set_ReorderRanks(reorder);
+}
+
+double flups_get_transportError(Solver* s) {
+    return s->get_transportError();
+}
+
+flups_real* flups_get_innerBuffer(FLUPS_Solver* s){
     return s->get_innerBuffer();
 }
 
@@ -158,18 +170,22 @@ void flups_skip_firstSwitchtopo(Solver* s){
     s->skip_firstSwitchtopo();
 }
 
-void flups_do_copy(Solver* s, const Topology* topo, double* data, const int sign) {
+void flups_do_copy(Solver* s, const Topology* topo, flups_real* data, const int sign) {
     s->do_copy(topo, data, sign);
 }
 
-void flups_do_FFT(Solver* s, double* data, const int sign) {
+void flups_do_FFT(Solver* s, flups_real* data, const int sign) {
     s->do_FFT(data, sign);
 }
 
-void flups_do_mult(Solver* s, double* data, const SolverType type) {
+void flups_do_mult(Solver* s, flups_real* data, const SolverType type) {
     s->do_mult(data, type);
 }
 
+void flups_hint_proc_repartition(const int lda, const int nglob[3], const double h[3], const double L[3], BoundaryType* bc[3][2], const CenterType center_type[3], MPI_Comm comm, int nproc[3]) {
+    hint_proc_repartition(lda, nglob, h, L, bc, center_type, comm, nproc);
+}
+
 void flups_pencilDirs(const FLUPS_BoundaryType* bc[3][2], int dirs[3]) {
     // get the priorities from the bcs
     std::array<std::tuple<int, int>, 3> priority = {std::make_tuple(bc_to_types(bc[0]), 0),
@@ -212,12 +228,12 @@ void flups_profiler_disp(FLUPS_Profiler* p) {
 //**********************************************************************
 //  HDF5
 //**********************************************************************
-void flups_hdf5_dump(const Topology* topo, const char filename[], const double* data) {
+void flups_hdf5_dump(const Topology* topo, const char filename[], const flups_real* data) {
     const std::string fn(filename);
     hdf5_dump(topo, fn, data);
 }
 
-void flups_print_data(const Topology* topo, double* data) {
+void flups_print_data(const Topology* topo, flups_real* data) {
     FLUPS_print_data(topo, data);
 }
 
@@ -273,12 +289,28 @@ void flups_info(int argc, char** argv) {
         fprintf(file, "\tPersistent, non blocking implementation \n");
         fprintf(file, "\tFLUPS_MPI_BATCH_SEND = %d\n", FLUPS_MPI_BATCH_SEND);
         fprintf(file, "\tFLUPS_MPI_MAX_NBSEND = %d\n", FLUPS_MPI_MAX_NBSEND);
+        fprintf(file, "\tFLUPS_MPI_PARTITIONED = %d\n", FLUPS_MPI_PARTITIONED);
 #endif
 #ifdef COMM_ISR
         fprintf(file, "\tNon blocking implementation -- MPI data type \n");
         fprintf(file, "\tFLUPS_MPI_BATCH_SEND = %d\n", FLUPS_MPI_BATCH_SEND);
         fprintf(file, "\tFLUPS_MPI_MAX_NBSEND = %d\n", FLUPS_MPI_MAX_NBSEND);
 #endif
+#ifdef COMM_RMA
+        fprintf(file, "\tOne-sided implementation -- MPI_Put with PSCW synchronization \n");
+#endif
+#if defined(COMM_NONBLOCK) || defined(COMM_ISR)
+        fprintf(file, "\tFLUPS_MPI_MULTITHREAD = %d\n", FLUPS_MPI_MULTITHREAD);
+        fprintf(file, "\tFLUPS_MPI_ADAPT_SEND = %d\n", FLUPS_MPI_ADAPT_SEND);
+#endif
+        fprintf(file, "\tFLUPS_MPI_PROGRESS = %d\n", FLUPS_MPI_PROGRESS);
+        fprintf(file, "\tFLUPS_PACK_TUNING = %d\n", FLUPS_PACK_TUNING);
+        fprintf(file, "\tFLUPS_REORDER_RANKS = %d\n", FLUPS_REORDER_RANKS);
+        fprintf(file, "\tFLUPS_NODE_AWARE = %d\n", FLUPS_NODE_AWARE);
+        fprintf(file, "\tFLUPS_SLAB_AUTO = %d\n", FLUPS_SLAB_AUTO);
+        fprintf(file, "\tFLUPS_SUBSET_AUTO = %d\n", FLUPS_SUBSET_AUTO);
+        fprintf(file, "\tFLUPS_FLOAT_TRANSPORT = %d\n", FLUPS_FLOAT_TRANSPORT);
+        fprintf(file, "\tFLUPS_SINGLE_PREC = %d\n", FLUPS_SINGLE_PREC);
 #if (FLUPS_HDF5)
         fprintf(file, "\tHDF5 ? yes\n");
 #else
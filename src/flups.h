@@ -12,6 +12,62 @@
 #include "flups_interface.h"
 #include "mpi.h"
 
+//=============================================================================
+/**
+ * @brief the single precision library (libflups_f*) exposes the same API with a _f suffix:
+ * compiling with SINGLE_PREC renames the calls so that a precision mismatch fails at link time
+ */
+#ifdef SINGLE_PREC
+#define flups_cleanup                      flups_cleanup_f
+#define flups_do_FFT                       flups_do_FFT_f
+#define flups_do_copy                      flups_do_copy_f
+#define flups_do_mult                      flups_do_mult_f
+#define flups_free                         flups_free_f
+#define flups_get_allocSize                flups_get_allocSize_f
+#define flups_get_innerBuffer              flups_get_innerBuffer_f
+#define flups_get_innerTopo_physical       flups_get_innerTopo_physical_f
+#define flups_get_innerTopo_spectral       flups_get_innerTopo_spectral_f
+#define flups_get_spectralInfo             flups_get_spectralInfo_f
+#define flups_get_transportError           flups_get_transportError_f
+#define flups_hdf5_dump                    flups_hdf5_dump_f
+#define flups_hint_proc_repartition        flups_hint_proc_repartition_f
+#define flups_info                         flups_info_f
+#define flups_init                         flups_init_f
+#define flups_init_timed                   flups_init_timed_f
+#define flups_malloc                       flups_malloc_f
+#define flups_pencilDirs                   flups_pencilDirs_f
+#define flups_print_data                   flups_print_data_f
+#define flups_profiler_disp                flups_profiler_disp_f
+#define flups_profiler_free                flups_profiler_free_f
+#define flups_profiler_new                 flups_profiler_new_f
+#define flups_profiler_new_n               flups_profiler_new_n_f
+#define flups_set_alpha                    flups_set_alpha_f
+#define flups_set_greenType                flups_set_greenType_f
+#define flups_set_reorderRanks             flups_set_reorderRanks_f
+#define flups_set_switchType               flups_set_switchType_f
+#define flups_setup                        flups_setup_f
+#define flups_skip_firstSwitchtopo         flups_skip_firstSwitchtopo_f
+#define flups_solve                        flups_solve_f
+#define flups_switchtopo_info              flups_switchtopo_info_f
+#define flups_topo_cmpt_rank_fromid        flups_topo_cmpt_rank_fromid_f
+#define flups_topo_cmpt_start_id_from_rank flups_topo_cmpt_start_id_from_rank_f
+#define flups_topo_free                    flups_topo_free_f
+#define flups_topo_get_axis                flups_topo_get_axis_f
+#define flups_topo_get_comm                flups_topo_get_comm_f
+#define flups_topo_get_isComplex           flups_topo_get_isComplex_f
+#define flups_topo_get_istartGlob          flups_topo_get_istartGlob_f
+#define flups_topo_get_lda                 flups_topo_get_lda_f
+#define flups_topo_get_locsize             flups_topo_get_locsize_f
+#define flups_topo_get_memsize             flups_topo_get_memsize_f
+#define flups_topo_get_nglob               flups_topo_get_nglob_f
+#define flups_topo_get_nloc                flups_topo_get_nloc_f
+#define flups_topo_get_nmem                flups_topo_get_nmem_f
+#define flups_topo_get_nproc               flups_topo_get_nproc_f
+#define flups_topo_new                     flups_topo_new_f
+#define flups_topo_rankindex               flups_topo_rankindex_f
+#define flups_topo_ranksplit               flups_topo_ranksplit_f
+#endif
+
 #ifdef __cplusplus
 #include <cmath>
 #include <iostream>
@@ -32,6 +88,7 @@ typedef enum GreenType    FLUPS_GreenType;
 typedef enum SolverType   FLUPS_SolverType;
 typedef enum DiffType     FLUPS_DiffType;
 typedef enum CenterType   FLUPS_CenterType;
+typedef enum SwitchType   FLUPS_SwitchType;
 
 /**@} */
 
@@ -412,7 +469,7 @@ void flups_setup(FLUPS_Solver* s, const bool changeComm);
  * @param field
  * @param rhs
  */
-void flups_solve(FLUPS_Solver* s, double* field, double* rhs, const FLUPS_SolverType type);
+void flups_solve(FLUPS_Solver* s, flups_real* field, flups_real* rhs, const FLUPS_SolverType type);
 
 /**@} */
 
@@ -456,6 +513,45 @@ void flups_get_spectralInfo(FLUPS_Solver* s, double kfact[3], double koffset[3],
  */
 void flups_set_alpha(FLUPS_Solver* s, const double alpha);  // must be done before setup
 
+/**
+ * @brief sets the communication backend used by a topology switch
+ *
+ * If not set, the backend is given by the environment variable `FLUPS_COMM`, either as a single backend for all the switches
+ * or as a comma-separated list (e.g. `FLUPS_COMM=isr,a2a,auto`). The accepted names are `a2a`, `a2aw`, `nb`, `isr`, `rma` and `auto`.
+ * Otherwise, the backend chosen at compilation is used.
+ *
+ * @warning must be done before @ref flups_setup
+ *
+ * @param s
+ * @param istp the id of the topology switch (0, 1 or 2), -1 for all of them
+ * @param type the communication backend
+ */
+void flups_set_switchType(FLUPS_Solver* s, const int istp, const FLUPS_SwitchType type);
+
+/**
+ * @brief reorders the ranks based on the communication graph of the topology switches, to keep the heaviest communications inside the nodes
+ *
+ * If not set, the reordering is given by the environment variable `FLUPS_REORDER` (`0` or `1`).
+ * Otherwise, the reordering is done only if the library has been compiled with `REORDER_RANKS`.
+ * The inter-node volume before the reordering, predicted and achieved is reported at the setup.
+ *
+ * @warning must be done before @ref flups_setup
+ *
+ * @param s
+ * @param reorder true to reorder the ranks
+ */
+void flups_set_reorderRanks(FLUPS_Solver* s, const bool reorder);
+
+/**
+ * @brief returns an estimate of the relative error due to the float transport during the last solve (0 if not used)
+ *
+ * The estimate is the sum over the switchtopos of the max relative error of the conversion to float of their chunks.
+ * This function is collective.
+ *
+ * @param s
+ */
+double flups_get_transportError(FLUPS_Solver* s);
+
 // /**
 //  * @brief sets the order of derivative while using divergence or rotational formulation
 //  *
@@ -469,7 +565,7 @@ void flups_set_alpha(FLUPS_Solver* s, const double alpha);  // must be done befo
  *
  * @param s
  */
-double* flups_get_innerBuffer(FLUPS_Solver* s);
+flups_real* flups_get_innerBuffer(FLUPS_Solver* s);
 
 /**
  * @brief returns the first pencil topology in the physical space, i.e. the one used for rhs and solution
@@ -504,7 +600,7 @@ void flups_skip_firstSwitchtopo(FLUPS_Solver* s);
  * @param data
  * @param sign
  */
-void flups_do_copy(FLUPS_Solver* s, const FLUPS_Topology* topo, double* data, const int sign);
+void flups_do_copy(FLUPS_Solver* s, const FLUPS_Topology* topo, flups_real* data, const int sign);
 /**
  * @brief compute the FFT, go from the physical space to the spectral one
  *
@@ -512,7 +608,7 @@ void flups_do_copy(FLUPS_Solver* s, const FLUPS_Topology* topo, double* data, co
  * @param data
  * @param sign
  */
-void flups_do_FFT(FLUPS_Solver* s, double* data, const int sign);
+void flups_do_FFT(FLUPS_Solver* s, flups_real* data, const int sign);
 /**
  * @brief compute the multiplication between the Green's function and the field
  *
@@ -520,9 +616,28 @@ void flups_do_FFT(FLUPS_Solver* s, double* data, const int sign);
  * @param data
  * @param type
  */
-void flups_do_mult(FLUPS_Solver* s, double* data, const FLUPS_SolverType type);
+void flups_do_mult(FLUPS_Solver* s, flups_real* data, const FLUPS_SolverType type);
 
-// int flups_hint_proc_repartition(const int lda, const double h[3], const double L[3], FLUPS_BoundaryType* bc[3][2], const FLUPS_CenterType center_type[3]);
+/**
+ * @brief returns the proc repartition of the physical topology leading to the lowest modeled communication time
+ *
+ * Every proc grid of the communicator is evaluated by computing the chunks exchanged by the switchtopos (for the physical
+ * and the spectral topologies). The modeled time accounts for the number of messages and for the volume sent inside and
+ * outside of the nodes. The volume, number of messages and memory of every grid are given in the verbose output and the
+ * chosen one is reported.
+ *
+ * @warning collective on comm, must be called before the creation of any solver (it creates and destroys solvers, which cleans up FFTW)
+ *
+ * @param lda the number of components of the field
+ * @param nglob the global number of unknowns
+ * @param h the grid spacing
+ * @param L the domain size
+ * @param bc the boundary conditions
+ * @param center_type the location of the data
+ * @param comm the communicator of the future topology
+ * @param nproc the proc repartition to use for the physical topology (output)
+ */
+void flups_hint_proc_repartition(const int lda, const int nglob[3], const double h[3], const double L[3], FLUPS_BoundaryType* bc[3][2], const FLUPS_CenterType center_type[3], MPI_Comm comm, int nproc[3]);
 
 /**
  * @brief for a set of boundary conditions returns the succession of directions for the pencils
@@ -594,11 +709,11 @@ void flups_profiler_disp(FLUPS_Profiler* p);
  * @param filename
  * @param data
  */
-void flups_hdf5_dump(const FLUPS_Topology* topo, const char filename[], const double* data);
+void flups_hdf5_dump(const FLUPS_Topology* topo, const char filename[], const flups_real* data);
 
 /**@} */
 
-void flups_print_data(const FLUPS_Topology* topo, double* data);
+void flups_print_data(const FLUPS_Topology* topo, flups_real* data);
 
 #ifdef __cplusplus
 }
@@ -31,6 +31,17 @@
  */
 #define FLUPS_ALIGNMENT 16
 
+/**
+ * @brief Floating point type of the data: float with the single precision library (SINGLE_PREC), double otherwise
+ *
+ * The code using the single precision library must also be compiled with SINGLE_PREC.
+ */
+#ifdef SINGLE_PREC
+typedef float flups_real;
+#else
+typedef double flups_real;
+#endif
+
 //==============================================================================
 /**
  * @name STRUCTURES AND DEFINITIONS
@@ -92,6 +103,25 @@ enum DiffType {
     FD6 = 6  /**< @brief Spectral equivalent of 6th order finite difference, \f$ \hat{K} = i \, ( 3/2 \sin(kh) - 3/10 \sin(2kh) + 1/30 \sin(3kh) ) \, \hat{G} \f$ */
 };
 
+/**
+ * @brief The communication backend used by the topology switches
+ *
+ * The default backend is chosen at compilation (see the `COMM_*` flags).
+ * With SWITCH_AUTO, every backend is timed on the actual communication pattern during the setup and the fastest one is kept.
+ * On a single rank, SWITCH_SELF is always used, whatever the requested backend. It is also used for every switchtopo that
+ * does not move any data between the ranks, which is then a local transpose.
+ */
+enum SwitchType {
+    SWITCH_DEFAULT = 0, /**< @brief the backend chosen at compilation */
+    SWITCH_A2A     = 1, /**< @brief MPI_Ialltoallv on packed buffers */
+    SWITCH_NB      = 2, /**< @brief persistent non-blocking send/recv on packed buffers */
+    SWITCH_ISR     = 3, /**< @brief non-blocking send/recv using MPI datatypes */
+    SWITCH_RMA     = 4, /**< @brief one-sided MPI_Put with PSCW synchronization */
+    SWITCH_AUTO    = 5, /**< @brief selects the fastest among SWITCH_A2A, SWITCH_A2AW, SWITCH_NB and SWITCH_ISR */
+    SWITCH_SELF    = 6, /**< @brief threaded in-memory transpose without MPI, used automatically on a single rank and for the local switchtopos */
+    SWITCH_A2AW    = 7  /**< @brief MPI_Ialltoallw sending directly from the memory with MPI datatypes (no packing, no send buffer) */
+};
+
 /**
  * @brief List of supported data center
  *
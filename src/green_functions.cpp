@@ -24,7 +24,7 @@ typedef double (*GreenKernel)(const void*,const double*);
  * @param typeGreen the type of Green function 
  * @param length the characteristic length (only used for HEJ kernels = epsilon)
  */
-void cmpt_Green_3dirunbounded(const Topology *topo, const double hfact[3], const double symstart[3], double *green, GreenType typeGreen, const double length){
+void cmpt_Green_3dirunbounded(const Topology *topo, const double hfact[3], const double symstart[3], flups_real *green, GreenType typeGreen, const double length){
     BEGIN_FUNC;
     // assert that the green spacing is not 0.0 everywhere
     FLUPS_CHECK(hfact[0] != 0.0, "hfact[0] cannot be 0");
@@ -152,7 +152,7 @@ void cmpt_Green_3dirunbounded(const Topology *topo, const double hfact[3], const
             full spectral part afterwards, while going through Solver::cmptGreenFunction_.
  * 
  */
-void cmpt_Green_2dirunbounded(const Topology *topo, const double hfact[3], const double kfact[3], const double koffset[3], const double symstart[3], double *green, GreenType typeGreen, const double length) {
+void cmpt_Green_2dirunbounded(const Topology *topo, const double hfact[3], const double kfact[3], const double koffset[3], const double symstart[3], flups_real *green, GreenType typeGreen, const double length) {
     BEGIN_FUNC;
     
     // assert that the green spacing and dk is not 0.0 - this is also a way to check that ax0 will be spectral, and the others are still to be transformed
@@ -163,7 +163,7 @@ void cmpt_Green_2dirunbounded(const Topology *topo, const double hfact[3], const
 
     // @Todo For Helmolz, we need Green to be complex 
     // FLUPS_CHECK(topo->isComplex(), "I can't fill a non complex topo with a complex green function.");
-    // opt_double_ptr mygreen = green; //casting of the Green function to be able to access real and complex part
+    // opt_real_ptr mygreen = green; //casting of the Green function to be able to access real and complex part
     //Implementation note: if you want to do Helmolz, you need Hankel functions (3rd order Bessel) which are not implemented in stdC. Consider the use of boost lib.
     //notice that bessel_k has been introduced in c++17
 
@@ -308,7 +308,7 @@ void cmpt_Green_2dirunbounded(const Topology *topo, const double hfact[3], const
  * @param typeGreen the type of Green function 
  * @param length the characteristic length (only used for HEJ kernels = epsilon)
  */
-void cmpt_Green_1dirunbounded(const Topology *topo, const double hfact[3], const double kfact[3], const double koffset[3], const double symstart[3], double *green, GreenType typeGreen, const double length) {
+void cmpt_Green_1dirunbounded(const Topology *topo, const double hfact[3], const double kfact[3], const double koffset[3], const double symstart[3], flups_real *green, GreenType typeGreen, const double length) {
     BEGIN_FUNC;
 
     // assert that the green spacing and dk is not 0.0 - this is also a way to check that ax0 will be spectral, and the others are still to be transformed
@@ -428,7 +428,7 @@ void cmpt_Green_1dirunbounded(const Topology *topo, const double hfact[3], const
  * @param typeGreen the type of Green function 
  * @param length the characteristic length (only used for HEJ kernels = epsilon)
  */
-void cmpt_Green_0dirunbounded(const Topology *topo, const double hgrid, const double kfact[3], const double koffset[3], const double symstart[3], double *green, GreenType typeGreen, const double length) {
+void cmpt_Green_0dirunbounded(const Topology *topo, const double hgrid, const double kfact[3], const double koffset[3], const double symstart[3], flups_real *green, GreenType typeGreen, const double length) {
     cmpt_Green_0dirunbounded(topo, hgrid, kfact, koffset, symstart, green, typeGreen, length, NULL, NULL);
 }
 
@@ -450,7 +450,7 @@ void cmpt_Green_0dirunbounded(const Topology *topo, const double hgrid, const do
  * @param istart_custom global index where we start to fill data, in each dir. If NULL, we start at the beginning of the spectral space.
  * @param iend_custom global index where we end to fill data, in each dir. If NULL, we end at the end of the spectral space.
  */
-void cmpt_Green_0dirunbounded(const Topology *topo, const double hgrid, const double kfact[3], const double koffset[3], const double symstart[3], double *green, GreenType typeGreen, const double length, const int istart_custom[3], const int iend_custom[3]) {
+void cmpt_Green_0dirunbounded(const Topology *topo, const double hgrid, const double kfact[3], const double koffset[3], const double symstart[3], flups_real *green, GreenType typeGreen, const double length, const int istart_custom[3], const int iend_custom[3]) {
     BEGIN_FUNC;
 
     // assert that the green spacing is not 0.0 everywhere
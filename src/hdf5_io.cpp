@@ -8,7 +8,7 @@
 
 using std::string;
 
-void hdf5_dump(const Topology *topo, const string filename, const double *data) {
+void hdf5_dump(const Topology *topo, const string filename, const flups_real *data) {
 #if (FLUPS_HDF5)
     BEGIN_FUNC;
     xmf_write(topo, filename, "data");
@@ -53,7 +53,7 @@ void hdf5_dump(const Topology *topo, const string filename, const double *data)
  * We do the following steps:
  * 
  */
-void hdf5_write(const Topology *topo, const string filename, const string attribute, const double *data) {
+void hdf5_write(const Topology *topo, const string filename, const string attribute, const flups_real *data) {
 #if (FLUPS_HDF5)   
     BEGIN_FUNC;
 
@@ -189,7 +189,7 @@ void hdf5_write(const Topology *topo, const string filename, const string attrib
             hsize_t memoffset[4] = {(hsize_t) lia, 0, 0, 0};  // offset in memory
             status               = H5Sselect_hyperslab(memspace, H5S_SELECT_SET, memoffset, memstride, memcount, memblock);
             FLUPS_CHECK(status >= 0, "Failed to select hyperslab in memmory.");
-            status = H5Dwrite(fileset_real, H5T_NATIVE_DOUBLE, memspace, filespace_real, plist_id, data);
+            status = H5Dwrite(fileset_real, FLUPS_H5T_REAL, memspace, filespace_real, plist_id, data);
             FLUPS_CHECK(status >= 0, "Failed to write hyperslab to file.");
         }
 
@@ -200,7 +200,7 @@ void hdf5_write(const Topology *topo, const string filename, const string attrib
             hsize_t memoffset[4] = {(hsize_t)lia, 0, 0, 0};
             status               = H5Sselect_hyperslab(memspace, H5S_SELECT_SET, memoffset, memstride, memcount, memblock);
             FLUPS_CHECK(status >= 0, "Failed to select real hyperslab in memmory.");
-            status = H5Dwrite(fileset_real, H5T_NATIVE_DOUBLE, memspace, filespace_real, plist_id, data);
+            status = H5Dwrite(fileset_real, FLUPS_H5T_REAL, memspace, filespace_real, plist_id, data);
             FLUPS_CHECK(status >= 0, "Failed to write real part hyperslab to file.");
 
             memoffset[3] = 1;  // set an offset on the fastest rotating index
@@ -208,7 +208,7 @@ void hdf5_write(const Topology *topo, const string filename, const string attrib
             // imaginary part
             status = H5Sselect_hyperslab(memspace, H5S_SELECT_SET, memoffset, memstride, memcount, memblock);
             FLUPS_CHECK(status >= 0, "Failed to select imag hyperslab in memmory.");
-            status = H5Dwrite(fileset_imag, H5T_NATIVE_DOUBLE, memspace, filespace_imag, plist_id, data);
+            status = H5Dwrite(fileset_imag, FLUPS_H5T_REAL, memspace, filespace_imag, plist_id, data);
             FLUPS_CHECK(status >= 0, "Failed to write imaginary part hyperslab to file.");
         }
     }
@@ -354,7 +354,7 @@ void hdf5_dumptest() {
     const int nmem[3] = {topo->nmem(0), topo->nmem(1), topo->nmem(2)};
 
     // we only allocate the real size = local size
-    double *data = (double *)m_calloc(sizeof(double *) * topo->locsize());
+    flups_real *data = (flups_real *)m_calloc(sizeof(flups_real) * topo->locsize());
 
     for (int i2 = 0; i2 < topo->nloc(2); i2++) {
         for (int i1 = 0; i1 < topo->nloc(1); i1++) {
@@ -374,13 +374,13 @@ void hdf5_dumptest() {
     // create a real topology
     topo = new Topology(0, 1, nglob, nproc, true,NULL,1,MPI_COMM_WORLD);
 
-    data = (double *)m_calloc(sizeof(double *) * topo->locsize());
+    data = (flups_real *)m_calloc(sizeof(flups_real) * topo->locsize());
 
     for (int i2 = 0; i2 < topo->nloc(2); i2++) {
         for (int i1 = 0; i1 < topo->nloc(1); i1++) {
             for (int i0 = 0; i0 < topo->nloc(0); i0++) {
                 const size_t id = localIndex(0,i0, i1, i2, 0, nmem,topo->nf(), 0);
-                data[id + 0] = (double)id;
+                data[id + 0] = (flups_real)id;
                 data[id + 1] = 0.0;  //-data[id + 0];
             }
         }
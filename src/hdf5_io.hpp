@@ -20,11 +20,17 @@
 
 #if (FLUPS_HDF5)
 #include "hdf5.h"
+// the memory type of the data
+#if (FLUPS_SINGLE_PREC)
+#define FLUPS_H5T_REAL H5T_NATIVE_FLOAT
+#else
+#define FLUPS_H5T_REAL H5T_NATIVE_DOUBLE
+#endif
 #endif
 
 void hdf5_dumptest();
-void hdf5_dump(const Topology *topo, const std::string filename, const double *data);
+void hdf5_dump(const Topology *topo, const std::string filename, const flups_real *data);
 
 void xmf_write(const Topology *topo, const std::string filename, const std::string attribute);
-void hdf5_write(const Topology *topo, const std::string filename, const std::string attribute, const double *data);
+void hdf5_write(const Topology *topo, const std::string filename, const std::string attribute, const flups_real *data);
 #endif